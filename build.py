@@ -49,12 +49,14 @@ def generate_cmake_args(build_type="Debug"):
         "ENGINE_NAME": config.ENGINE_NAME,
         "GAME_NAME": config.GAME_NAME,
         "EDITOR_NAME": config.EDITOR_NAME,
+        "COOK_NAME": config.COOK_NAME,
         "CMAKE_CXX_STANDARD": config.CXX_STANDARD,
         "CMAKE_BUILD_TYPE": build_type,
         "WEBGPU_BACKEND": "DAWN",
         "WEBGPU_BUILD_FROM_SOURCE": "OFF",
         "TR_ENABLE_ASSERTS": "ON" if config.ENABLE_ASSERTS else "OFF",
         "TR_ENABLE_DEBUG_LOGGING": "ON" if config.ENABLE_DEBUG_LOGGING else "OFF",
+        "TR_ENABLE_PROFILING": "ON" if config.ENABLE_PROFILING else "OFF",
     }
 
     cmake_args = ["cmake", "-S", ".", "-B", config.BUILD_DIR]
@@ -117,6 +119,14 @@ def clean():
     else:
         logging.warning(f"{BUILD_DIR}/ does not exist. Nothing to clean.")
 
+def cook(force=False):
+    logging.info("Cooking assets...")
+    if force:
+        cache_dir = os.path.join(BUILD_DIR, "packs", "cache")
+        if os.path.exists(cache_dir):
+            shutil.rmtree(cache_dir)
+    run_cmd(["cmake", "--build", BUILD_DIR, "--target", "cook_assets"])
+
 def run_executable():
     exe_path = os.path.join(BUILD_DIR, "bin", EXECUTABLE_NAME)
     if os.name == 'nt':
@@ -137,6 +147,9 @@ def main():
     subparsers.add_parser("clean", help="Remove build directory")
     subparsers.add_parser("run", help="Run the built executable")
 
+    cook_parser = subparsers.add_parser("cook", help="Cook assets into packs")
+    cook_parser.add_argument("--force", action="store_true", help="Discard the cook cache first")
+
     build_parser = subparsers.add_parser("build", help="Configure and build the project")
     build_parser.add_argument("--no-parallel", action="store_true", help="Disable parallel build")
     build_parser.add_argument("--verbose", action="store_true", help="Enable verbose output")
@@ -157,6 +170,8 @@ def main():
         clean()
     elif args.command == "run":
         run_executable()
+    elif args.command == "cook":
+        cook(force=args.force)
     elif args.command == "build":
         check_dependencies()
         configure_cmake(args.config)
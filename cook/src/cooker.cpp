@@ -0,0 +1,312 @@
+#include "cooker.h"
+#include "processors.h"
+
+#include "terra/core/thread_pool.h"
+#include "terra/helpers/hash.h"
+#include "terra/resources/pack_archive.h"
+
+#include <chrono>
+#include <unordered_set>
+
+namespace terra::cook {
+
+static bool read_binary(const std::filesystem::path& path, std::vector<u8>& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    out.resize((size_t) std::max<std::streamsize>(size, 0));
+    return size <= 0 || (bool) file.read(reinterpret_cast<char*>(out.data()), size);
+}
+
+static bool write_binary(const std::filesystem::path& path, std::span<const u8> data) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize) data.size());
+    return file.good();
+}
+
+// Keeps empty fields, so "a\t\tb" yields three parts.
+static std::vector<std::string> split(std::string_view str, char separator) {
+    std::vector<std::string> parts;
+    for (;;) {
+        size_t pos = str.find(separator);
+        parts.emplace_back(str.substr(0, pos));
+        if (pos == std::string_view::npos)
+            return parts;
+        str.remove_prefix(pos + 1);
+    }
+}
+
+static std::vector<std::string> split_list(std::string_view str) {
+    std::vector<std::string> parts = split(str, ';');
+    std::erase_if(parts, [](const std::string& p) { return p.empty(); });
+    return parts;
+}
+
+static std::string join(const std::vector<std::string>& parts, char separator) {
+    std::string out;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        if (i) out += separator;
+        out += parts[i];
+    }
+    return out;
+}
+
+Cooker::Cooker(CookOptions options) : m_options(std::move(options)) {
+    if (m_options.cache_dir.empty())
+        m_options.cache_dir = m_options.output_pack.parent_path() / "cache" / m_options.output_pack.stem();
+}
+
+// -----------------------------------------------------------------------------
+// Manifest
+//
+//   # terra-cook manifest <COOKER_VERSION>
+//   <source>\t<hash>\t<version>\t<output;output...>\t<dependency;dependency...>
+// -----------------------------------------------------------------------------
+
+Cooker::Manifest Cooker::load_manifest() const {
+    Manifest manifest;
+
+    std::ifstream file(get_manifest_path());
+    if (!file.is_open())
+        return manifest;
+
+    std::string line;
+    if (!std::getline(file, line) || line != fmt::format("# terra-cook manifest {}", COOKER_VERSION)) {
+        TR_CORE_INFO("Cache manifest is from another cooker version, recooking everything");
+        return manifest;
+    }
+
+    while (std::getline(file, line)) {
+        auto fields = split(line, '\t');
+        if (fields.size() != 5)
+            continue;
+
+        ManifestEntry entry;
+        entry.hash = std::strtoull(fields[1].c_str(), nullptr, 16);
+        entry.version = (u32) std::strtoul(fields[2].c_str(), nullptr, 10);
+        entry.outputs = split_list(fields[3]);
+        entry.dependencies = split_list(fields[4]);
+        manifest.emplace(fields[0], std::move(entry));
+    }
+
+    return manifest;
+}
+
+bool Cooker::save_manifest(const Manifest& manifest) const {
+    std::string text = fmt::format("# terra-cook manifest {}\n", COOKER_VERSION);
+    for (const auto& [source, entry] : manifest) {
+        text += fmt::format("{}\t{:016x}\t{}\t{}\t{}\n",
+            source, entry.hash, entry.version, join(entry.outputs, ';'), join(entry.dependencies, ';'));
+    }
+
+    return write_binary(get_manifest_path(), std::span<const u8>(reinterpret_cast<const u8*>(text.data()), text.size()));
+}
+
+u64 Cooker::hash_source(std::span<const u8> contents, const std::vector<std::string>& dependencies) const {
+    u64 hash = hash_bytes(contents.data(), contents.size());
+
+    std::vector<u8> bytes;
+    for (const auto& dependency : dependencies) {
+        hash = hash_string(dependency, hash);
+        if (read_binary(m_options.input_dir / dependency, bytes))
+            hash = hash_bytes(bytes.data(), bytes.size(), hash);
+    }
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+
+bool Cooker::run() {
+    const auto start = std::chrono::steady_clock::now();
+
+    if (!std::filesystem::is_directory(m_options.input_dir)) {
+        TR_CORE_ERROR("Input directory '{}' does not exist", m_options.input_dir.string());
+        return false;
+    }
+
+    struct Job {
+        std::string virtual_path;
+        std::filesystem::path source;
+        ManifestEntry entry;
+        enum class Status { Cached, Cooked, Failed } status = Status::Failed;
+    };
+
+    std::vector<Job> jobs;
+    for (const auto& it : std::filesystem::recursive_directory_iterator(m_options.input_dir)) {
+        if (!it.is_regular_file() || it.path().filename().string().starts_with("."))
+            continue;
+
+        Job job;
+        job.source = it.path();
+        job.virtual_path = std::filesystem::relative(it.path(), m_options.input_dir).generic_string();
+        jobs.push_back(std::move(job));
+    }
+    std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.virtual_path < b.virtual_path; });
+
+    // Workers write cache files by output path, so two sources mapping to the
+    // same output (foo.txt and foo.obj -> foo.tmesh) would race on it.
+    std::unordered_map<std::string, std::string> producers;
+    bool collisions = false;
+    for (const auto& job : jobs) {
+        for (auto& out : find_processor(job.source).get_outputs(job.virtual_path)) {
+            if (auto [it, inserted] = producers.emplace(std::move(out), job.virtual_path); !inserted) {
+                TR_CORE_ERROR("'{}' and '{}' both produce '{}'", it->second, job.virtual_path, it->first);
+                collisions = true;
+            }
+        }
+    }
+    if (collisions)
+        return false;
+
+    const Manifest previous = m_options.force ? Manifest{} : load_manifest();
+
+    auto cook_job = [&](u32 i) {
+        Job& job = jobs[i];
+
+        std::vector<u8> contents;
+        if (!read_binary(job.source, contents)) {
+            TR_CORE_ERROR("Could not read '{}'", job.source.string());
+            return;
+        }
+
+        const AssetProcessor& processor = find_processor(job.source);
+        const u32 version = (COOKER_VERSION << 16) | processor.version;
+
+        if (auto it = previous.find(job.virtual_path); it != previous.end() && it->second.version == version) {
+            const ManifestEntry& cached = it->second;
+            bool outputs_present = std::all_of(cached.outputs.begin(), cached.outputs.end(), [this](const std::string& out) {
+                return std::filesystem::exists(get_cached_output_path(out));
+            });
+
+            if (outputs_present && hash_source(contents, cached.dependencies) == cached.hash) {
+                job.entry = cached;
+                job.status = Job::Status::Cached;
+                return;
+            }
+        }
+
+        CookResult result = processor.cook({ job.source, job.virtual_path, contents });
+        if (!result.success) {
+            TR_CORE_ERROR("Failed to cook '{}' ({})", job.virtual_path, processor.name);
+            return;
+        }
+
+        job.entry.version = version;
+        job.entry.dependencies = std::move(result.dependencies);
+        job.entry.hash = hash_source(contents, job.entry.dependencies);
+
+        for (const auto& output : result.outputs) {
+            if (!write_binary(get_cached_output_path(output.path), output.data)) {
+                TR_CORE_ERROR("Could not write cache file for '{}'", output.path);
+                return;
+            }
+            job.entry.outputs.push_back(output.path);
+        }
+
+        job.status = Job::Status::Cooked;
+        TR_CORE_TRACE("Cooked {} ({})", job.virtual_path, processor.name);
+    };
+
+    // The calling thread helps out, so N jobs need N - 1 workers and a single
+    // job needs none. ThreadPool treats 0 as "all cores", so that case runs inline.
+    if (m_options.jobs == 1) {
+        for (u32 i = 0; i < (u32) jobs.size(); ++i)
+            cook_job(i);
+    } else {
+        ThreadPool pool(m_options.jobs > 1 ? m_options.jobs - 1 : 0);
+        pool.parallel_for((u32) jobs.size(), cook_job);
+    }
+
+    Manifest next;
+    std::unordered_set<std::string> live_outputs;
+
+    for (auto& job : jobs) {
+        switch (job.status) {
+            case Job::Status::Cached: ++m_stats.cached; break;
+            case Job::Status::Cooked: ++m_stats.cooked; break;
+            case Job::Status::Failed:
+                ++m_stats.failed;
+                // Keep shipping the last good result rather than dropping the
+                // asset; its stale hash makes the next run try again.
+                if (auto it = previous.find(job.virtual_path); it != previous.end())
+                    job.entry = it->second;
+                else
+                    continue;
+                break;
+        }
+        for (const auto& out : job.entry.outputs)
+            live_outputs.insert(out);
+        next.emplace(job.virtual_path, std::move(job.entry));
+    }
+    m_stats.sources = (u32) jobs.size();
+
+    // Sources that disappeared take their cached outputs with them.
+    for (const auto& [source, entry] : previous) {
+        if (next.contains(source))
+            continue;
+
+        ++m_stats.removed;
+        for (const auto& out : entry.outputs) {
+            if (!live_outputs.contains(out))
+                std::filesystem::remove(get_cached_output_path(out));
+        }
+    }
+
+    const bool pack_stale = m_options.force || m_stats.cooked > 0 || m_stats.removed > 0 || m_stats.failed > 0
+        || !std::filesystem::exists(m_options.output_pack);
+
+    // The manifest is only saved once the pack it describes is in place, so
+    // a failed or interrupted pack write leaves the old manifest and the next
+    // run still sees the pack as stale.
+    bool ok = !pack_stale || write_pack(next);
+    if (ok && !save_manifest(next)) {
+        TR_CORE_ERROR("Could not write cache manifest '{}'", get_manifest_path().string());
+        ok = false;
+    }
+
+    m_stats.seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+    return ok && m_stats.failed == 0;
+}
+
+bool Cooker::write_pack(const Manifest& manifest) const {
+    PackWriter writer;
+
+    std::vector<u8> bytes;
+    for (const auto& [source, entry] : manifest) {
+        for (const auto& out : entry.outputs) {
+            if (!read_binary(get_cached_output_path(out), bytes)) {
+                TR_CORE_ERROR("Cached output '{}' is missing", out);
+                return false;
+            }
+            writer.add_file(out, std::span<const u8>(bytes));
+        }
+    }
+
+    // Written aside and renamed over the old pack, so a failed write never
+    // leaves a truncated pack behind.
+    std::filesystem::path temp_path = m_options.output_pack;
+    temp_path += ".tmp";
+    std::error_code ec;
+    if (!writer.write(temp_path)) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+
+    std::filesystem::rename(temp_path, m_options.output_pack, ec);
+    if (ec) {
+        TR_CORE_ERROR("Could not replace '{}': {}", m_options.output_pack.string(), ec.message());
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace terra::cook
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "terrapch.h"
+
+#include <map>
+#include <span>
+
+namespace terra::cook {
+
+// Bump to invalidate every cached result (e.g. when the pack layout changes).
+constexpr u32 COOKER_VERSION = 1;
+
+struct CookOptions {
+    std::filesystem::path input_dir;
+    std::filesystem::path output_pack;
+    std::filesystem::path cache_dir;    // defaults to <output dir>/cache/<pack name>
+    u32 jobs = 0;                       // 0 = all cores
+    bool force = false;                 // ignore the cache
+};
+
+struct CookStats {
+    u32 sources = 0;
+    u32 cooked = 0;
+    u32 cached = 0;
+    u32 failed = 0;
+    u32 removed = 0;
+    f64 seconds = 0.0;
+};
+
+// Cooks every file under `input_dir` into `output_pack`. Results are cached per
+// source under `cache_dir`, keyed by content hash (including dependencies)
+// and processor/cooker version, so unchanged inputs are never reprocessed.
+class Cooker {
+public:
+    explicit Cooker(CookOptions options);
+
+    bool run();
+
+    const CookStats& get_stats() const { return m_stats; }
+
+private:
+    struct ManifestEntry {
+        u64 hash = 0;
+        u32 version = 0;
+        std::vector<std::string> outputs;
+        std::vector<std::string> dependencies;
+    };
+
+    using Manifest = std::map<std::string, ManifestEntry>;
+
+    Manifest load_manifest() const;
+    bool save_manifest(const Manifest& manifest) const;
+
+    std::filesystem::path get_manifest_path() const { return m_options.cache_dir / "manifest.txt"; }
+    std::filesystem::path get_cached_output_path(std::string_view virtual_path) const { return m_options.cache_dir / "files" / virtual_path; }
+
+    u64 hash_source(std::span<const u8> contents, const std::vector<std::string>& dependencies) const;
+
+    bool write_pack(const Manifest& manifest) const;
+
+    CookOptions m_options;
+    CookStats m_stats;
+};
+
+} // namespace terra::cook
@@ -0,0 +1,68 @@
+#include "cooker.h"
+
+#include <charconv>
+#include <iostream>
+
+static void print_usage() {
+    std::cout <<
+        "Usage: terra-cook --input <dir> --output <pack.tpak> [options]\n"
+        "\n"
+        "Options:\n"
+        "  --cache <dir>   Where cooked results are kept between runs\n"
+        "                  (default: <output dir>/cache/<pack name>)\n"
+        "  --jobs <n>      Worker threads (default: all cores)\n"
+        "  --force         Ignore the cache and cook everything\n"
+        "  --verbose       Log every cooked file\n";
+}
+
+int main(int argc, char** argv) {
+    terra::logger::init();
+
+    terra::cook::CookOptions options;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        auto next = [&]() -> std::string_view { return i + 1 < argc ? argv[++i] : ""; };
+
+        if (arg == "--input")        options.input_dir = next();
+        else if (arg == "--output")  options.output_pack = next();
+        else if (arg == "--cache")   options.cache_dir = next();
+        else if (arg == "--force")   options.force = true;
+        else if (arg == "--verbose") verbose = true;
+        else if (arg == "--jobs") {
+            std::string_view value = next();
+            const char* end = value.data() + value.size();
+            auto [ptr, ec] = std::from_chars(value.data(), end, options.jobs);
+            if (value.empty() || ec != std::errc{} || ptr != end) {
+                std::cerr << "Invalid --jobs value: '" << value << "'\n";
+                print_usage();
+                return 1;
+            }
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (options.input_dir.empty() || options.output_pack.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    terra::logger::get_core_logger()->set_level(verbose ? spdlog::level::trace : spdlog::level::info);
+
+    terra::cook::Cooker cooker(options);
+    bool ok = cooker.run();
+
+    const auto& stats = cooker.get_stats();
+    TR_CORE_INFO("{}: {} sources, {} cooked, {} cached, {} removed, {} failed in {:.2f}s",
+        options.output_pack.filename().string(), stats.sources, stats.cooked, stats.cached,
+        stats.removed, stats.failed, stats.seconds);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+#include "processors.h"
+
+#include "terra/resources/mesh_format.h"
+#include "terra/resources/mesh_optimizer.h"
+#include "terra/resources/mesh_simplifier.h"
+#include "terra/resources/meshlet_builder.h"
+#include "terra/resources/resource_manager.h"
+#include "terra/resources/tiny_obj_loader.h"
+
+#include <glm/glm.hpp>
+
+namespace terra::cook {
+
+static std::string_view as_text(std::span<const u8> bytes) {
+    return { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+}
+
+static std::string get_extension(const std::filesystem::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+    return ext;
+}
+
+// -----------------------------------------------------------------------------
+// Copy
+// -----------------------------------------------------------------------------
+
+static std::vector<std::string> copy_outputs(const std::string& virtual_path) {
+    return { virtual_path };
+}
+
+static std::vector<std::string> mesh_outputs(const std::string& virtual_path) {
+    return { get_cooked_mesh_path(virtual_path) };
+}
+
+static CookResult cook_copy(const CookInput& input) {
+    CookResult result;
+    result.outputs.push_back({ input.virtual_path, { input.contents.begin(), input.contents.end() } });
+    result.success = true;
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+// Text geometry (.txt with [vertex]/[points] + [indices] sections)
+// -----------------------------------------------------------------------------
+
+static bool looks_like_geometry(std::string_view text) {
+    return text.find("[vertex]") != std::string_view::npos || text.find("[points]") != std::string_view::npos;
+}
+
+// Which one depends on the contents, so claim both.
+static std::vector<std::string> geometry_outputs(const std::string& virtual_path) {
+    return { virtual_path, get_cooked_mesh_path(virtual_path) };
+}
+
+static CookResult cook_geometry(const CookInput& input) {
+    std::string_view text = as_text(input.contents);
+
+    // Plain text files (licenses, notes) ship untouched.
+    if (!looks_like_geometry(text))
+        return cook_copy(input);
+
+    MeshData mesh;
+    if (!ResourceManager::import_geometry(text, input.virtual_path, mesh))
+        return {};
+
+    CookResult result;
+    result.outputs.push_back({ get_cooked_mesh_path(input.virtual_path), write_mesh_file(mesh, true) });
+    result.success = true;
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+// Wavefront OBJ
+// -----------------------------------------------------------------------------
+
+static CookResult cook_obj(const CookInput& input) {
+    CookResult result;
+
+    // tinyobj resolves mtllib itself; record them so edits re-cook the mesh.
+    std::filesystem::path virtual_dir = std::filesystem::path(input.virtual_path).parent_path();
+    std::istringstream lines{ std::string(as_text(input.contents)) };
+    for (std::string line; std::getline(lines, line);) {
+        if (line.rfind("mtllib", 0) == 0) {
+            std::string name = line.substr(6);
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t\r") + 1);
+            if (!name.empty())
+                result.dependencies.push_back((virtual_dir / name).generic_string());
+        }
+    }
+
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string err;
+
+    std::string base_dir = input.source_path.parent_path().string() + "/";
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, input.source_path.string().c_str(), base_dir.c_str(), true)) {
+        TR_CORE_ERROR("{}: {}", input.virtual_path, err);
+        return {};
+    }
+    if (!err.empty())
+        TR_CORE_WARN("{}: {}", input.virtual_path, err);
+
+    // The default layout has no normals or UVs: keep positions and take the
+    // color from the face's diffuse material.
+    MeshData mesh;
+    std::unordered_map<u64, u32> remap;
+
+    for (const auto& shape : shapes) {
+        size_t offset = 0;
+        for (size_t face = 0; face < shape.mesh.num_face_vertices.size(); ++face) {
+            const u32 fv = shape.mesh.num_face_vertices[face];
+            const int material_id = face < shape.mesh.material_ids.size() ? shape.mesh.material_ids[face] : -1;
+
+            glm::vec3 color(1.0f);
+            if (material_id >= 0 && material_id < (int) materials.size())
+                color = { materials[material_id].diffuse[0], materials[material_id].diffuse[1], materials[material_id].diffuse[2] };
+
+            for (u32 v = 0; v < fv; ++v) {
+                const int vi = shape.mesh.indices[offset + v].vertex_index;
+                const u64 key = ((u64) (u32) vi << 32) | (u32) (material_id + 1);
+
+                auto [it, inserted] = remap.try_emplace(key, mesh.get_vertex_count());
+                if (inserted) {
+                    mesh.vertices.insert(mesh.vertices.end(), {
+                        attrib.vertices[3 * vi + 0], attrib.vertices[3 * vi + 1], attrib.vertices[3 * vi + 2],
+                        color.r, color.g, color.b,
+                    });
+                }
+                mesh.indices.push_back(it->second);
+            }
+            offset += fv;
+        }
+    }
+
+    if (mesh.indices.empty()) {
+        TR_CORE_ERROR("{}: no triangles", input.virtual_path);
+        return {};
+    }
+
+    auto report = mesh_optimizer::optimize(mesh);
+    TR_CORE_TRACE("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f} ({} clusters)",
+        input.virtual_path, report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr, report.cluster_count);
+
+    u32 lod_count = mesh_simplifier::generate_lods(mesh);
+    TR_CORE_TRACE("{}: {} LODs", input.virtual_path, lod_count);
+
+    u32 meshlet_count = meshlet_builder::build_meshlets(mesh);
+    TR_CORE_TRACE("{}: {} meshlets", input.virtual_path, meshlet_count);
+
+    result.outputs.push_back({ get_cooked_mesh_path(input.virtual_path), write_mesh_file(mesh, true) });
+    result.success = true;
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+// WGSL: drop comments, indentation and blank lines
+// -----------------------------------------------------------------------------
+
+static std::string strip_wgsl(std::string_view src) {
+    std::string out;
+    out.reserve(src.size());
+
+    std::string line;
+    auto flush_line = [&]() {
+        size_t begin = line.find_first_not_of(" \t\r");
+        size_t end = line.find_last_not_of(" \t\r");
+        if (begin != std::string::npos) {
+            out.append(line, begin, end - begin + 1);
+            out += '\n';
+        }
+        line.clear();
+    };
+
+    // WGSL block comments nest and there are no string literals to worry about.
+    int block_depth = 0;
+    for (size_t i = 0; i < src.size(); ++i) {
+        char c = src[i];
+        char next = i + 1 < src.size() ? src[i + 1] : '\0';
+
+        if (block_depth > 0) {
+            if (c == '/' && next == '*') { ++block_depth; ++i; }
+            else if (c == '*' && next == '/') { --block_depth; ++i; line += ' '; }
+            else if (c == '\n') flush_line();
+            continue;
+        }
+
+        if (c == '/' && next == '/') {
+            while (i < src.size() && src[i] != '\n') ++i;
+            flush_line();
+        } else if (c == '/' && next == '*') {
+            ++block_depth;
+            ++i;
+        } else if (c == '\n') {
+            flush_line();
+        } else {
+            line += c;
+        }
+    }
+    flush_line();
+
+    return out;
+}
+
+static CookResult cook_wgsl(const CookInput& input) {
+    std::string stripped = strip_wgsl(as_text(input.contents));
+
+    CookResult result;
+    result.outputs.push_back({ input.virtual_path, { stripped.begin(), stripped.end() } });
+    result.success = true;
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+
+static const std::vector<AssetProcessor>& get_processors() {
+    static const std::vector<AssetProcessor> processors = {
+        { "geometry", 5, { ".txt" }, cook_geometry, geometry_outputs },
+        { "obj",      5, { ".obj" }, cook_obj, mesh_outputs },
+        { "wgsl",     1, { ".wgsl" }, cook_wgsl, copy_outputs },
+        { "copy",     2, {}, cook_copy, copy_outputs },
+    };
+    return processors;
+}
+
+const AssetProcessor& find_processor(const std::filesystem::path& path) {
+    const std::string ext = get_extension(path);
+    const auto& processors = get_processors();
+
+    for (const auto& processor : processors) {
+        for (std::string_view e : processor.extensions) {
+            if (e == ext)
+                return processor;
+        }
+    }
+    return processors.back();
+}
+
+} // namespace terra::cook
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "terrapch.h"
+
+#include <span>
+
+namespace terra::cook {
+
+struct CookedFile {
+    std::string path;        // virtual path inside the pack
+    std::vector<u8> data;
+};
+
+struct CookInput {
+    std::filesystem::path source_path;   // absolute path on disk
+    std::string virtual_path;            // relative to the input root
+    std::span<const u8> contents;
+};
+
+struct CookResult {
+    bool success = false;
+    std::vector<CookedFile> outputs;
+
+    // Other inputs (relative to the input root) whose contents affect the
+    // result, e.g. the .mtl files an .obj references.
+    std::vector<std::string> dependencies;
+};
+
+struct AssetProcessor {
+    std::string_view name;
+
+    // Bump when the processor's output changes so cached results are redone.
+    u32 version;
+
+    std::vector<std::string_view> extensions; // lower case, with the dot; empty = fallback
+    CookResult (*cook)(const CookInput& input);
+
+    // Every virtual path cook() may write for a source, known before cooking
+    // so sources that would overwrite each other's output can be refused.
+    std::vector<std::string> (*get_outputs)(const std::string& virtual_path);
+};
+
+// Picks a processor by extension, falling back to a plain copy.
+const AssetProcessor& find_processor(const std::filesystem::path& path);
+
+} // namespace terra::cook
@@ -0,0 +1,3 @@
+// tiny_obj_loader.cpp
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "terra/resources/tiny_obj_loader.h"
@@ -0,0 +1,18 @@
+// ---------------------
+// Blit
+// ---------------------
+// Copies the top-left region of `source` the size of the target, texel for
+// texel, with one triangle covering the whole target.
+
+@group(0) @binding(0) var source: texture_2d<f32>;
+
+@vertex
+fn vs_main(@builtin(vertex_index) index: u32) -> @builtin(position) vec4f {
+    let corner = vec2f(f32((index << 1u) & 2u), f32(index & 2u));
+    return vec4f(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+
+@fragment
+fn fs_main(@builtin(position) position: vec4f) -> @location(0) vec4f {
+    return textureLoad(source, vec2u(position.xy), 0);
+}
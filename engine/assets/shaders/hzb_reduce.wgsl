@@ -0,0 +1,58 @@
+// ---------------------
+// HZB Reduction
+// ---------------------
+// Each texel of the destination level keeps the farthest depth of the
+// source texels it covers. Level 0 is a power of two no larger than the
+// depth buffer, so a texel there covers up to three depth texels per axis;
+// every later level covers exactly 2x2 of the previous one. Only the
+// top-left `source_size` texels of the depth buffer hold the image; it may
+// be larger while the window is being resized.
+
+struct ReduceParams {
+    source_size: vec2u,
+};
+
+@group(0) @binding(0) var depth_source: texture_depth_2d;
+@group(0) @binding(1) var level_source: texture_2d<f32>;
+@group(0) @binding(2) var destination: texture_storage_2d<r32float, write>;
+@group(0) @binding(3) var<uniform> params: ReduceParams;
+
+@compute @workgroup_size(8, 8)
+fn cs_reduce_depth(@builtin(global_invocation_id) id: vec3u) {
+    let dst_size = textureDimensions(destination);
+    if (any(id.xy >= dst_size)) {
+        return;
+    }
+
+    let src_size = min(params.source_size, textureDimensions(depth_source));
+    let lo = (id.xy * src_size) / dst_size;
+    let hi = min(((id.xy + 1u) * src_size + dst_size - 1u) / dst_size, src_size);
+
+    var depth = 0.0;
+    for (var y = lo.y; y < hi.y; y++) {
+        for (var x = lo.x; x < hi.x; x++) {
+            depth = max(depth, textureLoad(depth_source, vec2u(x, y), 0));
+        }
+    }
+
+    textureStore(destination, id.xy, vec4f(depth, 0.0, 0.0, 0.0));
+}
+
+@compute @workgroup_size(8, 8)
+fn cs_reduce(@builtin(global_invocation_id) id: vec3u) {
+    let dst_size = textureDimensions(destination);
+    if (any(id.xy >= dst_size)) {
+        return;
+    }
+
+    let last = textureDimensions(level_source) - 1u;
+    let base = id.xy * 2u;
+
+    let depth = max(
+        max(textureLoad(level_source, min(base, last), 0).r,
+            textureLoad(level_source, min(base + vec2u(1u, 0u), last), 0).r),
+        max(textureLoad(level_source, min(base + vec2u(0u, 1u), last), 0).r,
+            textureLoad(level_source, min(base + vec2u(1u, 1u), last), 0).r));
+
+    textureStore(destination, id.xy, vec4f(depth, 0.0, 0.0, 0.0));
+}
@@ -0,0 +1,129 @@
+// ---------------------
+// Instance Occlusion Culling
+// ---------------------
+// One invocation per instance. Instances that pass are appended to
+// `output` and counted in `draw.instance_count`, so one DrawIndexedIndirect
+// draws them all.
+//
+// Early phase: frustum test, then the HZB from last frame seen through last
+// frame's camera. Instances in the frustum that fail the HZB are flagged.
+// Late phase: flagged instances are tested against the HZB rebuilt from
+// this frame's depth, with this frame's camera.
+
+struct CullParams {
+    view: mat4x4f,               // camera the HZB was built with
+    projection: mat4x4f,
+    planes: array<vec4f, 6>,     // world space, xyz inward normal
+    hzb_size: vec2f,
+    hzb_mip_count: u32,
+    use_hzb: u32,
+    instance_count: u32,
+    instance_words: u32,         // record size in 32-bit words
+    phase: u32,                  // 0 early, 1 late
+    _padding: u32,
+};
+
+struct DrawArgs {
+    index_count: u32,
+    instance_count: atomic<u32>,
+    first_index: u32,
+    base_vertex: i32,
+    first_instance: u32,
+};
+
+@group(0) @binding(0) var<uniform> params: CullParams;
+@group(0) @binding(1) var<storage, read> bounds: array<vec4f>;
+@group(0) @binding(2) var<storage, read> source: array<u32>;
+@group(0) @binding(3) var<storage, read_write> output: array<u32>;
+@group(0) @binding(4) var<storage, read_write> draw: DrawArgs;
+@group(0) @binding(5) var<storage, read_write> flags: array<u32>;
+@group(0) @binding(6) var hzb: texture_2d<f32>;
+
+const PHASE_EARLY: u32 = 0u;
+const NEAR_EPSILON: f32 = 1e-3;
+
+fn in_frustum(sphere: vec4f) -> bool {
+    for (var i = 0u; i < 6u; i++) {
+        let plane = params.planes[i];
+        if (dot(plane.xyz, sphere.xyz) + plane.w < -sphere.w) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Conservative screen-space extent of a view-space sphere along one axis
+// (Mara & McGuire 2013, simplified to the corners of its depth slab).
+fn project_extent(center: f32, depth: f32, radius: f32, scale: f32) -> vec2f {
+    let near = depth - radius;
+    let far = depth + radius;
+    let a = (center - radius) * scale;
+    let b = (center + radius) * scale;
+    return vec2f(min(a / near, a / far), max(b / near, b / far));
+}
+
+fn occluded(sphere: vec4f) -> bool {
+    let center = (params.view * vec4f(sphere.xyz, 1.0)).xyz;
+    let radius = sphere.w;
+
+    // The camera looks down -z; a sphere touching the near plane is never hidden.
+    let depth = -center.z;
+    if (depth - radius < NEAR_EPSILON) {
+        return false;
+    }
+
+    let x = project_extent(center.x, depth, radius, params.projection[0][0]);
+    let y = project_extent(center.y, depth, radius, params.projection[1][1]);
+
+    // NDC to texture space; texture rows run top to bottom.
+    let uv_min = clamp(vec2f(x.x, -y.y) * 0.5 + 0.5, vec2f(0.0), vec2f(1.0));
+    let uv_max = clamp(vec2f(x.y, -y.x) * 0.5 + 0.5, vec2f(0.0), vec2f(1.0));
+
+    // The level where the rectangle spans at most 2x2 texels.
+    let extent = (uv_max - uv_min) * params.hzb_size;
+    let level = min(u32(max(ceil(log2(max(max(extent.x, extent.y), 1.0))), 0.0)), params.hzb_mip_count - 1u);
+
+    let level_size = textureDimensions(hzb, level);
+    let last = level_size - 1u;
+    let lo = min(vec2u(uv_min * vec2f(level_size)), last);
+    let hi = min(vec2u(uv_max * vec2f(level_size)), last);
+
+    let farthest = max(
+        max(textureLoad(hzb, lo, level).r, textureLoad(hzb, vec2u(hi.x, lo.y), level).r),
+        max(textureLoad(hzb, vec2u(lo.x, hi.y), level).r, textureLoad(hzb, hi, level).r));
+
+    // Depth of the sphere's nearest point, as the rasterizer would write it.
+    let nearest = params.projection * vec4f(0.0, 0.0, center.z + radius, 1.0);
+    return nearest.z / nearest.w > farthest;
+}
+
+@compute @workgroup_size(64)
+fn cs_main(@builtin(global_invocation_id) id: vec3u) {
+    let i = id.x;
+    if (i >= params.instance_count) {
+        return;
+    }
+
+    let sphere = bounds[i];
+
+    if (params.phase == PHASE_EARLY) {
+        flags[i] = 0u;
+        if (!in_frustum(sphere)) {
+            return;
+        }
+        if (params.use_hzb != 0u && occluded(sphere)) {
+            flags[i] = 1u;
+            return;
+        }
+    } else {
+        if (flags[i] == 0u || occluded(sphere)) {
+            return;
+        }
+    }
+
+    let slot = atomicAdd(&draw.instance_count, 1u);
+    let words = params.instance_words;
+    for (var w = 0u; w < words; w++) {
+        output[slot * words + w] = source[i * words + w];
+    }
+}
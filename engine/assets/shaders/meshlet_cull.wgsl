@@ -0,0 +1,111 @@
+// ---------------------
+// Meshlet Culling
+// ---------------------
+// One workgroup per meshlet. Meshlets outside the frustum or facing away
+// from the camera are dropped; the triangles of the rest are appended to
+// `output_indices`, and `draw.index_count` ends up as the count for a
+// single DrawIndexedIndirect.
+
+struct CullParams {
+    model: mat4x4f,
+    normal_matrix: mat4x4f,      // inverse-transpose of `model`
+    planes: array<vec4f, 6>,     // world space, xyz inward normal
+    camera_position: vec4f,      // world space, w = largest axis scale of `model`
+    meshlet_count: u32,
+    first_index: u32,            // of the mesh in the source index buffer
+    index_u16: u32,              // source indices are packed 16-bit pairs
+    cone_culling: u32,
+};
+
+struct Meshlet {
+    center: vec3f,
+    radius: f32,
+    cone_axis: vec3f,
+    cone_cutoff: f32,
+    index_offset: u32,
+    triangle_count: u32,
+    _padding0: u32,
+    _padding1: u32,
+};
+
+struct DrawArgs {
+    index_count: atomic<u32>,
+    instance_count: u32,
+    first_index: u32,
+    base_vertex: i32,
+    first_instance: u32,
+};
+
+@group(0) @binding(0) var<uniform> params: CullParams;
+@group(0) @binding(1) var<storage, read> meshlets: array<Meshlet>;
+@group(0) @binding(2) var<storage, read> source_indices: array<u32>;
+@group(0) @binding(3) var<storage, read_write> output_indices: array<u32>;
+@group(0) @binding(4) var<storage, read_write> draw: DrawArgs;
+
+const GROUP_SIZE: u32 = 64u;
+const CULLED: u32 = 0xffffffffu;
+
+var<workgroup> output_base: u32;
+
+fn is_visible(meshlet: Meshlet) -> bool {
+    let center = (params.model * vec4f(meshlet.center, 1.0)).xyz;
+    let radius = meshlet.radius * params.camera_position.w;
+
+    for (var i = 0u; i < 6u; i++) {
+        let plane = params.planes[i];
+        if (dot(plane.xyz, center) + plane.w < -radius) {
+            return false;
+        }
+    }
+
+    if (params.cone_culling != 0u && meshlet.cone_cutoff < 1.0) {
+        let axis = normalize((params.normal_matrix * vec4f(meshlet.cone_axis, 0.0)).xyz);
+        let view = center - params.camera_position.xyz;
+        if (dot(view, axis) >= meshlet.cone_cutoff * length(view) + radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+fn fetch_index(i: u32) -> u32 {
+    let at = params.first_index + i;
+    if (params.index_u16 != 0u) {
+        return (source_indices[at >> 1u] >> ((at & 1u) * 16u)) & 0xffffu;
+    }
+    return source_indices[at];
+}
+
+@compute @workgroup_size(64)
+fn cs_main(
+    @builtin(workgroup_id) group_id: vec3u,
+    @builtin(num_workgroups) group_count: vec3u,
+    @builtin(local_invocation_index) local_index: u32,
+) {
+    // Large meshes are dispatched as a 2D grid of workgroups.
+    let meshlet_index = group_id.x + group_id.y * group_count.x;
+    if (meshlet_index >= params.meshlet_count) {
+        return;
+    }
+
+    let meshlet = meshlets[meshlet_index];
+    let index_count = meshlet.triangle_count * 3u;
+
+    if (local_index == 0u) {
+        var base = CULLED;
+        if (is_visible(meshlet)) {
+            base = atomicAdd(&draw.index_count, index_count);
+        }
+        output_base = base;
+    }
+
+    let base = workgroupUniformLoad(&output_base);
+    if (base == CULLED) {
+        return;
+    }
+
+    for (var i = local_index; i < index_count; i += GROUP_SIZE) {
+        output_indices[base + i] = fetch_index(meshlet.index_offset + i);
+    }
+}
@@ -20,6 +20,18 @@ struct Instance {
 @group(1) @binding(0)
 var<storage, read> instances: array<Instance>;
 
+// ---------------------
+// Per-mesh Vertex Decode
+// ---------------------
+// Quantized positions are stored relative to the mesh bounds; the
+// renderer binds each mesh's offset and scale (identity for float meshes).
+struct MeshDecode {
+    position_offset: vec4f,
+    position_scale: vec4f,
+};
+@group(2) @binding(0)
+var<uniform> mesh_decode: MeshDecode;
+
 // ---------------------
 // Vertex Input
 // ---------------------
@@ -32,12 +44,27 @@ struct VertexInput {
 // ---------------------
 // Vertex Output
 // ---------------------
+// Positions are @invariant so the depth prepass (vs_depth) and the colour
+// pass produce identical depth, which the colour pass tests with Equal.
 struct VertexOutput {
-    @builtin(position) position: vec4f,
+    @builtin(position) @invariant position: vec4f,
     @location(0) v_color: vec3f,
     @location(1) v_instance_color: vec4f,
 };
 
+struct DepthOutput {
+    @builtin(position) @invariant position: vec4f,
+};
+
+fn clip_position(local: vec3f, instance: Instance) -> vec4f {
+    let position = mesh_decode.position_offset.xyz + local * mesh_decode.position_scale.xyz;
+
+    // Animate using time (e.g., rotating model)
+    let world = instance.model * vec4f(position, 1.0);
+    // standard MVP
+    return ubo.u_proj * ubo.u_view * world;
+}
+
 // ---------------------
 // Vertex Shader
 // ---------------------
@@ -47,12 +74,7 @@ fn vs_main(in: VertexInput) -> VertexOutput {
 
     let instance = instances[in.instance_idx];
 
-    // Animate using time (e.g., rotating model)
-    let world = instance.model * vec4f(in.position, 1.0);
-    // standard MVP
-    let clip  = ubo.u_proj * ubo.u_view * world;
-
-    out.position = clip;
+    out.position = clip_position(in.position, instance);
 
     // Pass through colors
     out.v_color = in.color;
@@ -61,6 +83,14 @@ fn vs_main(in: VertexInput) -> VertexOutput {
     return out;
 }
 
+// Position only, for the depth prepass.
+@vertex
+fn vs_depth(in: VertexInput) -> DepthOutput {
+    var out: DepthOutput;
+    out.position = clip_position(in.position, instances[in.instance_idx]);
+    return out;
+}
+
 // ---------------------
 // Fragment Shader
 // ---------------------
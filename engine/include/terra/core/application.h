@@ -3,12 +3,14 @@
 #include "terra/core/base.h"
 #include "terra/core/logger.h"
 #include "terra/core/context/context.h"
+#include "terra/core/frame_limiter.h"
 #include "terra/core/window.h"
 #include "terra/core/layer.h"
 #include "terra/core/layer_stack.h"
 
 #include "terra/events/event.h"
 #include "terra/events/application_event.h"
+#include "terra/events/key_event.h"
 
 #include <glm/glm.hpp>
 
@@ -27,11 +29,24 @@ struct CommandLineArgs {
         TR_CORE_ASSERT(index < count, "Index out of bounds for CommandLineArgs");
         return args[index];
     }
+
+    bool has_flag(std::string_view flag) const {
+        for (i32 i = 1; i < count; ++i)
+            if (flag == args[i]) return true;
+        return false;
+    }
+
+    // The argument following `flag`, or nullptr.
+    const char* get_option(std::string_view flag) const {
+        for (i32 i = 1; i + 1 < count; ++i)
+            if (flag == args[i]) return args[i + 1];
+        return nullptr;
+    }
 };
 
 class Application {
 public:
-    Application(const std::string& name = "Terra Application", CommandLineArgs args = {});
+    Application(const std::string& name = "Terra Application", CommandLineArgs args = {}, const ContextProps& context_props = ContextProps());
     virtual ~Application();
 
     void on_event(Event& e);
@@ -42,6 +57,10 @@ public:
     CommandLineArgs get_command_line_args() const { return m_command_line_args; }
 
     void close();
+
+    // Caps the frame rate, pacing frames evenly; 0 removes the cap.
+    void set_target_fps(f32 fps) { m_frame_limiter.set_target_fps(fps); }
+    f32 get_target_fps() const { return m_frame_limiter.get_target_fps(); }
     
     UILayer* get_ui_layer() { return m_ui_layer; }
     
@@ -57,6 +76,9 @@ private:
 
     bool on_window_close(WindowCloseEvent& e);
     bool on_window_resize(WindowResizeEvent& e);
+    bool on_key_pressed(KeyPressedEvent& e);
+
+    void init_profiling();
 
     UILayer* m_ui_layer;
     LayerStack m_layer_stack;
@@ -70,6 +92,8 @@ private:
 
     f32 m_last_frame_time = 0.0f;
 
+    FrameLimiter m_frame_limiter;
+
     static Application* s_instance;
 
     friend int ::main(int argc, char** argv);
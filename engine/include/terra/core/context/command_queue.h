@@ -1,6 +1,8 @@
 #pragma once
 
 #include "terrapch.h"
+#include "terra/core/context/readback_manager.h"
+#include "terra/debug/gpu_profiler.h"
 
 namespace terra {
 
@@ -27,6 +29,11 @@ public:
     void end_render_pass();
     void poll([[maybe_unused]] bool yield_to_browser); // Poll/tick device for async processing
 
+    // GPU to CPU copies, completed from poll().
+    ReadbackManager& get_readback() { return *m_readback; }
+    // Times every render pass begun through create_render_pass().
+    GpuProfiler& get_gpu_profiler() { return *m_gpu_profiler; }
+
     wgpu::Queue get_native_queue() const { return m_queue; }
 
     wgpu::RenderPassEncoder get_render_pass_encoder() const { return m_render_pass_encoder; }
@@ -39,6 +46,8 @@ private:
     wgpu::Queue m_queue = nullptr;
     wgpu::CommandEncoder m_encoder = nullptr;
     wgpu::RenderPassEncoder m_render_pass_encoder = nullptr;
+    scope<ReadbackManager> m_readback;
+    scope<GpuProfiler> m_gpu_profiler; // reads back through m_readback
 
 
     bool m_frame_active = false;
@@ -8,9 +8,17 @@ class Window;
 class CommandQueue;
 
 struct ContextProps {
-    // Placeholder for future context settings like:
-    // bool enableValidation = true;
-    // std::string preferredAdapterName;
+    // Present modes in order of preference; the first the surface supports
+    // is used, else Fifo, which every surface supports. Mailbox and
+    // Immediate cut latency, at the cost of rendering frames that are never
+    // shown (Mailbox) or of tearing (Immediate); FifoRelaxed tears only
+    // when a frame misses its vblank.
+    std::vector<wgpu::PresentMode> present_modes = { wgpu::PresentMode::Fifo };
+
+    // Frames the CPU may submit before the GPU has finished the oldest;
+    // starting a frame waits until fewer are in flight. Lower means less
+    // input lag, at some cost in throughput. 0 leaves it unbounded.
+    u32 max_frame_latency = 2;
 };
 
 class WebGPUContext {
@@ -19,6 +27,12 @@ public:
     ~WebGPUContext();
 
     void init(Window* window_handle);
+
+    // init() in two halves: begin_init() issues the adapter and device
+    // requests and returns at once, finish_init() waits for the device and
+    // configures the surface. Work that needs neither can run in between.
+    void begin_init(Window* window_handle);
+    void finish_init();
     void swap_buffers();
 
     wgpu::Device get_native_device() { return m_device; }
@@ -29,6 +43,16 @@ public:
 
     void configure_surface(wgpu::TextureFormat preferred_format);
 
+    // Takes effect when the next surface texture is acquired, since the
+    // current one may still be presented; false, changing nothing, when the
+    // surface does not support `mode`.
+    bool set_present_mode(wgpu::PresentMode mode);
+    wgpu::PresentMode get_present_mode() const { return m_requested_present_mode; }
+    const std::vector<wgpu::PresentMode>& get_supported_present_modes() const { return m_supported_present_modes; }
+
+    void set_max_frame_latency(u32 frames) { m_props.max_frame_latency = frames; }
+    u32 get_max_frame_latency() const { return m_props.max_frame_latency; }
+
     wgpu::TextureFormat get_preferred_format() const { return m_surface_format; }
 
     std::pair<u32, u32> get_framebuffer_size();
@@ -40,10 +64,25 @@ private:
     ContextProps m_props;
     
     wgpu::Instance m_instance = nullptr;
+    wgpu::Adapter m_adapter = nullptr;
     wgpu::Device  m_device = nullptr;
     wgpu::Surface m_surface = nullptr;
 
     wgpu::TextureFormat m_surface_format = wgpu::TextureFormat::Undefined;
+    wgpu::PresentMode m_present_mode = wgpu::PresentMode::Fifo;           // what the surface is configured with
+    wgpu::PresentMode m_requested_present_mode = wgpu::PresentMode::Fifo; // applied at the next configure
+    std::vector<wgpu::PresentMode> m_supported_present_modes;
+
+    void request_device();
+    bool m_device_request_ended = false;
+
+    void wait_for_frame_latency();
+    // In flight = presented - completed. Both only grow, so completions that
+    // arrive after a timed-out wait cannot corrupt the count; frames before
+    // m_frames_abandoned are no longer waited for.
+    u64 m_frames_presented = 0;
+    u64 m_frames_abandoned = 0;
+    std::atomic<u64> m_frames_completed = 0;
 
     scope<CommandQueue> m_queue;
 
@@ -9,23 +9,9 @@ void wgpu_poll_events(wgpu::Device device, bool yield_to_browser = true);
 
 void sleep_for_ms(unsigned int milliseconds);
 
-/**
- * @brief Utility function to get a WebGPU adapter, so that
- *     wgpu::Adapter adapter = requestAdapterSync(options);
- * is roughly equivalent to
- *     const adapter = await navigator.gpu.requestAdapter(options);
- */
-wgpu::Adapter request_adapter_sync(wgpu::Instance instance, wgpu::RequestAdapterOptions const* options);
-
-/**
- * @brief Utility function to get a WebGPU device, so that
- *     wgpu::Device device = requestDeviceSync(adapter, options);
- * is roughly equivalent to
- *     const device = await adapter.requestDevice(descriptor);
- * It is very similar to requestAdapter
- */
-wgpu::Device request_device_sync(wgpu::Adapter adapter, wgpu::DeviceDescriptor const* descriptor);
-
+// Processes instance events until a callback sets `done`. Spins rather than
+// sleeping between polls, except in the browser, which needs to be yielded to.
+void process_events_until(wgpu::Instance instance, const bool& done);
 
 void inspect_adapter(wgpu::Adapter adapter);
 void inspect_device(wgpu::Device device);
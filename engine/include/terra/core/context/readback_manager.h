@@ -0,0 +1,91 @@
+#pragma once
+
+#include "terrapch.h"
+
+#include <atomic>
+#include <future>
+
+namespace terra {
+
+// Mapped contents of a finished readback, valid only inside the callback.
+// Texture rows are bytes_per_row apart, which is padded to a multiple of
+// 256 bytes; `data` is null when the copy or the map failed.
+struct ReadbackData {
+    const void* data = nullptr;
+    u64 size = 0;
+    u32 bytes_per_row = 0;
+    u32 rows = 0;
+};
+
+using ReadbackCallback = std::function<void(const ReadbackData&)>;
+
+// GPU to CPU copies that never stall the frame. Each request copies its
+// source into a MapRead staging buffer right away (so it sees all work
+// submitted before it) and maps that buffer asynchronously; callbacks and
+// futures are completed from poll(), which the CommandQueue calls every
+// frame. Results typically arrive a frame or two after the request.
+//
+// Staging buffers are pooled by power-of-two size and reused across
+// requests; ones left unused for RETIRE_FRAMES polls are released.
+//
+// Requests and poll() belong to the render thread. A future must not be
+// waited on from that thread, as nothing would poll.
+class ReadbackManager {
+public:
+    static constexpr u64 RETIRE_FRAMES = 120;
+    static constexpr u64 MIN_STAGING_SIZE = 256;
+
+    explicit ReadbackManager(wgpu::Device device);
+    ~ReadbackManager();
+
+    // `source` needs CopySrc; offset and size must be multiples of 4.
+    void read_buffer(wgpu::Buffer source, u64 offset, u64 size, ReadbackCallback callback);
+    std::future<std::vector<u8>> read_buffer(wgpu::Buffer source, u64 offset, u64 size);
+
+    // One 2D region of a mip level. `texture` needs CopySrc and a format
+    // with a fixed texel size (depth only for Depth32Float and Depth16Unorm).
+    void read_texture(wgpu::Texture texture, wgpu::Origin3D origin, wgpu::Extent3D extent, u32 mip_level, ReadbackCallback callback);
+    // Rows are packed tightly in the result.
+    std::future<std::vector<u8>> read_texture(wgpu::Texture texture, wgpu::Origin3D origin, wgpu::Extent3D extent, u32 mip_level = 0);
+
+    // Runs the callbacks of finished requests and retires idle staging buffers.
+    void poll();
+
+    struct Stats {
+        u32 pending = 0;
+        u32 staging_buffers = 0; // pending plus pooled
+        u64 staging_bytes = 0;
+    };
+    const Stats& get_stats() const { return m_stats; }
+
+private:
+    enum class State : u8 { Mapping, Mapped, Failed };
+
+    struct Request {
+        wgpu::Buffer staging;
+        u64 staging_size = 0;
+        ReadbackData data;
+        ReadbackCallback callback;
+        std::atomic<State> state = State::Mapping;
+    };
+
+    struct FreeBuffer {
+        wgpu::Buffer buffer;
+        u64 released_frame = 0;
+    };
+
+    wgpu::Buffer acquire_staging(u64 size);
+    void release_staging(wgpu::Buffer buffer, u64 size);
+    void submit(scope<Request> request, u64 copy_size, const std::function<void(wgpu::CommandEncoder, wgpu::Buffer)>& record);
+
+    wgpu::Device m_device = nullptr;
+    wgpu::Queue m_queue = nullptr;
+
+    std::vector<scope<Request>> m_pending;
+    std::unordered_map<u64, std::vector<FreeBuffer>> m_free; // by staging size
+    u64 m_frame_index = 0;
+
+    Stats m_stats;
+};
+
+} // namespace terra
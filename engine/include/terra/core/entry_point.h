@@ -11,15 +11,22 @@ extern terra::Application* terra::create_application(terra::CommandLineArgs args
 int main(int argc, char** argv) {
     terra::logger::init();
 
-    PROFILE_BEGIN_SESSION("TerraInit", "terra_init.json");
-    auto app = terra::create_application({ argc, argv });
+    // Frames are recorded on request (see Application::init_profiling);
+    // startup and shutdown, which have no frames, take their own flags.
+    const terra::CommandLineArgs args = { argc, argv };
+
+    if (args.has_flag("--profile-startup")) {
+        PROFILE_BEGIN_SESSION("TerraInit", "terra_init.ttrace");
+    }
+    auto app = terra::create_application(args);
     PROFILE_END_SESSION();
 
-    PROFILE_BEGIN_SESSION("TerraRuntime", "terra_runtime.json");
     app->run();
-    PROFILE_END_SESSION();
+    PROFILE_END_SESSION(); // a capture cut short by closing the window
 
-    PROFILE_BEGIN_SESSION("TerraDestruction", "terra_destruction.json");
+    if (args.has_flag("--profile-shutdown")) {
+        PROFILE_BEGIN_SESSION("TerraDestruction", "terra_destruction.ttrace");
+    }
     delete app;
     PROFILE_END_SESSION();
 }
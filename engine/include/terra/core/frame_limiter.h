@@ -0,0 +1,36 @@
+#pragma once
+
+#include "terrapch.h"
+
+#include <chrono>
+
+namespace terra {
+
+// Paces frames to a target rate. Most of each wait is slept, to leave the
+// core idle; the last stretch is spun, because sleeps overshoot by up to a
+// scheduler tick. How long to spin adapts to the overshoot actually seen.
+class FrameLimiter {
+public:
+    // 0 leaves frames unpaced.
+    explicit FrameLimiter(f32 target_fps = 0.0f);
+
+    void set_target_fps(f32 fps);
+    f32 get_target_fps() const { return m_target_fps; }
+
+    // Call once per frame; returns when the frame's slot is over. A frame
+    // that overran its slot starts a new schedule instead of being caught
+    // up on with shorter frames.
+    void wait();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    f32 m_target_fps = 0.0f;
+    Clock::duration m_period{ 0 };
+    Clock::time_point m_deadline{};
+
+    // Time before a deadline where sleeping stops and spinning starts.
+    Clock::duration m_spin_margin = std::chrono::microseconds(1500);
+};
+
+} // namespace terra
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "terra/core/base.h"
+
+#include <map>
+
+namespace terra {
+
+// Offset allocator over an abstract [0, capacity) range, for suballocating
+// GPU buffers. Best fit over free blocks kept both by offset (to coalesce on
+// free) and by size (to find a fit), so every operation is O(log n). The
+// caller frees with the same offset and size it allocated.
+class RangeAllocator {
+public:
+    static constexpr u64 INVALID_OFFSET = ~0ull;
+
+    explicit RangeAllocator(u64 capacity = 0);
+
+    // Returns INVALID_OFFSET when no free block is large enough.
+    u64 allocate(u64 size, u64 alignment = 1);
+    void free(u64 offset, u64 size);
+
+    u64 get_capacity() const { return m_capacity; }
+    u64 get_used() const { return m_used; }
+    bool is_empty() const { return m_used == 0; }
+    u64 get_largest_free_block() const;
+
+private:
+    using SizeIndex = std::multimap<u64, u64>; // size -> offset
+
+    void insert_block(u64 offset, u64 size);
+    void erase_block(std::map<u64, std::pair<u64, SizeIndex::iterator>>::iterator it);
+
+    u64 m_capacity = 0;
+    u64 m_used = 0;
+
+    // offset -> (size, entry in m_by_size)
+    std::map<u64, std::pair<u64, SizeIndex::iterator>> m_by_offset;
+    SizeIndex m_by_size;
+};
+
+} // namespace terra
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "terra/core/base.h"
+
+namespace terra {
+
+// Process-wide, strictly increasing stamp. Objects take a fresh one when
+// created and whenever state that cached GPU recordings depend on changes,
+// so caches can compare revisions instead of pointers, which may be reused
+// after a free. Never returns 0.
+u64 next_revision();
+
+} // namespace terra
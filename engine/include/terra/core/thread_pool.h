@@ -0,0 +1,63 @@
+#pragma once
+
+#include "terra/core/base.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace terra {
+
+// Fixed-size worker pool. Tasks run in FIFO order; submit() hands back a
+// future, parallel_for() blocks with the calling thread helping out so it is
+// safe to call from inside a task.
+class ThreadPool {
+public:
+    // 0 picks hardware_concurrency - 1 (at least one worker).
+    explicit ThreadPool(u32 thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<typename F>
+    auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        // std::function needs a copyable callable, so the task lives on the heap.
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        std::future<R> future = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    void parallel_for(u32 count, const std::function<void(u32)>& fn);
+
+    // Blocks until the queue is empty and no task is running.
+    void wait_idle();
+
+    u32 get_thread_count() const { return (u32) m_workers.size(); }
+
+    // Engine-wide pool, created on first use.
+    static ThreadPool& get();
+
+private:
+    void enqueue(std::function<void()> task);
+    void worker_loop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_task_cv;
+    std::condition_variable m_idle_cv;
+
+    u32 m_active = 0;
+    bool m_stopping = false;
+};
+
+} // namespace terra
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "terrapch.h"
+
+namespace terra {
+
+class ReadbackManager;
+
+// GPU time of each render pass, from timestamps written at the start and
+// end of the pass. Each frame's timestamps are resolved and read back
+// asynchronously, so timings trail the frame that produced them by a frame
+// or two. Without the TimestampQuery feature every call is a no-op.
+//
+// GPU timestamps run on their own clock. They are mapped onto the CPU's by
+// the smallest gap seen between a pass being recorded and it starting on
+// the GPU, which cannot be negative; the estimate is renewed every
+// CALIBRATION_FRAMES frames so the two clocks cannot drift apart. With
+// profiling enabled, passes are written to the trace on a "GPU" track.
+class GpuProfiler {
+public:
+    static constexpr u32 MAX_PASSES = 64; // per frame; later passes go untimed
+    static constexpr u64 CALIBRATION_FRAMES = 256;
+
+    GpuProfiler(wgpu::Device device, ReadbackManager& readback);
+    ~GpuProfiler();
+
+    bool is_supported() const { return m_query_set != nullptr; }
+
+    // Fills `writes` for a render pass about to begin; false when the pass
+    // cannot be timed.
+    bool begin_pass(std::string_view name, wgpu::RenderPassTimestampWrites& writes);
+
+    // Resolves the passes begun since the last call and starts reading them
+    // back. Call once per frame, after the frame's passes are submitted.
+    void end_frame();
+
+    struct PassTiming {
+        std::string name;
+        f64 start_ms = 0.0;    // from the start of the frame's first pass
+        f64 duration_ms = 0.0;
+    };
+
+    // The most recent frame whose timings have come back.
+    const std::vector<PassTiming>& get_last_frame() const { return m_last_frame; }
+    // First pass start to last pass end, idle gaps included.
+    f64 get_last_frame_ms() const { return m_last_frame_ms; }
+
+private:
+    struct Pass {
+        std::string name;
+        f64 cpu_begin_us = 0.0; // steady_clock, when recorded
+    };
+
+    void on_resolved(const std::vector<Pass>& passes, const u64* timestamps);
+
+    wgpu::Device m_device = nullptr;
+    ReadbackManager& m_readback;
+
+    wgpu::QuerySet m_query_set = nullptr;
+    wgpu::Buffer m_resolve_buffer = nullptr;
+
+    std::vector<Pass> m_passes; // this frame's
+
+    f64 m_clock_offset_us = 0.0; // GPU minus CPU time
+    f64 m_window_offset_us = std::numeric_limits<f64>::max(); // smallest gap this window
+    u64 m_window_frames = 0;
+    bool m_calibrated = false; // a whole window has been seen
+
+    std::vector<PassTiming> m_last_frame;
+    f64 m_last_frame_ms = 0.0;
+};
+
+} // namespace terra
@@ -6,188 +6,407 @@
  * Purpose:
  *   This profiler is used for testing, debugging, and performance
  *   optimization only. It allows you to annotate sections of code
- *   (scopes and functions) and gather timing information in JSON form
- *   suitable for Chrome’s tracing tools or other visualization front-ends.
+ *   (scopes and functions) and gather timing information in a compact
+ *   binary trace that converts to JSON for Chrome's tracing tools or
+ *   other visualization front-ends.
  *
- *   **NOT** part of the core Terra API—include and enable this
- *   only when you need to drill into simulation performance or verify
- *   execution flow. When ENABLE_PROFILING is set to 0 (the default),
- *   all profiling macros compile away to nothing.
+ *   **NOT** part of the core Terra API. It is compiled in by default and
+ *   records nothing until asked to; building with ENABLE_PROFILING set
+ *   to 0 compiles all profiling macros away to nothing.
  *
  * Author:
  *   Rodrigo Vildósola
  *
  * Usage:
  *   - Wrap the top of your `main()` or test harness with:
- *       PROFILE_BEGIN_SESSION("MySession", "my_profile.json");
+ *       PROFILE_BEGIN_SESSION("MySession", "my_profile.ttrace");
  *   - Annotate functions or code regions with:
  *       PROFILE_FUNCTION();
  *       // or
  *       PROFILE_SCOPE("SomeScopeName");
+ *   - Sample a value, once a frame say, as a counter graph:
+ *       PROFILE_COUNTER("Bytes Uploaded", bytes);
+ *   - Optionally name the calling thread's track:
+ *       PROFILE_THREAD("Worker");
  *   - At shutdown or end of your session:
  *       PROFILE_END_SESSION();
+ *   - Or, once per frame, call PROFILE_FRAME() and record a window of
+ *     frames with Instrumentor::capture_frames(), or keep a flight
+ *     recorder that saves the seconds before each over-budget frame.
+ *     Applications take --profile-frames N and --flight-recorder, and
+ *     F9 captures the next frames.
  *
- *   The output file can be opened in Chrome:
- *     chrome://tracing → Load your JSON → Inspect timings.
+ *   Convert the trace and open it in Chrome:
+ *     python3 tools/ttrace_to_json.py my_profile.ttrace
+ *     chrome://tracing → Load my_profile.json → Inspect timings.
+ *
+ * Cost:
+ *   While not recording, a scope is one predictable branch. Otherwise it
+ *   reads the clock twice and appends a 24-byte event to a ring
+ *   buffer owned by its thread; no locks, allocation or formatting. A
+ *   background thread drains the rings to the file. When a ring fills
+ *   faster than it is drained, new events are dropped and counted.
+ *
+ *   On Linux, Instrumentor::enable_hardware_counters() (--hardware-counters)
+ *   adds each scope's cycles, instructions and cache and branch misses. Two
+ *   counter reads per scope make that far more expensive, a microsecond
+ *   or two, and an outer scope's counts include its inner scopes' reads.
+ *   Linux is not a supported build target yet (platform_detection.h), so
+ *   elsewhere this only logs that the counters are unavailable.
  *
  ******************************************************************************/
 
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <fstream>
-#include <iomanip>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
-#include <mutex>
-#include <sstream>
+#include <unordered_map>
+#include <vector>
 
 namespace Profiler {
 
-    using FloatingPointMicroseconds = std::chrono::duration<double, std::micro>;
+    using Clock = std::chrono::steady_clock;
+
+    inline uint64_t now_ticks() { return (uint64_t) Clock::now().time_since_epoch().count(); }
+
+    inline uint64_t microseconds_to_ticks(double microseconds) {
+        return (uint64_t) std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(microseconds)).count();
+    }
+
+    enum class EventKind : uint32_t { Span = 0, Counter = 1, Hardware = 2 };
 
-    struct ProfileResult
+    // A Hardware event follows the span it measures on the same thread and
+    // holds two counter deltas: `name` is the pair's index, `start` and
+    // `end` counters 2 * name and 2 * name + 1.
+    struct Event
     {
-        std::string name;
-        FloatingPointMicroseconds start;
-        std::chrono::microseconds elapsed_time;
-        std::thread::id thread_id;
+        uint64_t start; // Clock ticks
+        uint64_t end;   // for a counter, the bits of its double value
+        uint32_t name;  // interned by Instrumentor::intern()
+        EventKind kind;
     };
+    static_assert(sizeof(Event) == 24);
 
-    struct InstrumentationSession
+    static constexpr uint32_t HARDWARE_COUNTERS = 5;
+    static constexpr uint32_t HARDWARE_EVENTS = (HARDWARE_COUNTERS + 1) / 2; // per span
+    inline constexpr const char* HARDWARE_COUNTER_NAMES[HARDWARE_COUNTERS] = {
+        "cycles", "instructions", "l1d_read_misses", "llc_misses", "branch_misses"
+    };
+    using HardwareValues = std::array<uint64_t, HARDWARE_COUNTERS>;
+
+    // One read of a thread's counter group. The kernel multiplexes groups it
+    // cannot fit on the PMU; they only count while running.
+    struct HardwareSample
     {
-        std::string name;
+        HardwareValues values;
+        uint64_t time_enabled = 0; // ns
+        uint64_t time_running = 0; // ns
     };
 
-    class Instrumentor
+    // Single-producer, single-consumer ring of events: the owning thread
+    // pushes, the writer thread drains.
+    class ThreadBuffer
     {
     public:
-        Instrumentor(const Instrumentor&) = delete;
-        Instrumentor(Instrumentor&&) = delete;
+        static constexpr uint64_t CAPACITY = 1u << 16; // events, a power of two
+
+        ThreadBuffer(uint32_t id, std::string name)
+            : id(id), name(std::move(name)), m_events(new Event[CAPACITY]) {}
+        ~ThreadBuffer();
 
-        void begin_session(const std::string& name, const std::string& filepath = "results.json")
+        bool push(const Event& event)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (current_session)
-            {
-                internal_end_session();
+            const uint64_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) >= CAPACITY) {
+                m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
             }
-            output_stream.open(filepath);
+            m_events[head & (CAPACITY - 1)] = event;
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
 
-            if (output_stream.is_open())
-            {
-                current_session = new InstrumentationSession({name});
-                write_header();
+        // All of `events` or, when they do not fit, none.
+        bool push(const Event* events, uint32_t count)
+        {
+            const uint64_t head = m_head.load(std::memory_order_relaxed);
+            if (head + count - m_tail.load(std::memory_order_acquire) > CAPACITY) {
+                m_dropped.store(m_dropped.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+                return false;
             }
+            for (uint32_t i = 0; i < count; ++i)
+                m_events[(head + i) & (CAPACITY - 1)] = events[i];
+            m_head.store(head + count, std::memory_order_release);
+            return true;
         }
 
-        void end_session()
+        // Hands the pending events to `sink` in at most two contiguous runs.
+        template<typename F>
+        void drain(F&& sink)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            internal_end_session();
+            const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+            const uint64_t head = m_head.load(std::memory_order_acquire);
+            if (head == tail)
+                return;
+
+            const uint64_t first = tail & (CAPACITY - 1);
+            const uint64_t count = head - tail;
+            const uint64_t run = std::min(count, CAPACITY - first);
+            sink(&m_events[first], run);
+            if (run < count)
+                sink(&m_events[0], count - run);
+
+            m_tail.store(head, std::memory_order_release);
         }
 
-        void write_profile(const ProfileResult& result)
-        {
-            std::stringstream json;
-            json << std::setprecision(3) << std::fixed;
+        uint64_t get_dropped() const { return m_dropped.load(std::memory_order_relaxed); }
 
-            if (!is_first_entry) {
-                json << ",";  // Add comma only after the first entry
-            } else {
-                is_first_entry = false; // Set flag after the first entry
-            }
+        const uint32_t id;
+        std::string name;             // guarded by the Instrumentor's mutex
+        uint64_t dropped_written = 0; // likewise
 
-            json << "{";
-            json << "\"cat\":\"function\",";
-            json << "\"dur\":" << (result.elapsed_time.count()) << ',';
-            json << "\"name\":\"" << result.name << "\",";
-            json << "\"ph\":\"X\",";
-            json << "\"pid\":0,";
-            json << "\"tid\":\"" << result.thread_id << "\",";
-            json << "\"ts\":" << result.start.count();
-            json << "}";
-
-            std::lock_guard<std::mutex> lock(mutex);
-            if (current_session)
-            {
-                output_stream << json.str();
-                output_stream.flush();
-            }
-        }
+        // This thread's perf_event_open group, opened on first use by the
+        // owner; perf_slots maps each counter to its place in a group read.
+        int perf_leader = -1;
+        int perf_error = 0; // errno of the failed leader open
+        bool perf_opened = false;
+        std::array<int, HARDWARE_COUNTERS> perf_fds{};
+        std::array<int8_t, HARDWARE_COUNTERS> perf_slots{};
 
-        static Instrumentor& get()
+    private:
+        std::unique_ptr<Event[]> m_events;
+        alignas(64) std::atomic<uint64_t> m_head{ 0 }; // written by the owner
+        alignas(64) std::atomic<uint64_t> m_tail{ 0 }; // written by the writer
+        std::atomic<uint64_t> m_dropped{ 0 };
+    };
+
+    struct FlightRecorderSettings
+    {
+        double history_seconds = 5.0;  // kept in memory, and so in each dump
+        double frame_budget_ms = 50.0; // a longer frame triggers a dump
+        std::string output_directory = ".";
+        // Events beyond this are trimmed early, bounding memory use.
+        size_t max_events = size_t(1) << 20;
+    };
+
+    struct ThreadEvent
+    {
+        Event event;
+        uint32_t thread; // ThreadBuffer::id
+    };
+
+    // Recording is off until a session, a frame capture, the flight
+    // recorder or a live view turns it on; until then each scope costs one
+    // branch.
+    //
+    // Sessions, frame captures and the flight recorder are controlled from
+    // one thread, the one calling mark_frame().
+    class Instrumentor
+    {
+    public:
+        Instrumentor(const Instrumentor&) = delete;
+        Instrumentor(Instrumentor&&) = delete;
+
+        void begin_session(const std::string& name, const std::string& filepath = "results.ttrace");
+        void end_session();
+
+        // Records the `frames` frames following the next mark_frame() into
+        // `filepath`. Requested while a session is open (e.g. during startup),
+        // it starts at the first mark_frame() after that session ends.
+        // Ignored while another capture is pending or running.
+        void capture_frames(uint32_t frames, const std::string& filepath = "terra_capture.ttrace");
+        bool is_capturing() const { return m_capture_pending || m_capture_remaining > 0; }
+
+        // Keeps the last few seconds of events in memory and writes them to
+        // a new file in the output directory whenever a frame runs over
+        // budget, at most once per history length.
+        void enable_flight_recorder(const FlightRecorderSettings& settings = {});
+        void disable_flight_recorder();
+        bool is_flight_recorder_enabled() const { return m_flight_enabled.load(std::memory_order_relaxed); }
+
+        // Linux only: records the hardware counter deltas of every scope.
+        // False, leaving them off, when the counters cannot be opened, for
+        // want of permission (perf_event_paranoid) or support. Disabling
+        // stops reading them; each thread's group stays open (other threads
+        // may be mid-read) until the thread exits, and is reused on re-enable.
+        bool enable_hardware_counters();
+        void disable_hardware_counters() { s_hardware.store(false, std::memory_order_relaxed); }
+        static bool is_counting_hardware() { return s_hardware.load(std::memory_order_relaxed); }
+
+        // The calling thread's counters; false when it has none.
+        bool read_hardware(HardwareSample& sample);
+
+        // Hands drained events to an in-process viewer, which collects them
+        // with take_live_events(). Events it does not collect are dropped,
+        // oldest first, beyond MAX_LIVE_EVENTS.
+        static constexpr size_t MAX_LIVE_EVENTS = size_t(1) << 20;
+        void enable_live_view();
+        void disable_live_view();
+        bool is_live_view_enabled() const { return m_live_enabled.load(std::memory_order_relaxed); }
+        // Appends the events drained since the last call to `out`.
+        void take_live_events(std::vector<ThreadEvent>& out);
+
+        // Appends the names interned since `names` was last filled.
+        void copy_names(std::vector<std::string>& names);
+        std::unordered_map<uint32_t, std::string> get_thread_names();
+        uint32_t get_frame_name() const { return m_frame_name; }
+        uint32_t get_gpu_thread() const { return m_gpu_buffer->id; }
+
+        // Frame boundary: records the frame as a span, starts and stops
+        // frame captures and checks the flight recorder's budget.
+        void mark_frame();
+
+        static bool is_active() { return s_active.load(std::memory_order_relaxed); }
+
+        // Stable small id for a scope name; takes a lock, so call sites
+        // cache the result.
+        uint32_t intern(std::string_view name);
+
+        void record(uint32_t name, uint64_t start, uint64_t end)
         {
-            static Instrumentor instance;
-            return instance;
+            thread_buffer().push({ start, end, name, EventKind::Span });
         }
 
-    private:
+        void record(uint32_t name, uint64_t start, uint64_t end, const HardwareSample& begin, const HardwareSample& finish)
+        {
+            // Descheduled for part of the scope (the NMI watchdog or another
+            // perf user holding a counter): the deltas would undercount.
+            if (finish.time_running - begin.time_running < finish.time_enabled - begin.time_enabled) {
+                record(name, start, end);
+                return;
+            }
 
-        bool is_first_entry = true;
+            HardwareValues delta = {};
+            for (uint32_t i = 0; i < HARDWARE_COUNTERS; ++i)
+                delta[i] = finish.values[i] - begin.values[i];
 
-        Instrumentor() : current_session(nullptr) {}
-        ~Instrumentor() { end_session(); }
+            Event events[1 + HARDWARE_EVENTS];
+            events[0] = { start, end, name, EventKind::Span };
+            for (uint32_t i = 0; i < HARDWARE_EVENTS; ++i)
+                events[1 + i] = { delta[i * 2], i * 2 + 1 < HARDWARE_COUNTERS ? delta[i * 2 + 1] : 0, i, EventKind::Hardware };
+            thread_buffer().push(events, 1 + HARDWARE_EVENTS);
+        }
 
-        void write_header()
+        // A value sampled now, drawn as a graph beside the threads.
+        void counter(uint32_t name, double value)
         {
-            output_stream << "{\"otherData\": {},\"traceEvents\":[";
-            // output_stream.flush();
+            if (is_active())
+                thread_buffer().push({ now_ticks(), std::bit_cast<uint64_t>(value), name, EventKind::Counter });
         }
 
-        void write_footer()
+        // A span on the separate "GPU" track, already converted to Clock
+        // ticks. Only one thread may record GPU spans.
+        void record_gpu(std::string_view name, uint64_t start, uint64_t end);
+
+        void set_thread_name(std::string_view name);
+
+        static Instrumentor& get()
         {
-            output_stream << "]}";
-            // output_stream.flush();
+            static Instrumentor instance;
+            return instance;
         }
 
-        void internal_end_session()
+    private:
+        Instrumentor();
+        ~Instrumentor();
+
+        ThreadBuffer& thread_buffer()
         {
-            if (current_session)
-            {
-                write_footer();
-                output_stream.close();
-                delete current_session;
-                current_session = nullptr;
-                is_first_entry = true; // Reset for next session
-            }
+            thread_local std::shared_ptr<ThreadBuffer> buffer = register_thread();
+            return *buffer;
         }
 
-    private:
-        std::mutex mutex;
-        InstrumentationSession* current_session;
+        std::shared_ptr<ThreadBuffer> register_thread();
+        void update_recording();
+        void writer_loop();
+        void drain_all();
+        void write_names();
+        void write_thread(const ThreadBuffer& buffer);
+        void write_dropped();
+        void trim_history();
+        void dump_history();
+
+        static inline std::atomic<bool> s_active{ false };
+        static inline std::atomic<bool> s_hardware{ false };
+
+        std::mutex mutex; // everything below up to the frame state
+        std::unordered_map<std::string, uint32_t> m_name_ids;
+        std::vector<std::string> m_names;
+        std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+        std::unordered_map<uint32_t, std::string> m_thread_names; // outlives exited threads
+        std::shared_ptr<ThreadBuffer> m_gpu_buffer;
+        uint32_t m_next_thread_id = 0;
+
+        bool m_session_open = false;
         std::ofstream output_stream;
-        std::vector<ProfileResult> m_results;
-
+        size_t m_names_written = 0;
+        std::vector<uint32_t> m_threads_written; // named in this session
+
+        std::atomic<bool> m_flight_enabled{ false };
+        FlightRecorderSettings m_flight;
+        std::deque<ThreadEvent> m_history;
+        bool m_dump_requested = false;
+        double m_dump_frame_ms = 0.0;
+        uint64_t m_last_dump = 0;
+
+        std::atomic<bool> m_live_enabled{ false };
+        std::vector<ThreadEvent> m_live;
+
+        std::thread m_writer;
+        std::condition_variable m_writer_cv;
+        bool m_stopping = false;
+
+        // Frame state, owned by the thread calling mark_frame().
+        uint32_t m_frame_name = 0;
+        uint64_t m_last_frame = 0;
+        uint64_t m_budget_ticks = 0;
+        bool m_capture_pending = false;
+        uint32_t m_capture_frames = 0;
+        uint32_t m_capture_remaining = 0;
+        std::string m_capture_path;
     };
 
     class InstrumentationTimer
     {
     public:
-        InstrumentationTimer(const char* name) : name(name), stopped(false)
+        explicit InstrumentationTimer(uint32_t name) : name(name)
         {
-            start_timepoint = std::chrono::steady_clock::now();
+            if (!Instrumentor::is_active())
+                return;
+            if (Instrumentor::is_counting_hardware())
+                hardware = Instrumentor::get().read_hardware(counters);
+            start = now_ticks();
         }
 
         ~InstrumentationTimer()
         {
-            if (!stopped) stop();
-        }
-
-        void stop()
-        {
-            auto end_timepoint = std::chrono::steady_clock::now();
-            auto high_res_start = FloatingPointMicroseconds{ start_timepoint.time_since_epoch() };
-            auto elapsed_time = std::chrono::time_point_cast<std::chrono::microseconds>(end_timepoint).time_since_epoch() - std::chrono::time_point_cast<std::chrono::microseconds>(start_timepoint).time_since_epoch();
-
-            Instrumentor::get().write_profile({ name, high_res_start, elapsed_time, std::this_thread::get_id() });
-            stopped = true;
+            if (!start)
+                return;
+
+            const uint64_t end = now_ticks();
+            HardwareSample end_counters;
+            if (hardware && Instrumentor::get().read_hardware(end_counters))
+                Instrumentor::get().record(name, start, end, counters, end_counters);
+            else
+                Instrumentor::get().record(name, start, end);
         }
     private:
-        const char* name;
-        std::chrono::time_point<std::chrono::steady_clock> start_timepoint;
-        bool stopped;
+        uint32_t name;
+        uint64_t start = 0;
+        bool hardware = false;
+        HardwareSample counters;
     };
 
     namespace Utils {
@@ -220,8 +439,11 @@ namespace Profiler {
     }
 }
 
-// Macros for profiling
-#define ENABLE_PROFILING 0
+// Macros for profiling. Compiled in unless the build sets ENABLE_PROFILING
+// to 0 (TR_ENABLE_PROFILING=OFF); recording itself is off until started.
+#ifndef ENABLE_PROFILING
+    #define ENABLE_PROFILING 1
+#endif
 #if ENABLE_PROFILING
 	// Resolve which function signature macro will be used. Note that this only
 	// is resolved when the (pre)compiler starts, so the syntax highlighting
@@ -237,13 +459,23 @@ namespace Profiler {
     #define PROFILE_BEGIN_SESSION(name, filepath) ::Profiler::Instrumentor::get().begin_session(name, filepath)
     #define PROFILE_END_SESSION() ::Profiler::Instrumentor::get().end_session()
     #define PROFILE_SCOPE_LINE2(name, line) constexpr auto fixedName##line = ::Profiler::Utils::cleanup_output_string(name, "__cdecl ");\
-											::Profiler::InstrumentationTimer timer##line(fixedName##line.data)
+											static const uint32_t profileName##line = ::Profiler::Instrumentor::get().intern(fixedName##line.data);\
+											::Profiler::InstrumentationTimer timer##line(profileName##line)
     #define PROFILE_SCOPE_LINE(name, line) PROFILE_SCOPE_LINE2(name, line)
     #define PROFILE_SCOPE(name) PROFILE_SCOPE_LINE(name, __LINE__)
     #define PROFILE_FUNCTION() PROFILE_SCOPE(FUNC_SIG)
+    #define PROFILE_THREAD(name) ::Profiler::Instrumentor::get().set_thread_name(name)
+    #define PROFILE_FRAME() ::Profiler::Instrumentor::get().mark_frame()
+    #define PROFILE_COUNTER_LINE2(name, value, line) static const uint32_t counterName##line = ::Profiler::Instrumentor::get().intern(name);\
+											::Profiler::Instrumentor::get().counter(counterName##line, (double) (value))
+    #define PROFILE_COUNTER_LINE(name, value, line) PROFILE_COUNTER_LINE2(name, value, line)
+    #define PROFILE_COUNTER(name, value) PROFILE_COUNTER_LINE(name, value, __LINE__)
 #else
     #define PROFILE_BEGIN_SESSION(name, filepath)
     #define PROFILE_END_SESSION()
     #define PROFILE_SCOPE(name)
     #define PROFILE_FUNCTION()
+    #define PROFILE_THREAD(name)
+    #define PROFILE_FRAME()
+    #define PROFILE_COUNTER(name, value)
 #endif
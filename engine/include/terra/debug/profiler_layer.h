@@ -0,0 +1,96 @@
+#pragma once
+
+#include "terra/core/layer.h"
+#include "terra/debug/profiler.h"
+#include "terra/events/key_event.h"
+
+#include <deque>
+
+namespace terra {
+
+// Live view of the profiler: frame times of the last HISTORY_FRAMES
+// frames, a flame graph of any one of them and its most expensive scopes.
+// Fed from the Instrumentor's live view, which is only on while the
+// window is open and not paused. F10 shows and hides the window.
+class ProfilerLayer : public Layer {
+public:
+    static constexpr u32 HISTORY_FRAMES = 300;
+    // How far behind the newest frame the live view shows: GPU timings
+    // and events from other threads arrive a few frames late.
+    static constexpr u32 LIVE_LAG_FRAMES = 3;
+    static constexpr u32 TOP_SCOPES = 15;
+
+    ProfilerLayer() : Layer("ProfilerLayer") {}
+
+    virtual void on_detach() override;
+    virtual void on_ui_render() override;
+    virtual void on_event(Event& event) override;
+
+    void set_open(bool open);
+    bool is_open() const { return m_open; }
+
+private:
+    struct Frame {
+        u64 start = 0;
+        u64 end = 0;
+    };
+
+    // A live view take: events from `first_event` on were collected at `time`.
+    struct Take {
+        u64 time = 0;
+        u64 first_event = 0;
+    };
+
+    // Spans of the selected frame, laid out for the flame graph.
+    struct Span {
+        u64 start = 0; // clipped to the frame
+        u64 end = 0;
+        u32 name = 0;
+        u32 depth = 0;
+    };
+
+    struct Track {
+        u32 thread = 0;
+        u32 depth = 0; // rows used
+        std::vector<Span> spans;
+    };
+
+    struct ScopeStats {
+        u32 name = 0;
+        u32 calls = 0;
+        f64 inclusive_ms = 0.0;
+        f64 exclusive_ms = 0.0;
+    };
+
+    bool on_key_pressed(KeyPressedEvent& e);
+    void set_paused(bool paused);
+
+    void collect_events();
+    void build_view(u32 frame);
+    const char* get_name(u32 name) const;
+
+    void draw_frame_times();
+    void draw_flame_graph();
+    void draw_scope_table(const char* id, bool by_exclusive);
+
+    bool m_open = false;
+    bool m_paused = false;
+
+    std::deque<Frame> m_frames;                 // oldest first
+    std::deque<Profiler::ThreadEvent> m_events; // spans and counters, in arrival order
+    std::deque<Take> m_takes;
+    u64 m_first_event = 0; // index of m_events.front() among all events collected
+    u32 m_selected = 0;    // into m_frames
+
+    std::vector<std::string> m_names;
+    std::unordered_map<u32, std::string> m_thread_names;
+    std::vector<Profiler::ThreadEvent> m_incoming;
+
+    // Built by build_view() for the selected frame.
+    Frame m_view_frame;
+    u64 m_view_events = 0; // events collected when it was built
+    std::vector<Track> m_tracks;
+    std::vector<ScopeStats> m_scopes;
+};
+
+} // namespace terra
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "terra/core/base.h"
+
+#include <string_view>
+
+namespace terra {
+
+// 64-bit FNV-1a. Used for asset paths and content hashes, not for anything
+// that needs to resist collisions on purpose.
+constexpr u64 FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+constexpr u64 FNV_PRIME        = 0x100000001b3ull;
+
+inline u64 hash_bytes(const void* data, size_t size, u64 seed = FNV_OFFSET_BASIS) {
+    const u8* bytes = static_cast<const u8*>(data);
+    u64 hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+constexpr u64 hash_string(std::string_view str, u64 seed = FNV_OFFSET_BASIS) {
+    u64 hash = seed;
+    for (char c : str) {
+        hash ^= (u8) c;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+} // namespace terra
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/renderer/shader.h"
+
+namespace terra {
+
+class WebGPUContext;
+
+// Draws the top-left region of a texture into a render pass's colour
+// target at 1:1, for targets rendered into a larger texture.
+class Blitter {
+public:
+    Blitter(WebGPUContext& context, wgpu::TextureFormat target_format);
+
+    // `source` must have TextureBinding usage and a float format.
+    void draw(wgpu::RenderPassEncoder pass, wgpu::TextureView source);
+
+    wgpu::TextureFormat get_target_format() const { return m_target_format; }
+
+private:
+    WebGPUContext& m_context;
+    wgpu::TextureFormat m_target_format;
+
+    ref<Shader> m_shader;
+    wgpu::BindGroupLayout m_bind_group_layout;
+    wgpu::RenderPipeline m_pipeline;
+
+    wgpu::TextureView m_bound_source; // of m_bind_group
+    wgpu::BindGroup m_bind_group;
+};
+
+} // namespace terra
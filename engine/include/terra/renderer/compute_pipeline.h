@@ -0,0 +1,90 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/renderer/shader.h"
+
+namespace terra {
+
+class WebGPUContext;
+
+enum class ComputeBindingKind : u8 {
+    Buffer,
+    Texture,        // read with textureLoad
+    StorageTexture, // write-only
+};
+
+struct ComputeBindingSpec {
+    u32 binding = 0;
+    ComputeBindingKind kind = ComputeBindingKind::Buffer;
+
+    wgpu::BufferBindingType buffer_type = wgpu::BufferBindingType::Storage;
+    u64 min_size = 0;
+
+    wgpu::TextureSampleType sample_type = wgpu::TextureSampleType::UnfilterableFloat;
+    wgpu::TextureFormat storage_format = wgpu::TextureFormat::Undefined;
+
+    static ComputeBindingSpec buffer(u32 binding, wgpu::BufferBindingType type, u64 min_size = 0) {
+        ComputeBindingSpec spec;
+        spec.binding = binding;
+        spec.buffer_type = type;
+        spec.min_size = min_size;
+        return spec;
+    }
+
+    static ComputeBindingSpec texture(u32 binding, wgpu::TextureSampleType sample_type) {
+        ComputeBindingSpec spec;
+        spec.binding = binding;
+        spec.kind = ComputeBindingKind::Texture;
+        spec.sample_type = sample_type;
+        return spec;
+    }
+
+    static ComputeBindingSpec storage_texture(u32 binding, wgpu::TextureFormat format) {
+        ComputeBindingSpec spec;
+        spec.binding = binding;
+        spec.kind = ComputeBindingKind::StorageTexture;
+        spec.storage_format = format;
+        return spec;
+    }
+};
+
+struct ComputePipelineSpecification {
+    ref<Shader> shader = nullptr;
+    std::string entry_point = "cs_main";
+
+    // Bind group layouts in group order, visible to the compute stage.
+    std::vector<std::vector<ComputeBindingSpec>> groups;
+
+    std::string label = "Compute Pipeline";
+};
+
+class ComputePipeline {
+public:
+    ComputePipeline(WebGPUContext& context, const ComputePipelineSpecification& spec);
+    ~ComputePipeline();
+
+    void bind(wgpu::ComputePassEncoder encoder) const;
+
+    wgpu::BindGroupLayout get_bind_group_layout(u32 index = 0) const {
+        TR_CORE_ASSERT(index < m_bind_group_layouts.size(), "Invalid bind group layout index");
+        return m_bind_group_layouts[index];
+    }
+
+    const ComputePipelineSpecification& get_specification() const { return m_spec; }
+
+    // Workgroups needed for `items` invocations of `group_size` each.
+    static u32 get_group_count(u32 items, u32 group_size) { return (items + group_size - 1) / group_size; }
+
+private:
+    void create_pipeline(const ComputePipelineSpecification& spec);
+
+    ComputePipelineSpecification m_spec;
+
+    WebGPUContext& m_context;
+
+    wgpu::ComputePipeline m_pipeline;
+    wgpu::PipelineLayout m_layout;
+    std::vector<wgpu::BindGroupLayout> m_bind_group_layouts;
+};
+
+} // namespace terra
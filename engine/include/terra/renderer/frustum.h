@@ -0,0 +1,70 @@
+#pragma once
+
+#include "terra/core/base.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+namespace terra {
+
+struct BoundingSphere {
+    glm::vec3 center{ 0.0f };
+    f32 radius = 0.0f;
+};
+
+struct BoundingBox {
+    glm::vec3 min{ 0.0f };
+    glm::vec3 max{ 0.0f };
+
+    glm::vec3 get_center() const { return (min + max) * 0.5f; }
+    glm::vec3 get_extent() const { return (max - min) * 0.5f; }
+};
+
+// View frustum as six inward-facing planes (xyz = normal, w = distance),
+// extracted from a view-projection matrix (Gribb & Hartmann). The near
+// plane assumes a -1..1 clip depth, which is conservative for 0..1.
+class Frustum {
+public:
+    Frustum() = default;
+    explicit Frustum(const glm::mat4& view_projection) { set(view_projection); }
+
+    void set(const glm::mat4& m) {
+        const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        m_planes = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+        for (glm::vec4& plane : m_planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    bool intersects(const BoundingSphere& sphere) const {
+        for (const glm::vec4& plane : m_planes) {
+            if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+                return false;
+        }
+        return true;
+    }
+
+    bool intersects(const BoundingBox& box) const {
+        const glm::vec3 center = box.get_center();
+        const glm::vec3 extent = box.get_extent();
+        for (const glm::vec4& plane : m_planes) {
+            const glm::vec3 n(plane);
+            // Projected radius of the box onto the plane normal.
+            const f32 radius = glm::dot(extent, glm::abs(n));
+            if (glm::dot(n, center) + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    const std::array<glm::vec4, 6>& get_planes() const { return m_planes; }
+
+private:
+    std::array<glm::vec4, 6> m_planes{};
+};
+
+} // namespace terra
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/core/range_allocator.h"
+#include "terra/renderer/buffer.h"
+#include "terra/resources/vertex_quantization.h"
+
+namespace terra {
+
+class WebGPUContext;
+
+// Where a mesh lives inside the arena. Draws use `base_vertex` and
+// `first_index` against the page buffers.
+struct GeometryAllocation {
+    static constexpr u32 INVALID = ~0u;
+
+    u32 vertex_pool = INVALID;
+    u32 vertex_page = 0;
+    u32 base_vertex = 0;
+    u32 vertex_count = 0;
+
+    u32 index_pool = INVALID;
+    u32 index_page = 0;
+    u32 first_index = 0;
+    u32 index_count = 0; // as allocated, rounded up to an even count for Uint16
+
+    bool is_valid() const { return vertex_pool != INVALID && index_pool != INVALID; }
+};
+
+// Shared vertex and index buffers that meshes are suballocated from, so
+// draws of different meshes rarely need to rebind buffers. Vertex pools are
+// keyed by stride and index pools by format. Each pool grows in fixed-size
+// pages; a mesh too large for a page gets a page of its own. Freed ranges
+// can be reused at once: queue writes are ordered after work already
+// submitted, so in-flight draws still see the old contents.
+class GeometryArena {
+public:
+    static constexpr u64 VERTEX_PAGE_SIZE = 32ull << 20;
+    static constexpr u64 INDEX_PAGE_SIZE  = 16ull << 20;
+
+    explicit GeometryArena(WebGPUContext& context);
+
+    // Copies the data in. Returns an invalid allocation if a page could not be created.
+    GeometryAllocation allocate(
+        const void* vertex_data, u32 vertex_count, u32 vertex_stride,
+        const void* index_data, u32 index_count, wgpu::IndexFormat index_format,
+        std::string_view debug_name = "Mesh");
+
+    void free(const GeometryAllocation& allocation);
+
+    const VertexBuffer& get_vertex_buffer(const GeometryAllocation& allocation) const;
+    const IndexBuffer& get_index_buffer(const GeometryAllocation& allocation) const;
+
+    // Layout of the per-mesh MeshDecodeParams group, shared by every mesh
+    // allocated here and every pipeline built with mesh_decode.
+    const wgpu::BindGroupLayout& get_decode_bind_group_layout() const { return m_decode_bind_group_layout; }
+
+    struct Stats {
+        u32 page_count = 0;
+        u64 reserved_bytes = 0;
+        u64 used_bytes = 0;
+    };
+    Stats get_stats() const;
+
+private:
+    struct Page {
+        RangeAllocator allocator; // in elements (vertices or indices)
+        bool dedicated = false;   // sized for one oversized mesh, released when freed
+        VertexBuffer vertex_buffer;
+        IndexBuffer index_buffer;
+    };
+
+    struct Pool {
+        bool is_index = false;
+        u32 element_size = 0; // bytes
+        wgpu::IndexFormat index_format = wgpu::IndexFormat::Undefined;
+        std::vector<scope<Page>> pages; // null once a dedicated page is released
+    };
+
+    u32 find_or_create_pool(bool is_index, u32 element_size, wgpu::IndexFormat format);
+    bool allocate_in_pool(u32 pool_index, u64 count, u64 alignment, u32& page, u32& offset, std::string_view debug_name);
+    void free_in_pool(u32 pool_index, u32 page, u64 offset, u64 count);
+
+    WebGPUContext& m_context;
+    std::vector<Pool> m_pools;
+    wgpu::BindGroupLayout m_decode_bind_group_layout;
+};
+
+} // namespace terra
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "terrapch.h"
+
+#include <atomic>
+
+namespace terra {
+
+// GPU resource traffic, counted where it happens and on whichever thread
+// that is. The renderer collects it into RendererStats once a frame, so
+// work done by loaders between frames lands in the next frame's counts.
+class GpuCounters {
+public:
+    struct Frame {
+        u64 bytes_uploaded = 0; // WriteBuffer and WriteTexture
+        u32 buffers_created = 0;
+        u32 bind_groups_created = 0;
+        u32 pipelines_bound = 0; // on passes; bundles bind once, when recorded
+    };
+
+    static void add_upload(u64 bytes) { s_bytes_uploaded.fetch_add(bytes, std::memory_order_relaxed); }
+    static void add_buffer() { s_buffers_created.fetch_add(1, std::memory_order_relaxed); }
+    static void add_bind_group() { s_bind_groups_created.fetch_add(1, std::memory_order_relaxed); }
+    static void add_pipeline_bind() { s_pipelines_bound.fetch_add(1, std::memory_order_relaxed); }
+
+    // Everything counted since the last call.
+    static Frame collect() {
+        return {
+            s_bytes_uploaded.exchange(0, std::memory_order_relaxed),
+            s_buffers_created.exchange(0, std::memory_order_relaxed),
+            s_bind_groups_created.exchange(0, std::memory_order_relaxed),
+            s_pipelines_bound.exchange(0, std::memory_order_relaxed),
+        };
+    }
+
+private:
+    static inline std::atomic<u64> s_bytes_uploaded{ 0 };
+    static inline std::atomic<u32> s_buffers_created{ 0 };
+    static inline std::atomic<u32> s_bind_groups_created{ 0 };
+    static inline std::atomic<u32> s_pipelines_bound{ 0 };
+};
+
+} // namespace terra
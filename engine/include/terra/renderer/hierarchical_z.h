@@ -0,0 +1,57 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/renderer/buffer.h"
+#include "terra/renderer/compute_pipeline.h"
+
+#include <glm/glm.hpp>
+
+namespace terra {
+
+class WebGPUContext;
+
+// Max-depth mip pyramid of the scene depth buffer (HZB), for occlusion
+// tests. Level 0 is the largest power of two not above the depth buffer in
+// each axis, so every further level halves exactly; a texel holds the
+// farthest depth of the region it covers.
+class HierarchicalZ {
+public:
+    static constexpr wgpu::TextureFormat FORMAT = wgpu::TextureFormat::R32Float;
+
+    explicit HierarchicalZ(WebGPUContext& context);
+
+    // `depth` must have TextureBinding usage; the image is its top-left
+    // `width` x `height` texels. Re-creates the pyramid when the size
+    // changes; it holds nothing until the next build().
+    void set_source(wgpu::TextureView depth, u32 width, u32 height);
+
+    // Encodes the reduction of the source depth into every level.
+    void build(wgpu::CommandEncoder encoder);
+
+    // Sampling view over all levels.
+    wgpu::TextureView get_view() const { return m_view; }
+    glm::uvec2 get_size() const { return { m_width, m_height }; }
+    u32 get_mip_count() const { return (u32) m_mip_views.size(); }
+
+    // Whether the levels hold a built depth buffer.
+    bool is_built() const { return m_built; }
+
+private:
+    WebGPUContext& m_context;
+
+    scope<ComputePipeline> m_reduce_depth; // depth buffer -> level 0
+    scope<ComputePipeline> m_reduce;       // level n - 1 -> level n
+
+    wgpu::TextureView m_source;
+    UniformBuffer m_params; // size of the image within the source
+    wgpu::Texture m_texture;
+    wgpu::TextureView m_view;
+    std::vector<wgpu::TextureView> m_mip_views;
+    std::vector<wgpu::BindGroup> m_bind_groups; // one per level
+
+    u32 m_width = 0;
+    u32 m_height = 0;
+    bool m_built = false;
+};
+
+} // namespace terra
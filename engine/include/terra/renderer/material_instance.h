@@ -76,6 +76,19 @@ public:
     wgpu::BindGroup get_bind_group(u32 index = 0) const;
 
     void bind_storage_buffer(u32 group, u32 binding, wgpu::Buffer buffer);
+
+    // For render bundles: sets the pipeline and group 0 only. Storage groups
+    // come from create_storage_bind_group() so the recording owns them.
+    void bind(wgpu::RenderBundleEncoder bundle_encoder) const;
+    wgpu::BindGroup create_storage_bind_group(u32 group, u32 binding, wgpu::Buffer buffer) const;
+
+    // Same as bind(), with the pipeline's depth prepass variant.
+    void bind_depth(wgpu::RenderPassEncoder pass_encoder);
+    void bind_depth(wgpu::RenderBundleEncoder bundle_encoder) const;
+
+    // Changes whenever the pipeline or group 0 is replaced. Uniform writes
+    // keep it: recordings reference the buffers, not their contents.
+    u64 get_revision() const noexcept { return m_revision; }
     
     // Material properties
     void set_name(const std::string& name) { m_name = name; }
@@ -100,6 +113,7 @@ private:
     std::unordered_map<std::string, u32> m_parameter_bindings;
 
     wgpu::BindGroup m_bind_group = nullptr;
+    u64 m_revision = 0;
 
     std::unordered_map<u32, wgpu::BindGroup> m_storage_bind_groups;
 
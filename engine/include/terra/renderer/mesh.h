@@ -2,22 +2,43 @@
 
 #include "terra/core/base.h"
 #include "terra/renderer/buffer.h"
+#include "terra/renderer/frustum.h"
+#include "terra/renderer/geometry_arena.h"
 #include "terra/renderer/pipeline_specification.h"
+#include "terra/resources/asset_handle.h"
+#include "terra/resources/mesh_format.h"
+#include "terra/resources/vertex_quantization.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp> // for glm::translate, rotate, scale
 
+#include <span>
+
 
 namespace terra {
 
+// Bind group index of the per-mesh MeshDecodeParams uniform in pipelines
+// created with PipelineSpecification::mesh_decode.
+constexpr u32 MESH_DECODE_GROUP = 2;
+
 struct MeshSpecification {
     const void* vertex_data = nullptr;
     u32 vertex_count = 0;
 
-    const u32* index_data = nullptr;
+    const void* index_data = nullptr;
     u32 index_count = 0;
+    wgpu::IndexFormat index_format = wgpu::IndexFormat::Uint32;
 
     VertexBufferLayoutSpec layout;
+    MeshDecodeParams decode;
+
+    // Index ranges of the LOD chain, finest first. Empty means a single
+    // level covering all indices.
+    std::span<const MeshLod> lods;
+    BoundingSphere bounds;
+
+    // Clusters over LOD 0 for GPU culling; see MeshletCuller.
+    std::span<const Meshlet> meshlets;
 
     std::string_view debug_name = "Unnamed Mesh";
 };
@@ -26,23 +47,77 @@ class Mesh {
 public:
     // Mesh(const std::vector<Vertex>& vertices, const std::vector<u32>& indices);
     Mesh(const MeshSpecification& spec);
-    ~Mesh() = default;
+    ~Mesh();
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
 
-    const VertexBuffer& get_vertex_buffer() const { return m_vertex_buffer; }
-    const IndexBuffer& get_index_buffer() const { return m_index_buffer; }
+    // Shared arena pages; draw with get_base_vertex() and get_first_index().
+    const VertexBuffer& get_vertex_buffer() const { return m_arena->get_vertex_buffer(m_allocation); }
+    const IndexBuffer& get_index_buffer() const { return m_arena->get_index_buffer(m_allocation); }
+    u32 get_base_vertex() const { return m_allocation.base_vertex; }
+    u32 get_first_index() const { return m_allocation.first_index; }
+    bool is_valid() const { return m_allocation.is_valid(); }
+    // Meshes are immutable once uploaded, so this only tells instances apart.
+    u64 get_revision() const { return m_revision; }
+    wgpu::BindGroup get_decode_bind_group() const { return m_decode_bind_group; }
+
+    // Layout of meshes uploaded with the current vertex quantization.
     static VertexBufferLayoutSpec get_default_layout();
+    static VertexBufferLayoutSpec get_layout(VertexQuantization mode, bool normals = false);
+
+    // Applies to meshes created afterwards; pipelines must be built with the
+    // matching get_default_layout(). Defaults to Unorm16.
+    static void set_vertex_quantization(VertexQuantization mode) { s_vertex_quantization = mode; }
+    static VertexQuantization get_vertex_quantization() { return s_vertex_quantization; }
 
+    // Counts of the full-detail mesh (LOD 0).
     u32 get_index_count() const { return m_index_count; }
     u32 get_vertex_count() const { return m_vertex_count; }
 
-    static ref<Mesh> from_file(const std::filesystem::path& path);
+    u32 get_lod_count() const { return (u32) m_lods.size(); }
+    const MeshLod& get_lod(u32 lod) const { return m_lods[std::min(lod, get_lod_count() - 1)]; }
+    const std::vector<MeshLod>& get_lods() const { return m_lods; }
+
+    // Storage buffer of Meshlet records, for meshes imported dense enough to have them.
+    bool has_meshlets() const { return m_meshlet_count > 0; }
+    u32 get_meshlet_count() const { return m_meshlet_count; }
+    const StorageBuffer& get_meshlet_buffer() const { return m_meshlet_buffer; }
+
+    const BoundingSphere& get_bounds() const { return m_bounds; }
+
+    // Loads through the AssetRegistry, so repeated loads of the same file (or
+    // of identical contents) share one mesh. The returned handle owns one reference.
+    static MeshHandle from_file(const std::filesystem::path& path);
+
+    // Builds a new mesh from geometry text already in memory; no deduplication.
+    static ref<Mesh> from_source(std::string_view source, std::string_view debug_name);
+
+    // Uploads already-decoded geometry (e.g. a cooked .tmesh); no deduplication.
+    static ref<Mesh> from_data(const MeshData& data, std::string_view debug_name);
+
+    static BoundingSphere compute_bounds(const MeshData& data);
 
 private:
-    VertexBuffer m_vertex_buffer;
-    IndexBuffer m_index_buffer;
+    static VertexQuantization s_vertex_quantization;
+
+    // Shared so the arena outlives meshes still held after the renderer shuts down.
+    ref<GeometryArena> m_arena;
+    GeometryAllocation m_allocation;
+
+    UniformBuffer m_decode_buffer;
+    wgpu::BindGroup m_decode_bind_group;
 
     u32 m_index_count = 0;
     u32 m_vertex_count = 0;
+
+    std::vector<MeshLod> m_lods;
+    BoundingSphere m_bounds;
+
+    StorageBuffer m_meshlet_buffer;
+    u32 m_meshlet_count = 0;
+
+    u64 m_revision = 0;
 };
 
 } // namespace terra 
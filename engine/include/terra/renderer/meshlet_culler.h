@@ -0,0 +1,88 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/renderer/buffer.h"
+#include "terra/renderer/compute_pipeline.h"
+#include "terra/renderer/frustum.h"
+
+#include <glm/glm.hpp>
+
+namespace terra {
+
+class Mesh;
+class WebGPUContext;
+
+// GPU cluster culling for meshes with meshlets. Every draw added during a
+// scene gets a slot with its own compacted index buffer and indirect draw
+// arguments; cull() runs one compute workgroup per meshlet that tests it
+// against the frustum and its normal cone and appends the surviving
+// triangles. Slots are reused from frame to frame and only grow.
+class MeshletCuller {
+public:
+    explicit MeshletCuller(WebGPUContext& context);
+
+    // Whether every buffer culling `mesh` binds as storage fits the device's
+    // maxStorageBufferBindingSize. A mesh on an oversized dedicated arena
+    // page does not, and must be drawn unculled.
+    bool can_cull(const Mesh& mesh) const;
+
+    // Reserves the next slot for drawing LOD 0 of `mesh` with `transform`.
+    u32 add(const Mesh& mesh, const glm::mat4& transform);
+
+    // Encodes culling for the slots added since the last call. `encoder`
+    // must be submitted before the render passes that draw the slots.
+    void cull(wgpu::CommandEncoder encoder, const Frustum& frustum, const glm::vec3& camera_position, bool cone_culling);
+
+    // Uint32 indices relative to the mesh's base vertex.
+    const wgpu::Buffer& get_index_buffer(u32 slot) const { return m_slots[slot].output; }
+    // DrawIndexedIndirect arguments at offset 0.
+    const wgpu::Buffer& get_indirect_buffer(u32 slot) const { return m_slots[slot].indirect; }
+
+    bool has_pending() const { return m_active > 0; }
+    u32 get_slot_count() const { return m_active; }
+
+private:
+    // Matches CullParams in meshlet_cull.wgsl.
+    struct alignas(16) CullParams {
+        glm::mat4 model;
+        glm::mat4 normal_matrix; // inverse-transpose of model, for cone axes
+        glm::vec4 planes[6];
+        glm::vec4 camera_position; // w = largest axis scale
+        u32 meshlet_count = 0;
+        u32 first_index = 0;
+        u32 index_u16 = 0;
+        u32 cone_culling = 0;
+    };
+
+    static_assert(sizeof(CullParams) == 256);
+
+    struct DrawArgs {
+        u32 index_count;
+        u32 instance_count;
+        u32 first_index;
+        i32 base_vertex;
+        u32 first_instance;
+    };
+
+    struct Slot {
+        const Mesh* mesh = nullptr; // valid between add() and cull() only
+        glm::mat4 transform{ 1.0f };
+
+        wgpu::Buffer output;
+        u64 output_capacity = 0; // indices
+        wgpu::Buffer indirect;
+        UniformBuffer params;
+
+        wgpu::BindGroup bind_group;
+        u64 bound_mesh_revision = 0;
+    };
+
+    WebGPUContext& m_context;
+    scope<ComputePipeline> m_pipeline;
+    u64 m_max_binding_size = 0;
+
+    std::vector<Slot> m_slots;
+    u32 m_active = 0;
+};
+
+} // namespace terra
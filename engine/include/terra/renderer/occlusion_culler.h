@@ -0,0 +1,127 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/renderer/buffer.h"
+#include "terra/renderer/compute_pipeline.h"
+#include "terra/renderer/frustum.h"
+#include "terra/renderer/hierarchical_z.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <span>
+
+namespace terra {
+
+class WebGPUContext;
+
+// Two-phase GPU occlusion culling of instanced draws against a
+// hierarchical depth buffer (Haar & Aaltonen, GPU Pro 7). Each draw added
+// during a scene gets a slot; a compute pass compacts the instance records
+// that survive into a per-phase instance buffer and writes the survivor
+// count into DrawIndexedIndirect arguments.
+//
+//  - Early: instances are tested against the frustum and against the HZB
+//    built last frame, projected with last frame's camera. Survivors are
+//    drawn in the scene pass; the in-frustum rest are flagged.
+//  - Late: after the scene pass, the HZB is rebuilt from this frame's
+//    depth and the flagged instances are tested again. Those that turn out
+//    visible (disoccluded this frame) are drawn in a second pass.
+//
+// Nothing is lost to a stale HZB: an instance is only skipped when the
+// current frame's depth hides it too.
+class OcclusionCuller {
+public:
+    enum class Phase : u32 { Early = 0, Late = 1 };
+
+    explicit OcclusionCuller(WebGPUContext& context);
+
+    // `instances` holds `instance_count` records of `stride` bytes (a multiple
+    // of 4) and needs Storage usage; `bounds` are world-space spheres
+    // (xyz centre, w radius), one per instance.
+    u32 add(wgpu::Buffer instances, u32 instance_count, u32 stride, std::span<const glm::vec4> bounds,
+        u32 index_count, u32 first_index, i32 base_vertex);
+
+    // Encodes the early phase for every slot added since the last frame.
+    // `encoder` must be submitted before the scene pass that draws the slots.
+    void cull_early(wgpu::CommandEncoder encoder, const Frustum& frustum);
+
+    // Encodes the HZB rebuild from the depth source and the late phase.
+    // `view` and `projection` are this frame's, kept for next frame's early test.
+    void cull_late(wgpu::CommandEncoder encoder, const glm::mat4& view, const glm::mat4& projection);
+
+    // Ends the frame's use of the slots.
+    void reset() { m_active = 0; }
+
+    // The depth buffer the HZB is built from, holding the image in its
+    // top-left `width` x `height` texels; call again when either changes.
+    void set_depth_source(wgpu::TextureView depth, u32 width, u32 height);
+
+    bool has_pending() const { return m_active > 0; }
+    u32 get_slot_count() const { return m_active; }
+
+    const wgpu::Buffer& get_instance_buffer(u32 slot, Phase phase) const { return m_slots[slot].phases[(u32) phase].instances; }
+    const wgpu::Buffer& get_indirect_buffer(u32 slot, Phase phase) const { return m_slots[slot].phases[(u32) phase].indirect; }
+    // Written by the early phase, read by the late one.
+    const wgpu::Buffer& get_flag_buffer(u32 slot) const { return m_slots[slot].flags; }
+
+private:
+    // Matches CullParams in instance_cull.wgsl.
+    struct alignas(16) CullParams {
+        glm::mat4 view;       // camera the HZB was built with
+        glm::mat4 projection;
+        glm::vec4 planes[6];
+        glm::vec2 hzb_size{ 0.0f };
+        u32 hzb_mip_count = 0;
+        u32 use_hzb = 0;
+        u32 instance_count = 0;
+        u32 instance_words = 0;
+        u32 phase = 0;
+        u32 padding = 0;
+    };
+
+    static_assert(sizeof(CullParams) == 256);
+
+    struct DrawArgs {
+        u32 index_count;
+        u32 instance_count;
+        u32 first_index;
+        i32 base_vertex;
+        u32 first_instance;
+    };
+
+    struct PhaseResources {
+        wgpu::Buffer instances; // compacted survivors
+        wgpu::Buffer indirect;
+        UniformBuffer params;
+    };
+
+    struct Slot {
+        wgpu::Buffer source;
+        u32 instance_count = 0;
+        u32 stride = 0;
+        DrawArgs args{};
+
+        wgpu::Buffer bounds;
+        wgpu::Buffer flags;   // per instance: in the frustum but failed the early HZB test
+        u64 capacity = 0;     // instances
+        u64 instance_capacity = 0; // bytes per phase instance buffer
+
+        std::array<PhaseResources, 2> phases;
+    };
+
+    void dispatch(Phase phase, const CullParams& shared, wgpu::CommandEncoder encoder);
+
+    WebGPUContext& m_context;
+    scope<ComputePipeline> m_pipeline;
+    scope<HierarchicalZ> m_hzb;
+
+    // Camera the current HZB contents were rendered with.
+    glm::mat4 m_hzb_view{ 1.0f };
+    glm::mat4 m_hzb_projection{ 1.0f };
+
+    std::vector<Slot> m_slots;
+    u32 m_active = 0;
+};
+
+} // namespace terra
@@ -14,6 +14,12 @@ public:
     ~Pipeline();
 
     void bind(wgpu::RenderPassEncoder encoder) const;
+    void bind(wgpu::RenderBundleEncoder encoder) const;
+
+    // The depth prepass variant; only valid when has_depth_prepass().
+    void bind_depth(wgpu::RenderPassEncoder encoder) const;
+    void bind_depth(wgpu::RenderBundleEncoder encoder) const;
+    bool has_depth_prepass() const { return (bool) m_depth_pipeline; }
 
     wgpu::BindGroupLayout get_bind_group_layout(u32 index = 0) const {
         TR_CORE_ASSERT(index < m_bind_group_layouts.size(), "Invalid bind group layout index");
@@ -21,6 +27,7 @@ public:
     }
 
     PipelineSpecification get_specification() { return m_spec; }
+    bool uses_mesh_decode() const { return m_spec.mesh_decode; }
 
 private:
     void create_pipeline(const PipelineSpecification& spec);
@@ -30,6 +37,7 @@ private:
     WebGPUContext& m_context;
 
     wgpu::RenderPipeline m_pipeline;
+    wgpu::RenderPipeline m_depth_pipeline;
     wgpu::PipelineLayout m_layout;
     std::vector<wgpu::BindGroupLayout> m_bind_group_layouts;
 
@@ -38,9 +38,24 @@ struct PipelineSpecification {
     std::vector<UniformBufferSpec> uniforms;
     std::vector<StorageBufferSpec> storages;    // ← new
 
+    // Adds the per-mesh MeshDecodeParams uniform at MESH_DECODE_GROUP; the
+    // renderer binds each mesh's decode group before drawing it.
+    bool mesh_decode = false;
+
+    // Meshes are wound counter-clockwise; Back skips faces turned away.
+    wgpu::CullMode cull_mode = wgpu::CullMode::None;
+
+    // Also builds a depth-only variant (no fragment stage) that the renderer
+    // draws in a prepass. The main pipeline then tests Equal without writing
+    // depth, so each visible pixel is shaded once. The variant runs
+    // `depth_vertex_entry`, or the shader's vertex entry when empty; either
+    // way its position must be @invariant and computed like the main one.
+    bool depth_prepass = false;
+    std::string depth_vertex_entry;
 
     wgpu::TextureView depth_view;
     wgpu::TextureFormat depth_format;
+    wgpu::BindGroupLayout mesh_decode_layout; // filled in by the renderer from its GeometryArena
     
 
 };
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/renderer/render_pass.h"
+#include "terra/renderer/render_target_pool.h"
+
+#include <functional>
+
+namespace terra {
+
+class WebGPUContext;
+class RenderGraph;
+
+// Handles into the graph being built; they are invalidated by reset().
+struct RenderGraphTexture {
+    static constexpr u32 INVALID = ~0u;
+    u32 index = INVALID;
+    bool is_valid() const { return index != INVALID; }
+};
+
+struct RenderGraphBuffer {
+    static constexpr u32 INVALID = ~0u;
+    u32 index = INVALID;
+    bool is_valid() const { return index != INVALID; }
+};
+
+// For transients, `usage` is added to the usages the passes declare, e.g.
+// CopySrc for readbacks.
+using RenderGraphTextureDesc = RenderTargetDesc;
+
+// Handed to a pass's setup function to declare what it touches. Attachments
+// make it a render pass; passes without any are given a command encoder.
+class RenderGraphBuilder {
+public:
+    // A texture that only lives inside the graph. Its memory may be shared
+    // with other transients whose lifetimes do not overlap, so the first
+    // pass to use it must clear it or overwrite every texel.
+    RenderGraphTexture create_texture(std::string_view name, const RenderGraphTextureDesc& desc);
+
+    // Loading the previous contents counts as a read.
+    void write_color(RenderGraphTexture texture, wgpu::LoadOp load_op = wgpu::LoadOp::Clear, wgpu::Color clear_color = { 0.0, 0.0, 0.0, 1.0 });
+    void write_depth(RenderGraphTexture texture, wgpu::LoadOp load_op = wgpu::LoadOp::Clear, f32 clear_depth = 1.0f);
+    // Depth attachment that is tested against but not written.
+    void read_depth(RenderGraphTexture texture);
+
+    // Sampled or storage access from shaders, or copies.
+    void read(RenderGraphTexture texture, wgpu::TextureUsage usage = wgpu::TextureUsage::TextureBinding);
+    void write(RenderGraphTexture texture, wgpu::TextureUsage usage = wgpu::TextureUsage::StorageBinding);
+    void read(RenderGraphBuffer buffer);
+    void write(RenderGraphBuffer buffer);
+
+    // Keeps the pass even when nothing reads what it writes, for work whose
+    // results leave the graph some other way (culling, readbacks).
+    void set_side_effect();
+
+private:
+    friend class RenderGraph;
+    RenderGraphBuilder(RenderGraph& graph, u32 pass) : m_graph(graph), m_pass(pass) {}
+
+    RenderGraph& m_graph;
+    u32 m_pass;
+};
+
+// What a pass's execute function records into, and where its resources are.
+class RenderGraphContext {
+public:
+    // Null for passes without attachments.
+    wgpu::RenderPassEncoder get_render_pass() const { return m_render_pass; }
+    // Null for render passes.
+    wgpu::CommandEncoder get_command_encoder() const { return m_encoder; }
+
+    wgpu::Texture get_texture(RenderGraphTexture texture) const;
+    wgpu::TextureView get_texture_view(RenderGraphTexture texture) const;
+    wgpu::Buffer get_buffer(RenderGraphBuffer buffer) const;
+
+private:
+    friend class RenderGraph;
+    explicit RenderGraphContext(const RenderGraph& graph) : m_graph(graph) {}
+
+    const RenderGraph& m_graph;
+    wgpu::RenderPassEncoder m_render_pass = nullptr;
+    wgpu::CommandEncoder m_encoder = nullptr;
+};
+
+// Frame graph. Each frame, passes are added with the resources they read
+// and write, then compile() works out from those declarations:
+//
+//  - the order: every pass runs after the passes whose writes it reads and
+//    after earlier users of whatever it writes, otherwise in the order added;
+//  - which passes to drop: those whose writes are never read, unless they
+//    write an imported resource or have a side effect;
+//  - where transient textures live: ones with the same description and
+//    disjoint lifetimes share one texture from a RenderTargetPool.
+//
+// execute() then runs the passes in that order, each in its own command
+// buffer on the context's queue.
+class RenderGraph {
+public:
+    using SetupFn = std::function<void(RenderGraphBuilder&)>;
+    using ExecuteFn = std::function<void(const RenderGraphContext&)>;
+
+    RenderGraph(WebGPUContext& context, RenderTargetPool& targets);
+    ~RenderGraph();
+
+    // Resources owned outside the graph; whatever writes them is kept.
+    RenderGraphTexture import_texture(std::string_view name, wgpu::TextureView view, const RenderGraphTextureDesc& desc = {}, wgpu::Texture texture = nullptr);
+    RenderGraphBuffer import_buffer(std::string_view name, wgpu::Buffer buffer);
+
+    // `setup` runs at once; `execute` runs from execute() if the pass survives.
+    void add_pass(std::string_view name, const SetupFn& setup, ExecuteFn execute);
+
+    const RenderGraphTextureDesc& get_desc(RenderGraphTexture texture) const;
+
+    void compile();
+    void execute();
+
+    // Drops this frame's passes and resources. The textures that backed
+    // transients stay acquired from the pool until its end_frame().
+    void reset();
+
+    struct Stats {
+        u32 passes = 0;
+        u32 passes_culled = 0;
+        u32 transient_textures = 0; // used by the passes that run
+        u32 physical_textures = 0;  // pooled textures backing them
+    };
+    const Stats& get_stats() const { return m_stats; }
+
+private:
+    friend class RenderGraphBuilder;
+    friend class RenderGraphContext;
+
+    static constexpr u32 NONE = ~0u;
+
+    struct Resource {
+        std::string name;
+        bool texture = true;
+        bool imported = false;
+        RenderGraphTextureDesc desc;
+        wgpu::TextureUsage usage = wgpu::TextureUsage::None; // declared by the passes
+
+        wgpu::Texture native_texture;
+        wgpu::TextureView view;
+        wgpu::Buffer buffer;
+
+        u32 first_use = NONE; // execution order positions
+        u32 last_use = NONE;
+    };
+
+    struct Attachment {
+        u32 resource = NONE;
+        wgpu::LoadOp load_op = wgpu::LoadOp::Clear;
+        wgpu::Color clear_color = { 0.0, 0.0, 0.0, 1.0 };
+        f32 clear_depth = 1.0f;
+        bool read_only = false;
+    };
+
+    struct Pass {
+        std::string name;
+        ExecuteFn execute;
+
+        std::vector<u32> reads;
+        std::vector<u32> writes;
+        std::vector<Attachment> color_attachments;
+        Attachment depth_attachment;
+        bool side_effect = false;
+
+        std::vector<u32> producers;    // passes whose writes this one reads
+        std::vector<u32> dependencies; // producers plus earlier users of what it writes
+        bool culled = false;
+
+        scope<RenderPass> render_pass; // for passes with attachments, once compiled
+    };
+
+    Resource& get_texture_resource(RenderGraphTexture texture);
+    Resource& get_buffer_resource(RenderGraphBuffer buffer);
+
+    void build_dependencies();
+    void cull_passes();
+    void sort_passes();
+    void allocate_transients();
+    void create_render_passes();
+
+    WebGPUContext& m_context;
+    RenderTargetPool& m_targets;
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<u32> m_order; // surviving passes, in execution order
+    bool m_compiled = false;
+
+    Stats m_stats;
+};
+
+} // namespace terra
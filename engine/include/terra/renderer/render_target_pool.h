@@ -0,0 +1,69 @@
+#pragma once
+
+#include "terrapch.h"
+
+namespace terra {
+
+class WebGPUContext;
+
+struct RenderTargetDesc {
+    u32 width = 0;
+    u32 height = 0;
+    wgpu::TextureFormat format = wgpu::TextureFormat::Undefined;
+    wgpu::TextureUsage usage = wgpu::TextureUsage::None;
+    u32 sample_count = 1;
+    u32 mip_level_count = 1;
+
+    bool operator==(const RenderTargetDesc&) const = default;
+};
+
+struct RenderTarget {
+    wgpu::Texture texture;
+    wgpu::TextureView view; // all levels
+    RenderTargetDesc desc;
+};
+
+// Textures for render targets, keyed by their description and reused from
+// frame to frame. A texture handed out by acquire() is the caller's until
+// the next end_frame(); textures nobody has acquired for RETIRE_FRAMES
+// frames are released.
+class RenderTargetPool {
+public:
+    static constexpr u64 RETIRE_FRAMES = 60;
+
+    explicit RenderTargetPool(WebGPUContext& context);
+    ~RenderTargetPool();
+
+    // A texture matching `desc` not yet acquired this frame; created only
+    // when every pooled one with that description is taken. Callers that
+    // acquire in the same order every frame get the same textures back.
+    RenderTarget acquire(const RenderTargetDesc& desc, std::string_view label = "Pooled Render Target");
+
+    void end_frame();
+
+    struct Stats {
+        u32 textures = 0; // in the pool
+        u32 created = 0;  // since the last end_frame()
+    };
+    const Stats& get_stats() const { return m_stats; }
+
+private:
+    struct DescHash {
+        size_t operator()(const RenderTargetDesc& desc) const;
+    };
+
+    struct Entry {
+        RenderTarget target;
+        u64 last_used_frame = 0;
+        bool in_use = false;
+    };
+
+    WebGPUContext& m_context;
+
+    std::unordered_map<RenderTargetDesc, std::vector<Entry>, DescHash> m_entries;
+    u64 m_frame_index = 0;
+
+    Stats m_stats;
+};
+
+} // namespace terra
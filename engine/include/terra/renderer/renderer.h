@@ -7,27 +7,87 @@
 #include "terra/renderer/material_instance.h"
 #include "terra/renderer/camera.h"
 #include "terra/renderer/mesh.h"
-#include "terra/renderer/render_pass.h"
+#include "terra/renderer/geometry_arena.h"
+#include "terra/renderer/frustum.h"
+#include "terra/renderer/static_batch.h"
+#include "terra/renderer/meshlet_culler.h"
+#include "terra/renderer/occlusion_culler.h"
+#include "terra/renderer/render_graph.h"
+#include "terra/resources/asset_handle.h"
+
+#include <array>
+#include <cfloat>
 
 namespace terra {
 
 class WebGPUContext;
 class CommandQueue;
+class Blitter;
 
 struct RendererStats {
     u32 draw_calls = 0;
     u32 mesh_count = 0;
     u32 vertex_count = 0;
     u32 index_count = 0;
+    u32 buffer_binds = 0; // vertex and index buffer binds
+
+    u32 static_chunks_drawn = 0;
+    u32 static_chunks_culled = 0;
+
+    u32 bundles_executed = 0;
+    u32 bundles_recorded = 0;
+
+    u32 cluster_draws = 0;   // draws culled per meshlet on the GPU
+    u32 meshlets_tested = 0;
+
+    u32 occlusion_draws = 0; // instanced draws culled against the HZB
+
+    u32 depth_prepass_draws = 0;
+
+    u32 batches = 0;   // instanced draw batches submitted this frame
+    u32 instances = 0;
+
+    // Resource traffic during the previous frame, see GpuCounters.
+    u64 bytes_uploaded = 0;
+    u32 buffers_created = 0;
+    u32 bind_groups_created = 0;
+    u32 pipelines_bound = 0;
+
+    u32 render_graph_passes = 0;
+    u32 render_graph_culled = 0;
+    u32 render_graph_textures = 0; // pooled textures backing transients
+    u32 render_targets = 0;         // in the render target pool
+    u32 render_targets_created = 0;
+
+    // Instances drawn at each level of detail.
+    std::array<u32, MAX_MESH_LODS> lod_instances{};
 
     f32 frame_time_ms = 0.0f;
     f32 fps = 0.0f;
+    f32 gpu_time_ms = 0.0f; // timed passes of the latest frame read back, 0 without timestamps
 
     void reset() {
         draw_calls = 0;
         mesh_count = 0;
         vertex_count = 0;
         index_count = 0;
+        buffer_binds = 0;
+        static_chunks_drawn = 0;
+        static_chunks_culled = 0;
+        bundles_executed = 0;
+        bundles_recorded = 0;
+        cluster_draws = 0;
+        meshlets_tested = 0;
+        occlusion_draws = 0;
+        depth_prepass_draws = 0;
+        batches = 0;
+        instances = 0;
+        render_graph_passes = 0;
+        render_graph_culled = 0;
+        render_graph_textures = 0;
+        render_targets = 0;
+        render_targets_created = 0;
+        lod_instances.fill(0);
     }
 };
 
@@ -45,15 +105,62 @@ public:
     void begin_scene(const Camera& camera);
     void end_scene();
 
+    // Always draws LOD 0.
     void submit(
-        const ref<Mesh>& mesh,
-        const ref<MaterialInstance>& material,
+        MeshHandle mesh,
+        MaterialHandle material,
         const void* instance,
         u32 size,
         u32 binding,
         u32 group
     );
 
+    // Picks the level of detail from the instance's world transform: the
+    // coarsest LOD whose simplification error projects to at most
+    // `get_lod_threshold()` pixels on screen. At LOD 0, meshes with meshlets
+    // are drawn on their own with per-cluster GPU culling. Other instances
+    // are occlusion culled on the GPU when enabled.
+    void submit(
+        MeshHandle mesh,
+        MaterialHandle material,
+        const glm::mat4& transform,
+        const void* instance,
+        u32 size,
+        u32 binding,
+        u32 group
+    );
+
+    // Opaque draws are sorted front to back by view depth at end_scene. When
+    // any of them uses a pipeline with a depth prepass (see
+    // PipelineSpecification::depth_prepass), those are first drawn depth-only
+    // in a pass of their own, and the scene pass then loads that depth.
+
+    // Draws the chunks of `batch` that intersect the view frustum, with the
+    // batch's persistent instance buffer; nothing is uploaded per frame.
+    // With render bundles on, each chunk is recorded once and replayed; the
+    // recording is redone when its mesh, material or the batch's instance
+    // buffer changes, or when the target formats do.
+    void submit(const StaticBatch& batch);
+
+    void set_render_bundles_enabled(bool enabled) { m_render_bundles_enabled = enabled; }
+    bool get_render_bundles_enabled() const { return m_render_bundles_enabled; }
+
+    // Cone culling assumes single-sided geometry; turn it off for meshes
+    // meant to be seen from both sides.
+    void set_cluster_culling_enabled(bool enabled) { m_cluster_culling_enabled = enabled; }
+    void set_cluster_cone_culling_enabled(bool enabled) { m_cluster_cone_culling = enabled; }
+    bool get_cluster_culling_enabled() const { return m_cluster_culling_enabled; }
+
+    // Two-phase HZB occlusion culling of instances submitted with a
+    // transform, under a perspective camera. Culled instances that become
+    // visible are drawn in a second scene pass.
+    void set_occlusion_culling_enabled(bool enabled) { m_occlusion_culling_enabled = enabled; }
+    bool get_occlusion_culling_enabled() const { return m_occlusion_culling_enabled; }
+
+    // Screen-space error, in pixels, tolerated when choosing a LOD. 0 pins every mesh to LOD 0.
+    void set_lod_threshold(f32 pixels) { m_lod_threshold = pixels; }
+    f32 get_lod_threshold() const { return m_lod_threshold; }
+
     void begin_ui_pass();
     void end_ui_pass();
 
@@ -66,11 +173,37 @@ public:
     // high‐level draws
     void clear_color(f32 r, f32 g, f32 b, f32 a);
 
+    // Scene targets come from a pool keyed by their description. While
+    // resizes keep arriving, the scene is drawn into targets that only grow,
+    // in RESIZE_GRANULARITY steps, and is blitted to the surface; once none
+    // has come for RESIZE_SETTLE_FRAMES, exact-size targets take over and
+    // the oversized ones are retired by the pool.
     void on_resize(u32 width, u32 height);
 
-    // RenderPass management
-    // RenderPass* create_render_pass(const RenderPassDesc& desc);
-    // const std::vector<std::unique_ptr<RenderPass>>& get_render_passes() const { return m_render_passes; }
+    static constexpr u32 RESIZE_GRANULARITY = 256;
+    static constexpr u64 RESIZE_SETTLE_FRAMES = 20;
+
+    // The scene is drawn through a RenderGraph rebuilt at every end_scene.
+    // Callbacks run after the scene passes are declared, each frame, and may
+    // add passes that read or write the scene targets, or transient
+    // textures of their own (post-processing, shadow maps read by a later
+    // pass, ...). Passes whose output nothing uses are dropped.
+    //
+    // The scene image is `width` x `height`, in the top-left of both
+    // targets. While the window is being resized they can be larger than
+    // that, and `color` is then an offscreen target copied to the surface
+    // after the callbacks' passes; draws into them have to set the viewport.
+    struct SceneTargets {
+        RenderGraphTexture color;
+        RenderGraphTexture depth;
+        u32 width = 0;
+        u32 height = 0;
+    };
+    using RenderGraphCallback = std::function<void(RenderGraph&, const SceneTargets&)>;
+    void add_render_graph_callback(RenderGraphCallback callback) { m_render_graph_callbacks.push_back(std::move(callback)); }
+
+    // Shared vertex/index storage every Mesh is suballocated from.
+    const ref<GeometryArena>& get_geometry_arena() const { return m_geometry_arena; }
 
     u64 create_pipeline(const PipelineSpecification& spec);
     ref<Pipeline> get_pipeline(u64 id) const;
@@ -84,12 +217,37 @@ public:
 private:
     struct SceneData {
         const Camera* camera;
+
+        glm::vec3 camera_position{ 0.0f };
+        // Pixels covered by one world unit at distance 1 (perspective) or at
+        // any distance (orthographic).
+        f32 pixels_per_unit = 1.0f;
+        bool perspective = true;
+
+        glm::vec3 view_direction{ 0.0f, 0.0f, -1.0f };
+
+        Frustum frustum;
     };
     scope<SceneData> m_scene_data;
 
+    u32 select_lod(const Mesh& mesh, const glm::mat4& transform) const;
+    void add_to_batch(MeshHandle mesh, u32 lod, MaterialHandle material, const void* instance, u32 size, u32 binding, u32 group, const glm::vec4* bounds = nullptr);
+    f32 get_view_depth(const glm::vec3& center, f32 radius) const; // of the nearest point of a sphere
+
+    // Scene passes: colour and depth, or depth only for the prepass.
+    // `culled` are the culler buffers the pass draws from.
+    void add_scene_pass(std::string_view name, const SceneTargets& targets, bool clear_color, bool clear_depth, bool depth_only, bool late,
+        std::span<const RenderGraphBuffer> culled);
+    bool uses_depth_prepass() const;
+    void acquire_scene_targets();
+    void execute_bundles(bool depth_only);
+    // `late` draws only the occlusion culler's late-phase survivors.
+    void draw_batches(bool depth_only, bool late);
+
     struct DrawBatch {
-        ref<Mesh> mesh;
-        ref<MaterialInstance> material;
+        MeshHandle mesh;
+        u32 lod = 0;
+        MaterialHandle material;
 
         std::vector<u8> instance_data;  // raw blob
         u32 instance_stride = 0;
@@ -99,21 +257,89 @@ private:
 
         wgpu::Buffer instance_buffer;
         u64       buffer_capacity = 0;
+        bool      persistent = false; // instance_buffer is owned elsewhere and already filled
+
+        static constexpr u32 NO_CLUSTER = ~0u;
+        u32 cluster_slot = NO_CLUSTER; // MeshletCuller slot; drawn indirect from its output
+
+        std::vector<glm::vec4> instance_bounds; // world-space sphere per instance, when every instance has one
+        static constexpr u32 NO_SLOT = ~0u;
+        u32 occlusion_slot = NO_SLOT;   // OcclusionCuller slot; drawn indirect from its survivors
+
+        f32 view_depth = FLT_MAX; // nearest instance, for front-to-back sorting; unknown sorts last
     };
 
     std::vector<DrawBatch> m_draw_batches;
 
+    struct ChunkBundle {
+        wgpu::RenderBundle bundle;
+        wgpu::RenderBundle depth_bundle; // for pipelines with a depth prepass
+        u64 mesh_revision = 0;
+        u64 material_revision = 0;
+    };
+
+    struct BatchBundles {
+        u64 revision = 0; // StaticBatch revision the chunks were recorded against
+        u64 last_used_frame = 0;
+        std::vector<ChunkBundle> chunks; // parallel to StaticBatch::get_chunks()
+    };
+
+    // Frames a batch may go unsubmitted before its bundles are released.
+    static constexpr u64 BUNDLE_RETIRE_FRAMES = 120;
+
+    wgpu::RenderBundle record_bundle(const StaticBatch& batch, Mesh& mesh, MaterialInstance& material, bool depth_only) const;
+
+    struct SceneBundle {
+        wgpu::RenderBundle bundle;
+        wgpu::RenderBundle depth_bundle;
+        f32 view_depth = 0.0f;
+    };
+
+    // Created on first use, once the engine's shaders can be loaded.
+    scope<MeshletCuller> m_meshlet_culler;
+    bool m_cluster_culling_enabled = true;
+    bool m_cluster_cone_culling = true;
+
+    scope<OcclusionCuller> m_occlusion_culler;
+    bool m_occlusion_culling_enabled = true;
+
+    bool m_render_bundles_enabled = true;
+    std::unordered_map<u64, BatchBundles> m_bundle_cache; // by StaticBatch id
+    std::vector<SceneBundle> m_scene_bundles;             // replayed at the start of each scene pass
+    std::vector<wgpu::RenderBundle> m_execute_scratch;
+    wgpu::TextureFormat m_bundle_color_format = wgpu::TextureFormat::Undefined;
+    u64 m_frame_index = 0;
+
+    ref<GeometryArena> m_geometry_arena;
+
     WebGPUContext&   m_context;
     CommandQueue&    m_queue;
 
     wgpu::TextureView    m_target_texture_view{};
 
+    u32                  m_viewport_height = 1;
+    f32                  m_lod_threshold = 1.0f;
+
+    u32                  m_surface_width = 0;
+    u32                  m_surface_height = 0;
+    u32                  m_target_width = 0;   // of the scene targets; at least the surface size
+    u32                  m_target_height = 0;
+    bool                 m_resizing = false;
+    u64                  m_last_resize_frame = 0;
+    u64                  m_targets_frame = ~0ull; // frame the targets were acquired for
+
+    wgpu::TextureView    m_scene_color_view{}; // null when the scene is drawn to the surface
     wgpu::TextureView    m_depth_texture_view{};
+    bool                 m_depth_source_dirty = true; // occlusion culler needs the new depth view or size
     wgpu::TextureFormat  m_depth_texture_format = wgpu::TextureFormat::Depth24Plus;
 
     wgpu::RenderPassEncoder m_current_pass = nullptr;
+    bool m_scene_active = false; // between begin_scene and end_scene
 
-    // std::vector<scope<RenderPass>> m_render_passes;
+    scope<RenderTargetPool> m_render_targets;
+    scope<RenderGraph> m_render_graph;
+    scope<Blitter> m_blitter; // scene colour to the surface, when drawn offscreen
+    std::vector<RenderGraphCallback> m_render_graph_callbacks;
 
     RendererStats m_stats;
 
@@ -7,6 +7,7 @@
 #include "terra/renderer/shader.h"
 #include "terra/renderer/material.h"
 #include "terra/renderer/material_instance.h"
+#include "terra/resources/asset_registry.h"
 #include <glm/glm.hpp>
 
 namespace terra {
@@ -38,7 +39,7 @@ public:
     static void end_scene();
 
     template<typename T>
-    static void submit(const ref<Mesh>& mesh, const ref<MaterialInstance>& material, const T& instance, u32 binding, u32 group) {
+    static void submit(MeshHandle mesh, MaterialHandle material, const T& instance, u32 binding, u32 group) {
 
         // auto const& sp = material->get_storage_param(name);
 
@@ -46,8 +47,26 @@ public:
     
         s_renderer->submit(mesh, material, &instance, sizeof(T), binding, group);
     }
+
+    // As above, with the LOD chosen from the instance's world transform.
+    template<typename T>
+    static void submit(MeshHandle mesh, MaterialHandle material, const glm::mat4& transform, const T& instance, u32 binding, u32 group) {
+        static_assert(std::is_trivially_copyable_v<T>, "Instance type must be POD");
+
+        s_renderer->submit(mesh, material, transform, &instance, sizeof(T), binding, group);
+    }
+
+    static void submit(const StaticBatch& batch);
+
+    static void set_lod_threshold(f32 pixels);
+    static void set_render_bundles_enabled(bool enabled);
+    static void set_cluster_culling_enabled(bool enabled);
+    static void set_occlusion_culling_enabled(bool enabled);
+
+    static void add_render_graph_callback(Renderer::RenderGraphCallback callback);
     
     static WebGPUContext& get_context();
+    static const ref<GeometryArena>& get_geometry_arena();
     static wgpu::RenderPassEncoder get_current_pass_encoder();
 
     static const RendererStats& get_stats();
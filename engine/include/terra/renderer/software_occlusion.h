@@ -0,0 +1,97 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/renderer/frustum.h"
+#include "terra/resources/mesh_format.h"
+
+#include <glm/glm.hpp>
+
+#include <span>
+
+namespace terra {
+
+class ThreadPool;
+
+// CPU occlusion culling against a small set of designated occluders, for
+// callers that cannot wait on GPU results. Occluder triangles are projected
+// into a low-resolution buffer holding the nearest 1/w per pixel; bounding
+// boxes are then tested against it before they are ever submitted, so
+// hidden instances cost neither an upload nor a draw.
+//
+// Triangles are binned into screen tiles and the tiles rasterized in
+// parallel on a ThreadPool, with SIMD across each pixel row (AVX2 when the
+// build enables it, else SSE2 or NEON, else scalar).
+//
+// Per frame: begin(), add_occluder() for each occluder, rasterize(), then
+// any number of is_visible() queries, which are safe to run concurrently.
+class SoftwareOcclusion {
+public:
+    static constexpr u32 TILE_WIDTH  = 64;
+    static constexpr u32 TILE_HEIGHT = 16;
+
+    // Sizes are rounded up to whole tiles. Works on ThreadPool::get() when
+    // no pool is given.
+    explicit SoftwareOcclusion(u32 width = 256, u32 height = 128, ThreadPool* pool = nullptr);
+
+    // Clears the buffer and the occluder list.
+    void begin(const glm::mat4& view_projection);
+
+    // Positions are the first three floats of each vertex. Triangles are
+    // treated as double-sided; only the near plane clips them.
+    void add_occluder(const f32* vertices, u32 vertex_stride, std::span<const u32> indices, const glm::mat4& transform);
+    // One level of a mesh; coarse LODs are cheaper but may poke out of the
+    // original silhouette, hiding things that should show.
+    void add_occluder(const MeshData& mesh, const glm::mat4& transform, u32 lod = 0);
+
+    // Bins the occluders and fills the buffer.
+    void rasterize();
+
+    // Conservative: false only when every pixel the box covers on screen
+    // holds an occluder nearer than the box's nearest corner. Boxes crossing
+    // the near plane are always visible; boxes off screen never are.
+    bool is_visible(const BoundingBox& world_bounds) const;
+    bool is_visible(const BoundingBox& local_bounds, const glm::mat4& transform) const;
+
+    u32 get_width() const { return m_width; }
+    u32 get_height() const { return m_height; }
+    // Row-major 1/w per pixel, 0 where nothing was drawn; top row first.
+    const std::vector<f32>& get_depth() const { return m_depth; }
+
+    struct Stats {
+        u32 occluder_triangles = 0; // after near-plane clipping and off-screen rejection
+        u32 binned_triangles = 0;   // triangle-tile pairs rasterized
+    };
+    const Stats& get_stats() const { return m_stats; }
+
+private:
+    // Edge functions and the 1/w plane, all evaluated at pixel centres:
+    // inside where every edge is >= 0.
+    struct Triangle {
+        glm::vec3 edges[3]; // a * x + b * y + c
+        glm::vec3 inv_w;    // plane coefficients, same form
+        i32 min_x, min_y, max_x, max_y; // inclusive pixel bounds
+    };
+
+    void add_clipped(const glm::vec4* clip, u32 count);
+    void add_screen_triangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+    void rasterize_tile(u32 tile);
+    bool test_box(const BoundingBox& bounds, const glm::mat4& to_clip) const;
+
+    ThreadPool& m_pool;
+
+    u32 m_width = 0;
+    u32 m_height = 0;
+    u32 m_tiles_x = 0;
+    u32 m_tiles_y = 0;
+
+    glm::mat4 m_view_projection{ 1.0f };
+    std::vector<f32> m_depth;
+    std::vector<Triangle> m_triangles;
+    std::vector<glm::vec4> m_clip_vertices; // scratch for add_occluder
+    std::vector<std::vector<u32>> m_bins; // triangle indices per tile
+    bool m_rasterized = false;
+
+    Stats m_stats;
+};
+
+} // namespace terra
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/renderer/frustum.h"
+#include "terra/resources/asset_handle.h"
+#include "terra/resources/static_batch_builder.h"
+
+namespace terra {
+
+// GPU side of a StaticBatchBuilder result: each chunk uploaded as a mesh in
+// the AssetRegistry, plus one persistent instance storage buffer shared by
+// every chunk (normally an identity transform and white colour). The
+// renderer records each chunk's draw into a render bundle once and replays
+// it while get_revision() is unchanged.
+class StaticBatch {
+public:
+    struct Chunk {
+        MeshHandle mesh;
+        MaterialHandle material;
+        BoundingBox bounds;
+    };
+
+    StaticBatch(const std::vector<StaticChunk>& chunks, const void* instance, u32 instance_size, u32 binding, u32 group);
+    ~StaticBatch();
+
+    StaticBatch(const StaticBatch&) = delete;
+    StaticBatch& operator=(const StaticBatch&) = delete;
+
+    template<typename T>
+    static scope<StaticBatch> create(const std::vector<StaticChunk>& chunks, const T& instance, u32 binding, u32 group) {
+        static_assert(std::is_trivially_copyable_v<T>, "Instance type must be POD");
+        return create_scope<StaticBatch>(chunks, &instance, (u32) sizeof(T), binding, group);
+    }
+
+    // Same size rewrites the buffer in place; a new size replaces the buffer
+    // and the revision, so recorded bundles are dropped.
+    void set_instance(const void* instance, u32 instance_size);
+
+    template<typename T>
+    void set_instance(const T& instance) {
+        static_assert(std::is_trivially_copyable_v<T>, "Instance type must be POD");
+        set_instance(&instance, (u32) sizeof(T));
+    }
+
+    const std::vector<Chunk>& get_chunks() const { return m_chunks; }
+
+    // Stable for the batch's lifetime; keys the renderer's bundle cache.
+    u64 get_id() const { return m_id; }
+    u64 get_revision() const { return m_revision; }
+
+    wgpu::Buffer get_instance_buffer() const { return m_instance_buffer; }
+    u32 get_instance_size() const { return m_instance_size; }
+    u32 get_binding() const { return m_binding; }
+    u32 get_group() const { return m_group; }
+
+private:
+    std::vector<Chunk> m_chunks;
+
+    wgpu::Buffer m_instance_buffer;
+    u32 m_instance_size = 0;
+    u32 m_binding = 0;
+    u32 m_group = 1;
+
+    u64 m_id = 0;
+    u64 m_revision = 0;
+};
+
+} // namespace terra
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "terra/core/base.h"
+
+#include <functional>
+
+namespace terra {
+
+class Mesh;
+class MaterialInstance;
+
+// 32-bit generational handle into an AssetPool slot.
+// Low bits are the slot index, high bits the slot generation. A handle whose
+// generation no longer matches its slot refers to an unloaded asset and
+// resolves to nullptr. The zero value is never handed out and means "none".
+template<typename T>
+struct AssetHandle {
+    static constexpr u32 INDEX_BITS      = 20;
+    static constexpr u32 GENERATION_BITS = 32 - INDEX_BITS;
+    static constexpr u32 INDEX_MASK      = (1u << INDEX_BITS) - 1;
+    static constexpr u32 GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+    static constexpr u32 MAX_SLOTS       = 1u << INDEX_BITS;
+
+    u32 value = 0;
+
+    static constexpr AssetHandle make(u32 index, u32 generation) {
+        return { (index & INDEX_MASK) | ((generation & GENERATION_MASK) << INDEX_BITS) };
+    }
+
+    constexpr u32 index() const { return value & INDEX_MASK; }
+    constexpr u32 generation() const { return value >> INDEX_BITS; }
+    constexpr bool is_valid() const { return value != 0; }
+    constexpr explicit operator bool() const { return is_valid(); }
+
+    constexpr bool operator==(const AssetHandle& other) const { return value == other.value; }
+    constexpr bool operator!=(const AssetHandle& other) const { return value != other.value; }
+};
+
+using MeshHandle     = AssetHandle<Mesh>;
+using MaterialHandle = AssetHandle<MaterialInstance>;
+
+static_assert(sizeof(MeshHandle) == sizeof(u32), "Asset handles must stay 32 bits");
+
+} // namespace terra
+
+template<typename T>
+struct std::hash<terra::AssetHandle<T>> {
+    size_t operator()(const terra::AssetHandle<T>& handle) const noexcept {
+        return std::hash<terra::u32>{}(handle.value);
+    }
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/asset_handle.h"
+
+namespace terra {
+
+// Dense slot storage behind AssetHandle<T>. Slots are reused through a free
+// list; every reuse bumps the slot generation so stale handles stop resolving.
+// A slot may be occupied with a null asset while it is still loading; get()
+// returns nullptr for it until set() fills it in.
+// Not thread-safe: the registry only touches pools from the main thread.
+template<typename T>
+class AssetPool {
+public:
+    using Handle = AssetHandle<T>;
+
+    Handle insert(ref<T> asset) {
+        u32 index;
+        if (!m_free_list.empty()) {
+            index = m_free_list.back();
+            m_free_list.pop_back();
+        } else {
+            TR_CORE_ASSERT(m_assets.size() < Handle::MAX_SLOTS, "AssetPool is full");
+            index = (u32) m_assets.size();
+            m_assets.emplace_back();
+            m_generations.push_back(1);
+            m_ref_counts.push_back(0);
+            m_occupied.push_back(false);
+        }
+
+        m_assets[index] = std::move(asset);
+        m_ref_counts[index] = 1;
+        m_occupied[index] = true;
+        ++m_alive;
+
+        return Handle::make(index, m_generations[index]);
+    }
+
+    bool is_alive(Handle handle) const {
+        u32 index = handle.index();
+        return handle.is_valid()
+            && index < m_assets.size()
+            && m_generations[index] == handle.generation()
+            && m_occupied[index];
+    }
+
+    bool is_loaded(Handle handle) const {
+        return is_alive(handle) && m_assets[handle.index()] != nullptr;
+    }
+
+    void set(Handle handle, ref<T> asset) {
+        if (is_alive(handle))
+            m_assets[handle.index()] = std::move(asset);
+    }
+
+    T* get(Handle handle) const {
+        return is_alive(handle) ? m_assets[handle.index()].get() : nullptr;
+    }
+
+    const ref<T>& get_ref(Handle handle) const {
+        static const ref<T> s_null;
+        return is_alive(handle) ? m_assets[handle.index()] : s_null;
+    }
+
+    u32 acquire(Handle handle) {
+        if (!is_alive(handle)) return 0;
+        return ++m_ref_counts[handle.index()];
+    }
+
+    // Returns the remaining reference count.
+    u32 release(Handle handle) {
+        if (!is_alive(handle)) return 0;
+        u32& count = m_ref_counts[handle.index()];
+        TR_CORE_ASSERT(count > 0, "Releasing an asset with no references");
+        return --count;
+    }
+
+    u32 get_ref_count(Handle handle) const {
+        return is_alive(handle) ? m_ref_counts[handle.index()] : 0;
+    }
+
+    void destroy(Handle handle) {
+        if (!is_alive(handle)) return;
+
+        u32 index = handle.index();
+        m_assets[index].reset();
+        m_ref_counts[index] = 0;
+        m_occupied[index] = false;
+
+        // Generation 0 is reserved so a live handle is never the zero value.
+        u32 next = (m_generations[index] + 1) & Handle::GENERATION_MASK;
+        m_generations[index] = next == 0 ? 1 : next;
+
+        m_free_list.push_back(index);
+        --m_alive;
+    }
+
+    void clear() {
+        m_assets.clear();
+        m_generations.clear();
+        m_ref_counts.clear();
+        m_occupied.clear();
+        m_free_list.clear();
+        m_alive = 0;
+    }
+
+    u32 size() const { return m_alive; }
+    u32 capacity() const { return (u32) m_assets.size(); }
+
+private:
+    std::vector<ref<T>> m_assets;
+    std::vector<u32>    m_generations;
+    std::vector<u32>    m_ref_counts;
+    std::vector<bool>   m_occupied;
+    std::vector<u32>    m_free_list;
+    u32                 m_alive = 0;
+};
+
+} // namespace terra
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/asset_handle.h"
+#include "terra/resources/asset_pool.h"
+#include "terra/resources/file_data.h"
+#include "terra/resources/mesh_format.h"
+
+#include <future>
+
+namespace terra {
+
+class Mesh;
+class MaterialInstance;
+
+// Central owner of GPU-backed assets.
+//
+// Meshes loaded from disk are deduplicated first by normalized path, then by
+// file contents (hash, confirmed byte for byte), so two paths pointing at identical data share
+// one set of GPU buffers. Everything is addressed through 32-bit generational
+// handles; the renderer resolves them at draw time instead of copying
+// shared pointers around.
+//
+// Reference counting is explicit: every load/add returns a handle holding one
+// reference, `acquire` adds one and `release` drops one. An asset whose count
+// reaches zero is not destroyed immediately — it is queued and only unloaded
+// after UNLOAD_DELAY_FRAMES frames, since in-flight command buffers may still
+// reference its buffers. Re-acquiring it during that window cancels the unload.
+class AssetRegistry {
+public:
+    static constexpr u64 UNLOAD_DELAY_FRAMES = 3;
+
+    static void init();
+    static void shutdown();
+
+    // Call once per frame (after submit) to advance the frame counter, upload
+    // finished async loads and unload assets whose release grace period has elapsed.
+    static void update();
+
+    static MeshHandle load_mesh(const std::filesystem::path& path);
+
+    // Reads and decodes on the engine ThreadPool; the GPU upload happens in a
+    // later update(). Until then the handle is valid but get() returns null,
+    // which the renderer treats as "skip this draw". If decoding fails the
+    // handle goes stale and the next load of the path tries again.
+    static MeshHandle load_mesh_async(const std::filesystem::path& path);
+
+    // CPU geometry only (cooked or imported), for builders that process
+    // meshes before upload. Not cached or deduplicated.
+    static bool load_mesh_data(const std::filesystem::path& path, MeshData& out);
+
+    static MeshHandle add_mesh(ref<Mesh> mesh, std::string_view name = {});
+    static MaterialHandle add_material(ref<MaterialInstance> material);
+
+    static Mesh* get(MeshHandle handle) { return s_data->meshes.get(handle); }
+    static MaterialInstance* get(MaterialHandle handle) { return s_data->materials.get(handle); }
+
+    static const ref<Mesh>& get_ref(MeshHandle handle) { return s_data->meshes.get_ref(handle); }
+    static const ref<MaterialInstance>& get_ref(MaterialHandle handle) { return s_data->materials.get_ref(handle); }
+
+    static void acquire(MeshHandle handle);
+    static void acquire(MaterialHandle handle);
+    static void release(MeshHandle handle);
+    static void release(MaterialHandle handle);
+
+    static u32 get_ref_count(MeshHandle handle) { return s_data->meshes.get_ref_count(handle); }
+    static u32 get_ref_count(MaterialHandle handle) { return s_data->materials.get_ref_count(handle); }
+
+    static bool is_loaded(MeshHandle handle) { return s_data->meshes.is_loaded(handle); }
+
+    static u32 get_mesh_count() { return s_data->meshes.size(); }
+    static u32 get_pending_load_count() { return (u32) s_data->pending_loads.size(); }
+    static u32 get_material_count() { return s_data->materials.size(); }
+    static u64 get_frame_index() { return s_data->frame_index; }
+
+private:
+    enum class AssetKind : u8 { Mesh, Material };
+
+    struct PendingUnload {
+        AssetKind kind;
+        u32       handle;
+        u64       release_frame;
+    };
+
+    struct MeshKeys {
+        std::string path;
+        u64         content_hash = 0;
+        u64         content_size = 0;
+    };
+
+    struct DecodedMesh {
+        bool     ok = false;
+        MeshData data;
+        FileData file; // kept for the byte comparison on a content hash hit
+        u64      content_hash = 0;
+    };
+
+    struct PendingLoad {
+        MeshHandle               handle;
+        std::future<DecodedMesh> result;
+    };
+
+    struct RegistryData {
+        AssetPool<Mesh>             meshes;
+        AssetPool<MaterialInstance> materials;
+
+        std::unordered_map<std::string, MeshHandle> mesh_by_path;
+        std::unordered_map<u64, MeshHandle>         mesh_by_content;
+        std::unordered_map<MeshHandle, MeshKeys>    mesh_keys;
+
+        std::vector<PendingLoad>   pending_loads;
+        std::vector<PendingUnload> pending_unloads;
+        u64 frame_index = 0;
+    };
+
+    static MeshHandle find_loaded_mesh(const std::string& key);
+    static MeshHandle find_mesh_by_content(u64 content_hash, const FileData& file);
+    static void finish_pending_loads();
+    static void schedule_unload(AssetKind kind, u32 handle);
+    static void unload_mesh(MeshHandle handle);
+
+    static scope<RegistryData> s_data;
+};
+
+} // namespace terra
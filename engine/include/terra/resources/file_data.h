@@ -0,0 +1,64 @@
+#pragma once
+
+#include "terrapch.h"
+
+namespace terra {
+
+// Contents of a file read through the VFS. Either a zero-copy view into a
+// mapped archive (kept alive by `owner`) or an owned heap buffer.
+class FileData {
+public:
+    FileData() = default;
+
+    static FileData from_view(const u8* data, size_t size, std::shared_ptr<const void> owner) {
+        FileData f;
+        f.m_data = data;
+        f.m_size = size;
+        f.m_owner = std::move(owner);
+        f.m_valid = true;
+        return f;
+    }
+
+    static FileData from_buffer(std::vector<u8> buffer) {
+        FileData f;
+        f.m_buffer = std::move(buffer);
+        f.m_data = f.m_buffer.data();
+        f.m_size = f.m_buffer.size();
+        f.m_valid = true;
+        return f;
+    }
+
+    FileData(FileData&& other) noexcept { *this = std::move(other); }
+    FileData& operator=(FileData&& other) noexcept {
+        m_buffer = std::move(other.m_buffer);
+        m_owner = std::move(other.m_owner);
+        m_size = other.m_size;
+        m_valid = other.m_valid;
+        m_data = m_owner ? other.m_data : m_buffer.data();
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_valid = false;
+        return *this;
+    }
+
+    FileData(const FileData&) = delete;
+    FileData& operator=(const FileData&) = delete;
+
+    const u8* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool is_view() const { return m_owner != nullptr; }
+
+    std::string_view as_string() const { return { reinterpret_cast<const char*>(m_data), m_size }; }
+
+    explicit operator bool() const { return m_valid; }
+
+private:
+    const u8* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_valid = false;
+
+    std::vector<u8> m_buffer;
+    std::shared_ptr<const void> m_owner;
+};
+
+} // namespace terra
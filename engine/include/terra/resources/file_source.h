@@ -0,0 +1,36 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/file_data.h"
+
+namespace terra {
+
+// Something the VFS can resolve paths against: a pack archive or a loose
+// directory on disk. Paths are relative to the source's mount point and
+// use forward slashes.
+class FileSource {
+public:
+    virtual ~FileSource() = default;
+
+    virtual bool exists(std::string_view path) const = 0;
+    virtual FileData read(std::string_view path) const = 0;
+    virtual std::string_view get_name() const = 0;
+};
+
+class LooseFileSource : public FileSource {
+public:
+    explicit LooseFileSource(std::filesystem::path root)
+        : m_root(std::move(root)), m_name(m_root.string()) {}
+
+    bool exists(std::string_view path) const override;
+    FileData read(std::string_view path) const override;
+    std::string_view get_name() const override { return m_name; }
+
+    const std::filesystem::path& get_root() const { return m_root; }
+
+private:
+    std::filesystem::path m_root;
+    std::string m_name;
+};
+
+} // namespace terra
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "terra/core/base.h"
+
+#include <cstddef>
+
+namespace terra::lz4 {
+
+// Raw LZ4 block format (no frame header, no checksum). Compatible with the
+// reference LZ4_decompress_safe / LZ4_compress_default block layout, so packs
+// can be produced with external tools as well as PackWriter.
+
+// Worst-case compressed size for `size` input bytes.
+constexpr size_t compress_bound(size_t size) { return size + size / 255 + 16; }
+
+// Greedy single-pass compressor. Returns the compressed size, or 0 if `dst`
+// is too small.
+size_t compress(const u8* src, size_t src_size, u8* dst, size_t dst_capacity);
+
+// Bounds-checked decoder. `dst_size` must be the exact decompressed size;
+// returns false on malformed input.
+bool decompress(const u8* src, size_t src_size, u8* dst, size_t dst_size);
+
+} // namespace terra::lz4
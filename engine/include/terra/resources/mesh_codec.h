@@ -0,0 +1,35 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/mesh_format.h"
+
+namespace terra::mesh_codec {
+
+// Lossless geometry compression for cooked meshes.
+//
+// Vertices are treated as rows of 32-bit words. Each row is stored as the
+// difference from the previous row, then the words are split into four byte
+// planes: neighbouring vertices tend to share exponents and high mantissa
+// bits, so the upper planes turn into long runs. Indices are delta coded
+// against the previous index and zigzag mapped so small back-references stay
+// small, then byte-planed the same way. Both streams finish with an LZ4 block.
+//
+// Decoding is LZ4 followed by SIMD plane interleaving and prefix sums (SSE2
+// on x86-64, NEON on arm64, scalar elsewhere).
+
+struct EncodedSizes {
+    u32 vertex_stream = 0;
+    u32 index_stream = 0;
+};
+
+// Appends the two compressed streams to `out`.
+EncodedSizes encode(const MeshData& mesh, std::vector<u8>& out);
+
+// `vertices`/`indices` must already be sized for the decoded data.
+bool decode_vertices(const u8* stream, size_t stream_size, u32 vertex_stride, f32* vertices, size_t vertex_float_count);
+bool decode_indices(const u8* stream, size_t stream_size, u32* indices, size_t index_count);
+
+// Name of the decoder path compiled in, for logs and benchmarks.
+std::string_view get_simd_path();
+
+} // namespace terra::mesh_codec
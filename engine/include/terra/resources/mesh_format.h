@@ -0,0 +1,94 @@
+#pragma once
+
+#include "terrapch.h"
+
+namespace terra {
+
+constexpr u32 MAX_MESH_LODS = 8;
+
+// One level of detail: a range of MeshData::indices drawn against the shared
+// vertex array. `error` is how far the level deviates from LOD 0, in object units.
+struct MeshLod {
+    u32 index_offset = 0;
+    u32 index_count = 0;
+    u32 vertex_count = 0; // unique vertices referenced
+    f32 error = 0.0f;
+};
+
+static_assert(sizeof(MeshLod) == 16);
+
+constexpr u32 MESHLET_MAX_VERTICES  = 64;
+constexpr u32 MESHLET_MAX_TRIANGLES = 124;
+
+// A small cluster of LOD 0 triangles, laid out as the cull shader reads it.
+// The triangles are MeshData::indices[index_offset, index_offset + 3 * triangle_count).
+// The cluster faces away from a camera at `eye` when
+//   dot(center - eye, cone_axis) >= cone_cutoff * length(center - eye) + radius;
+// a cutoff of 1 means the normals are too spread out to ever cull.
+struct Meshlet {
+    f32 center[3] = {};
+    f32 radius = 0.0f;
+    f32 cone_axis[3] = {};
+    f32 cone_cutoff = 1.0f;
+    u32 index_offset = 0;
+    u32 triangle_count = 0;
+    u32 padding[2] = {};
+};
+
+static_assert(sizeof(Meshlet) == 48);
+
+// CPU-side geometry in the engine's default interleaved layout
+// (position xyz + color rgb, 6 floats per vertex).
+struct MeshData {
+    std::vector<f32> vertices;
+    std::vector<u32> indices;
+    u32 vertex_stride = 6; // floats per vertex
+
+    // Finest first. Empty means a single level covering all of `indices`.
+    std::vector<MeshLod> lods;
+
+    // Clusters covering LOD 0, whose triangles are ordered meshlet by meshlet.
+    // Empty for meshes too small to benefit from per-cluster culling.
+    std::vector<Meshlet> meshlets;
+
+    u32 get_vertex_count() const { return vertex_stride ? (u32) (vertices.size() / vertex_stride) : 0; }
+    u32 get_index_count() const { return (u32) indices.size(); }
+};
+
+// Cooked mesh (.tmesh): a header, then (MeshFileFlags_Lods) a u32 level count
+// and that many MeshLod entries, then (MeshFileFlags_Meshlets) a u32 meshlet
+// count and that many Meshlet entries, then either directly the vertex floats
+// and the u32 indices, or (MeshFileFlags_Compressed) two u32 stream sizes and
+// the mesh_codec vertex and index streams.
+constexpr u32 MESH_FILE_MAGIC   = 0x48534D54; // "TMSH"
+constexpr u32 MESH_FILE_VERSION = 4;
+
+enum MeshFileFlags : u32 {
+    MeshFileFlags_None       = 0,
+    MeshFileFlags_Compressed = 1 << 0,
+    MeshFileFlags_Lods       = 1 << 1,
+    MeshFileFlags_Meshlets   = 1 << 2,
+};
+constexpr std::string_view MESH_FILE_EXTENSION = ".tmesh";
+
+struct MeshFileHeader {
+    u32 magic = MESH_FILE_MAGIC;
+    u32 version = MESH_FILE_VERSION;
+    u32 vertex_count = 0;
+    u32 index_count = 0;
+    u32 vertex_stride = 0; // floats per vertex
+    u32 flags = 0;
+};
+
+static_assert(sizeof(MeshFileHeader) == 24);
+
+// With `compress`, the codec is used only when it actually shrinks the mesh.
+std::vector<u8> write_mesh_file(const MeshData& mesh, bool compress = false);
+// Fails on truncated or inconsistent files, including any index that is not
+// below the vertex count.
+bool read_mesh_file(const u8* data, size_t size, MeshData& out);
+
+// "objects/pyramid.txt" -> "objects/pyramid.tmesh"
+std::string get_cooked_mesh_path(std::string_view source_path);
+
+} // namespace terra
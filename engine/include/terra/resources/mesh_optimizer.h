@@ -0,0 +1,51 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/mesh_format.h"
+
+#include <span>
+
+namespace terra::mesh_optimizer {
+
+constexpr u32 DEFAULT_CACHE_SIZE = 16;
+
+// Post-transform cache behaviour of an index buffer under a FIFO cache model.
+// ACMR: vertices shaded per triangle (0.5 is ideal for large grids, 3 worst).
+// ATVR: vertices shaded per unique vertex referenced (1.0 is ideal).
+struct CacheStats {
+    f32 acmr = 0.0f;
+    f32 atvr = 0.0f;
+    u32 transformed = 0;
+};
+
+struct OptimizeReport {
+    CacheStats before;
+    CacheStats after;
+    u32 cluster_count = 0;
+    u32 removed_vertices = 0;
+};
+
+CacheStats analyze_vertex_cache(std::span<const u32> indices, size_t vertex_count, u32 cache_size = DEFAULT_CACHE_SIZE);
+
+// Tipsify (Sander, Nehab, Barczak 2007). Writes the reordered triangles to
+// `dst` (same size as `indices`). If `clusters` is given it receives the
+// first-triangle index of every cluster that started at a dead end.
+void optimize_vertex_cache(std::span<u32> dst, std::span<const u32> indices, size_t vertex_count,
+    u32 cache_size = DEFAULT_CACHE_SIZE, std::vector<u32>* clusters = nullptr);
+
+// Splits cache-optimized triangles into small clusters and sorts them so the
+// ones facing away from the mesh centre, which tend to occlude the rest, are
+// drawn first. Clusters only end where their own ACMR is within `threshold` of
+// the input's, so cache efficiency is mostly preserved. Returns the cluster count.
+u32 optimize_overdraw(std::span<u32> indices, const f32* vertices, size_t vertex_count, u32 vertex_stride,
+    const std::vector<u32>& hard_clusters, f32 threshold = 1.05f, u32 cache_size = DEFAULT_CACHE_SIZE);
+
+// Renumbers vertices in first-use order and rewrites the vertex array to
+// match, so fetches walk memory linearly. Unreferenced vertices are dropped.
+// Returns the new vertex count.
+u32 optimize_vertex_fetch(MeshData& mesh);
+
+// All three passes in order. Meshes with out-of-range indices are left as is.
+OptimizeReport optimize(MeshData& mesh, u32 cache_size = DEFAULT_CACHE_SIZE);
+
+} // namespace terra::mesh_optimizer
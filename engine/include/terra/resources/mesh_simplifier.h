@@ -0,0 +1,36 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/mesh_format.h"
+
+#include <span>
+
+namespace terra::mesh_simplifier {
+
+// Greedy quadric edge-collapse simplification (Garland & Heckbert 1997).
+// Vertices are only ever collapsed onto an existing neighbour, so the result
+// indexes the same vertex array and every LOD can share one vertex buffer.
+// Vertices on attribute seams (same position, different data) stay put, and
+// open borders only collapse along themselves.
+//
+// Stops once `target_index_count` is reached or the next collapse would move
+// the surface by more than `target_error`, given as a fraction of the mesh's
+// largest extent. Writes to `dst` (same size as `indices`) and returns the new
+// index count. `result_error` receives the error reached, in the same units.
+size_t simplify(std::span<u32> dst, std::span<const u32> indices, const f32* vertices, size_t vertex_count,
+    u32 vertex_stride, size_t target_index_count, f32 target_error, f32* result_error = nullptr);
+
+struct LodSettings {
+    u32 max_lods = 4;           // including LOD 0
+    f32 reduction = 0.5f;       // triangle ratio between consecutive levels
+    f32 max_error = 0.05f;      // per level, as a fraction of the mesh extent
+    f32 min_reduction = 0.85f;  // a level that keeps more than this ratio is dropped
+};
+
+// Simplifies LOD 0 repeatedly, each level from the previous one, appending
+// the cache-optimized index ranges to `mesh.indices` and describing them in
+// `mesh.lods`. Leaves `mesh.lods` empty if no coarser level was worth keeping.
+// Returns the number of levels, LOD 0 included.
+u32 generate_lods(MeshData& mesh, const LodSettings& settings = {});
+
+} // namespace terra::mesh_simplifier
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/mesh_format.h"
+
+#include <span>
+
+namespace terra::meshlet_builder {
+
+struct MeshletSettings {
+    u32 max_vertices = MESHLET_MAX_VERTICES;
+    u32 max_triangles = MESHLET_MAX_TRIANGLES;
+    f32 cone_weight = 0.5f;   // how strongly normal agreement is favoured over compactness
+    u32 min_triangles = 8192; // smaller meshes are culled whole
+};
+
+// Splits LOD 0 into meshlets. Each cluster grows from a seed triangle by
+// repeatedly taking the neighbouring triangle that adds the fewest new
+// vertices, then the one closest to its centre and best aligned with its
+// average normal, so clusters come out compact with tight normal cones.
+// LOD 0's triangles are reordered in place so every meshlet is a contiguous
+// index range; coarser levels are untouched. Fills `mesh.meshlets` and
+// returns how many were built, 0 when LOD 0 is below `min_triangles`.
+u32 build_meshlets(MeshData& mesh, const MeshletSettings& settings = {});
+
+// Bounding sphere and normal cone of the triangles in `indices`.
+Meshlet compute_meshlet_bounds(std::span<const u32> indices, const f32* vertices, u32 vertex_stride);
+
+} // namespace terra::meshlet_builder
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/file_data.h"
+#include "terra/resources/file_source.h"
+
+#include <span>
+
+namespace terra {
+
+// On-disk layout of a .tpak archive:
+//
+//   PackHeader
+//   PackEntry[entry_count]      sorted by path_hash
+//   name table                  '\0'-separated virtual paths
+//   entry payloads              each aligned to `alignment`
+//
+// Payloads are either stored raw (readable in place from the mapping) or
+// as a single LZ4 block. All integers are little endian.
+
+constexpr u32 PACK_MAGIC   = 0x4B415054; // "TPAK"
+constexpr u32 PACK_VERSION = 1;
+constexpr u32 PACK_DEFAULT_ALIGNMENT = 16;
+
+enum PackEntryFlags : u32 {
+    PackEntryFlags_None = 0,
+    PackEntryFlags_LZ4  = 1 << 0,
+};
+
+struct PackHeader {
+    u32 magic = PACK_MAGIC;
+    u32 version = PACK_VERSION;
+    u32 entry_count = 0;
+    u32 alignment = PACK_DEFAULT_ALIGNMENT;
+    u64 toc_offset = 0;
+    u64 names_offset = 0;
+    u64 names_size = 0;
+};
+
+struct PackEntry {
+    u64 path_hash = 0;
+    u64 offset = 0;
+    u64 stored_size = 0;
+    u64 size = 0;
+    u32 name_offset = 0;
+    u32 name_length = 0;
+    u32 flags = PackEntryFlags_None;
+    u32 reserved = 0;
+};
+
+static_assert(sizeof(PackHeader) == 40);
+static_assert(sizeof(PackEntry) == 48);
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    ~MappedFile();
+
+    static std::shared_ptr<MappedFile> open(const std::filesystem::path& path);
+
+    const u8* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    // Hints the OS to start paging the given range in.
+    void prefetch(size_t offset, size_t size) const;
+
+private:
+    MappedFile() = default;
+
+    const u8* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+class PackArchive : public FileSource {
+public:
+    static ref<PackArchive> open(const std::filesystem::path& path);
+
+    bool exists(std::string_view path) const override;
+    FileData read(std::string_view path) const override;
+    std::string_view get_name() const override { return m_name; }
+
+    const PackEntry* find(std::string_view path) const;
+    std::string_view get_entry_name(const PackEntry& entry) const;
+
+    const std::vector<PackEntry>& get_entries() const { return m_entries; }
+
+    // Pages the whole archive in ahead of use.
+    void prefetch() const;
+
+private:
+    PackArchive() = default;
+
+    std::string m_name;
+    std::shared_ptr<MappedFile> m_file;
+    std::vector<PackEntry> m_entries;
+    std::string_view m_names;
+};
+
+class PackWriter {
+public:
+    explicit PackWriter(u32 alignment = PACK_DEFAULT_ALIGNMENT) : m_alignment(alignment) {}
+
+    // Entries are LZ4-compressed only when that saves at least
+    // `min_savings` of the input; otherwise they stay mappable in place.
+    void add_file(std::string_view virtual_path, std::span<const u8> data, bool compress = true, f32 min_savings = 0.1f);
+    void add_file(std::string_view virtual_path, std::string_view data, bool compress = true, f32 min_savings = 0.1f) {
+        add_file(virtual_path, std::span<const u8>(reinterpret_cast<const u8*>(data.data()), data.size()), compress, min_savings);
+    }
+
+    bool write(const std::filesystem::path& output_path) const;
+
+    size_t get_entry_count() const { return m_files.size(); }
+
+private:
+    struct PendingFile {
+        std::string path;
+        std::vector<u8> stored;
+        u64 size = 0;
+        u32 flags = PackEntryFlags_None;
+    };
+
+    u32 m_alignment;
+    std::vector<PendingFile> m_files;
+};
+
+} // namespace terra
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "terrapch.h"
+#include "terra/resources/file_data.h"
+#include "terra/resources/mesh_format.h"
 
 
 namespace terra {
@@ -8,10 +10,6 @@ namespace terra {
 class ResourceManager {
 public:
 
-    static std::filesystem::path get_asset_path(const std::string& relative_path) {
-        return std::filesystem::path(ENGINE_ASSETS_DIR) / relative_path;
-    }
-
     static bool load_geometry(
         const std::filesystem::path& path, 
         std::vector<f32>& vertex_data, 
@@ -19,6 +17,31 @@ public:
         bool is_3d
     );
 
+    // Same format as load_geometry, for callers that already hold the file contents.
+    static bool parse_geometry(
+        std::string_view source,
+        const std::filesystem::path& path,
+        std::vector<f32>& vertex_data,
+        std::vector<u32>& index_data,
+        bool is_3d
+    );
+
+    static bool parse_geometry(
+        std::istream& stream,
+        const std::filesystem::path& path,
+        std::vector<f32>& vertex_data,
+        std::vector<u32>& index_data,
+        bool is_3d
+    );
+
+    // parse_geometry followed by the mesh optimizer (vertex cache, overdraw
+    // and vertex fetch ordering) and LOD chain generation. Used by every path
+    // that imports source geometry.
+    static bool import_geometry(std::string_view source, const std::filesystem::path& path, MeshData& mesh);
+
+    // Reads through the VirtualFileSystem, so packed and loose assets are
+    // interchangeable. Prefer read_file to avoid copying archive contents.
+    static FileData read_file(std::string_view relative_path);
     static std::string read_file_as_string(const std::string& relative_path);
 
 };
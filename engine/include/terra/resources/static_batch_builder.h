@@ -0,0 +1,57 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/renderer/frustum.h"
+#include "terra/resources/asset_handle.h"
+#include "terra/resources/mesh_format.h"
+
+#include <glm/glm.hpp>
+
+namespace terra {
+
+struct StaticBatchSettings {
+    f32 chunk_size = 32.0f;          // edge of the world-space grid cells objects are bucketed into
+    u32 max_chunk_vertices = 65536;  // keeps chunks on 16-bit indices
+};
+
+// One merged draw: every object of a material and vertex layout whose centre
+// falls in the same grid cell, pre-transformed into world space.
+struct StaticChunk {
+    MaterialHandle material;
+    MeshData mesh;
+    BoundingBox bounds;
+    u32 object_count = 0;
+};
+
+// Bakes objects that never move into a few large world-space meshes, so they
+// cost a handful of draws and no per-frame instance data. Objects are kept
+// whole (never split across chunks) and bucketed spatially so chunks can
+// still be frustum culled. CPU only: runs at level load or offline.
+class StaticBatchBuilder {
+public:
+    explicit StaticBatchBuilder(const StaticBatchSettings& settings = {});
+
+    // `mesh` must outlive build(). `color` multiplies the vertex colours,
+    // standing in for the per-instance colour a dynamic draw would carry.
+    // Only LOD 0 is merged.
+    void add(const MeshData& mesh, const glm::mat4& transform, MaterialHandle material, const glm::vec4& color = glm::vec4(1.0f));
+
+    std::vector<StaticChunk> build() const;
+
+    u32 get_object_count() const { return (u32) m_objects.size(); }
+    void clear() { m_objects.clear(); }
+
+private:
+    struct Object {
+        const MeshData* mesh;
+        glm::mat4 transform;
+        glm::vec4 color;
+        MaterialHandle material;
+        glm::ivec3 cell;
+    };
+
+    StaticBatchSettings m_settings;
+    std::vector<Object> m_objects;
+};
+
+} // namespace terra
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/mesh_format.h"
+
+#include <glm/glm.hpp>
+
+namespace terra {
+
+// GPU vertex encoding chosen when a mesh is uploaded. Cooked and in-memory
+// geometry stays Float32; only the vertex buffer is packed.
+enum class VertexQuantization : u8 {
+    None,    // Float32x3 position and colour (24 bytes)
+    Unorm16, // Unorm16x4 position relative to the mesh bounds, Unorm8x4 colour (12 bytes)
+    Float16, // Float16x4 position, Unorm8x4 colour (12 bytes)
+};
+
+// Per-mesh constants the vertex shader applies to the fetched position:
+// position = position_offset.xyz + position * position_scale.xyz.
+// Identity for None and Float16.
+struct alignas(16) MeshDecodeParams {
+    glm::vec4 position_offset{ 0.0f };
+    glm::vec4 position_scale{ 1.0f };
+};
+
+static_assert(sizeof(MeshDecodeParams) == 32);
+
+struct QuantizedVertices {
+    std::vector<u8> data;
+    u32 stride = 0; // bytes per vertex
+    MeshDecodeParams decode;
+};
+
+namespace vertex_quantization {
+
+// MeshData vertices with 9 floats carry a normal after the colour; it is
+// packed as an octahedral Snorm16x2 (4 bytes) when quantizing.
+constexpr u32 NORMAL_VERTEX_STRIDE = 9;
+
+u32 get_vertex_size(VertexQuantization mode, bool normals);
+
+QuantizedVertices quantize(const MeshData& mesh, VertexQuantization mode);
+
+// Octahedral unit-vector encoding (Cigolle et al. 2014) packed as two
+// snorm16 values, x in the low half. In WGSL:
+//   fn oct_decode(e: vec2f) -> vec3f {
+//       var n = vec3f(e, 1.0 - abs(e.x) - abs(e.y));
+//       let t = max(-n.z, 0.0);
+//       n.x += select(t, -t, n.x >= 0.0);
+//       n.y += select(t, -t, n.y >= 0.0);
+//       return normalize(n);
+//   }
+u32 encode_octahedral(const glm::vec3& normal);
+glm::vec3 decode_octahedral(u32 packed);
+
+} // namespace vertex_quantization
+
+} // namespace terra
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "terrapch.h"
+#include "terra/resources/file_data.h"
+#include "terra/resources/file_source.h"
+
+namespace terra {
+
+// Resolves virtual paths ("objects/pyramid.txt", "game/fonts/x.ttf") against
+// mounted sources. A mount point is a path prefix; the empty mount point
+// matches everything. Sources are searched newest-overlay first, then in
+// mount order, so loose development files can shadow packed ones.
+class VirtualFileSystem {
+public:
+    // Mounts the default engine/game packs (if present) and the loose asset
+    // directories. Safe to call more than once.
+    static void init();
+    static void shutdown();
+
+    static void mount(std::string_view mount_point, ref<FileSource> source, bool overlay = false);
+    static bool mount_archive(std::string_view mount_point, const std::filesystem::path& archive_path);
+    static void unmount(std::string_view mount_point);
+
+    static FileData read(std::string_view path);
+    static bool exists(std::string_view path);
+
+    // Search position of the mount that would serve `path` (lower wins), or
+    // -1 if none has it. Lets callers choosing between two candidate files
+    // honour the same shadowing rules as read().
+    static i32 find_mount(std::string_view path);
+
+    // Pages in every mounted archive, for use while something else is busy.
+    static void prefetch_archives();
+
+    static std::string normalize_path(std::string_view path);
+};
+
+} // namespace terra
@@ -5,15 +5,22 @@
 #include "terra/events/key_event.h"
 #include "terra/events/mouse_event.h"
 
+struct ImFontAtlas;
 
 namespace terra {
 
 class UILayer : public Layer
 {
 public:
-    UILayer();
+    // Takes ownership of `font_atlas`, built by build_font_atlas(); the
+    // fonts are loaded in on_attach() when none is given.
+    explicit UILayer(ImFontAtlas* font_atlas = nullptr);
     ~UILayer();
 
+    // Loads the fonts and rasterizes the atlas. Needs no ImGui context, so
+    // it can run on a worker while the device is being created.
+    static ImFontAtlas* build_font_atlas();
+
     virtual void on_attach() override;
     virtual void on_detach() override;
     virtual void on_event(Event& e) override;
@@ -23,6 +30,7 @@ public:
     void block_events(bool block) { m_block_events = block; }
     void set_dark_theme_colors();
 private:
+    ImFontAtlas* m_font_atlas = nullptr;
     bool m_block_events = true;
     float m_time = 0.0f;
 };
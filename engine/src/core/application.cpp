@@ -2,16 +2,63 @@
 #include "terra/core/assert.h"
 #include "terra/core/logger.h"
 #include "terra/core/timestep.h"
+#include "terra/core/thread_pool.h"
 
 #include "terra/renderer/renderer_api.h"
 #include "terra/core/window.h"
 #include "terra/debug/profiler.h"
+#include "terra/debug/profiler_layer.h"
+#include "terra/resources/virtual_file_system.h"
 
 namespace terra {
 
 Application* Application::s_instance = nullptr;
 
-Application::Application(const std::string& name, CommandLineArgs args)
+static constexpr u32 PROFILE_CAPTURE_FRAMES = 120;
+
+namespace {
+
+// Wall time of each startup stage, logged once the application is up. With
+// profiling on, the stages also go to the init trace, where they line up
+// with the thread pool work that overlaps them.
+class StartupTimeline {
+public:
+    using Clock = Profiler::Clock;
+
+    StartupTimeline() : m_start(Clock::now()), m_last(m_start) {}
+
+    // Ends the stage that started at the previous mark.
+    void mark(const char* stage) {
+        const Clock::time_point now = Clock::now();
+    #if ENABLE_PROFILING
+        Profiler::Instrumentor& instrumentor = Profiler::Instrumentor::get();
+        if (Profiler::Instrumentor::is_active())
+            instrumentor.record(instrumentor.intern(stage), (u64) m_last.time_since_epoch().count(), (u64) now.time_since_epoch().count());
+    #endif
+        m_stages.push_back({ stage, std::chrono::duration<f32, std::milli>(now - m_last).count() });
+        m_last = now;
+    }
+
+    void log() const {
+        TR_CORE_INFO("Startup took {:.1f} ms", std::chrono::duration<f32, std::milli>(m_last - m_start).count());
+        for (const Stage& stage : m_stages)
+            TR_CORE_INFO("  {:<20} {:8.2f} ms", stage.name, stage.ms);
+    }
+
+private:
+    struct Stage {
+        const char* name;
+        f32 ms;
+    };
+
+    Clock::time_point m_start;
+    Clock::time_point m_last;
+    std::vector<Stage> m_stages;
+};
+
+} // namespace
+
+Application::Application(const std::string& name, CommandLineArgs args, const ContextProps& context_props)
     : m_command_line_args(args)
 {
     PROFILE_FUNCTION();
@@ -19,26 +66,57 @@ Application::Application(const std::string& name, CommandLineArgs args)
     TR_CORE_ASSERT(!s_instance, "Application already exists!");
     s_instance = this;
 
+    StartupTimeline timeline;
+
+    init_profiling();
+
+    VirtualFileSystem::init();
+    timeline.mark("Mount assets");
+
+    // Work that needs neither the window nor the device runs on the pool
+    // while those are created, the device request being the slowest part.
+    ThreadPool& pool = ThreadPool::get();
+    std::future<void> prefetch = pool.submit([] { VirtualFileSystem::prefetch_archives(); });
+    #if !defined(TR_RELEASE)
+        std::future<ImFontAtlas*> font_atlas = pool.submit([] { return UILayer::build_font_atlas(); });
+    #endif
+
     TR_CORE_INFO("Creating window");
     m_window = Window::create(WindowProps(name));
 	m_window->set_event_cb(TR_BIND_EVENT_FN(Application::on_event));
+    timeline.mark("Create window");
 
-    m_context = WebGPUContext::create();
-    m_context->init(m_window.get());
+    m_context = WebGPUContext::create(context_props);
+    m_context->begin_init(m_window.get());
+    timeline.mark("Request device");
+
+    m_context->finish_init();
+    timeline.mark("Acquire device");
 
     RendererAPI::init(m_context.get());
+    timeline.mark("Init renderer");
 
     #if !defined(TR_RELEASE)
         TR_CORE_INFO("Creating ImGui layer");
-        m_ui_layer = new UILayer();
+        m_ui_layer = new UILayer(font_atlas.get());
         push_overlay(m_ui_layer);
+        #if ENABLE_PROFILING
+            push_overlay(new ProfilerLayer());
+        #endif
+        timeline.mark("Init UI");
     #endif
+
+    prefetch.wait();
+    timeline.mark("Prefetch assets");
+
+    timeline.log();
 }
 
 Application::~Application() {
     PROFILE_FUNCTION();
     TR_CORE_INFO("Shutting down Terra Engine...");
     RendererAPI::shutdown();
+    VirtualFileSystem::shutdown();
     m_window.reset();
 }
 
@@ -58,6 +136,7 @@ void Application::on_event(Event& e)
     EventDispatcher dispatcher(e);
     dispatcher.dispatch<WindowCloseEvent>(TR_BIND_EVENT_FN(Application::on_window_close));
     dispatcher.dispatch<WindowResizeEvent>(TR_BIND_EVENT_FN(Application::on_window_resize));
+    dispatcher.dispatch<KeyPressedEvent>(TR_BIND_EVENT_FN(Application::on_key_pressed));
 
     for (auto it = m_layer_stack.rbegin(); it != m_layer_stack.rend(); ++it)
     {
@@ -112,8 +191,13 @@ void Application::run() {
 
         RendererAPI::end_frame();
 
+        // Paced before polling, so the next frame sees the freshest input.
+        m_frame_limiter.wait();
+
         m_window->on_update();
 
+        PROFILE_FRAME();
+
         // break;
     }
 
@@ -144,6 +228,43 @@ bool Application::on_window_resize(WindowResizeEvent& e) {
     return false;
 }
 
+// F9 records the next PROFILE_CAPTURE_FRAMES frames.
+bool Application::on_key_pressed(KeyPressedEvent& e) {
+    #if ENABLE_PROFILING
+        if (e.get_key_code() == Key::F9 && e.get_repeat_count() == 0) {
+            TR_CORE_INFO("Capturing the next {} frames to terra_capture.ttrace", PROFILE_CAPTURE_FRAMES);
+            Profiler::Instrumentor::get().capture_frames(PROFILE_CAPTURE_FRAMES);
+        }
+    #endif
+    return false;
+}
+
+// Recording is off unless asked for:
+//   --profile-frames N [--profile-output file]   capture frames 1..N
+//   --flight-recorder [--frame-budget-ms X]      dump history on slow frames
+//   --hardware-counters                          add perf counters (Linux)
+void Application::init_profiling() {
+    #if ENABLE_PROFILING
+        Profiler::Instrumentor& instrumentor = Profiler::Instrumentor::get();
+
+        if (const char* frames = m_command_line_args.get_option("--profile-frames")) {
+            const char* output = m_command_line_args.get_option("--profile-output");
+            instrumentor.capture_frames((u32) std::max(0, std::atoi(frames)), output ? output : "terra_capture.ttrace");
+        }
+
+        if (m_command_line_args.has_flag("--flight-recorder")) {
+            Profiler::FlightRecorderSettings settings;
+            if (const char* budget = m_command_line_args.get_option("--frame-budget-ms"))
+                settings.frame_budget_ms = std::atof(budget);
+            instrumentor.enable_flight_recorder(settings);
+            TR_CORE_INFO("Flight recorder on, frame budget {:.1f} ms", settings.frame_budget_ms);
+        }
+
+        if (m_command_line_args.has_flag("--hardware-counters"))
+            instrumentor.enable_hardware_counters();
+    #endif
+}
+
 bool Application::on_window_close(WindowCloseEvent& e) {
     m_running = false;
     return true;
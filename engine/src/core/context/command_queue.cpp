@@ -18,6 +18,8 @@ void on_queue_work_done(wgpu::QueueWorkDoneStatus status) {
 void CommandQueue::init(const wgpu::Device device) {
     m_device = device;
     m_queue = device.GetQueue();
+    m_readback = create_scope<ReadbackManager>(device);
+    m_gpu_profiler = create_scope<GpuProfiler>(device, *m_readback);
 
     m_queue.OnSubmittedWorkDone(wgpu::CallbackMode::AllowSpontaneous, on_queue_work_done);
 }
@@ -67,14 +69,22 @@ wgpu::RenderPassEncoder CommandQueue::create_render_pass(const RenderPassDesc& d
         const auto& src = desc.depth_stencil_attachment;
     
         depth_attachment.view = src.view;
-        depth_attachment.depthLoadOp = src.load_op;
-        depth_attachment.depthStoreOp = src.store_op;
         depth_attachment.depthClearValue = src.clear_depth;
         depth_attachment.depthReadOnly = src.read_only_depth;
+        // Read-only depth must leave its load and store ops undefined.
+        if (!src.read_only_depth) {
+            depth_attachment.depthLoadOp = src.load_op;
+            depth_attachment.depthStoreOp = src.store_op;
+        }
 
         render_pass_desc.depthStencilAttachment = &depth_attachment;
     }
 
+    wgpu::RenderPassTimestampWrites timestamp_writes = {};
+    if (m_gpu_profiler->begin_pass(desc.name, timestamp_writes)) {
+        render_pass_desc.timestampWrites = &timestamp_writes;
+    }
+
     // --- Begin render pass ---
     m_render_pass_encoder = m_encoder.BeginRenderPass(&render_pass_desc);
 
@@ -124,7 +134,9 @@ void CommandQueue::add_marker(std::string_view label) {
 void CommandQueue::poll([[maybe_unused]] bool yield_to_browser) {
     PROFILE_FUNCTION();
 
+    m_gpu_profiler->end_frame();
     wgpu_poll_events(m_device, false);
+    m_readback->poll();
 }
 
 
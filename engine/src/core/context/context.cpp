@@ -34,6 +34,13 @@ void on_uncaptured_error(const wgpu::Device& device, wgpu::ErrorType type, wgpu:
 
 
 void WebGPUContext::init(Window* window_handle) {
+    begin_init(window_handle);
+    finish_init();
+}
+
+void WebGPUContext::begin_init(Window* window_handle) {
+    PROFILE_FUNCTION();
+
 	TR_CORE_ASSERT(window_handle, "Window handle is null!");
 
 	m_window_handle = window_handle;
@@ -54,34 +61,89 @@ void WebGPUContext::init(Window* window_handle) {
 	wgpu::RequestAdapterOptions adapter_opts = {};
 	adapter_opts.nextInChain = nullptr;
     adapter_opts.compatibleSurface = m_surface;
-	wgpu::Adapter adapter = request_adapter_sync(m_instance, &adapter_opts);
 
-	inspect_adapter(adapter);
+    // The device is requested from the adapter callback, so both complete
+    // from whatever event processing happens first after this returns.
+    m_device_request_ended = false;
+    m_instance.RequestAdapter(
+        &adapter_opts,
+        wgpu::CallbackMode::AllowProcessEvents,
+        [this](wgpu::RequestAdapterStatus status, wgpu::Adapter adapter, const char* message) {
+            if (status != wgpu::RequestAdapterStatus::Success) {
+                TR_CORE_ERROR("RequestAdapter failed: {}", message ? message : "No message");
+                m_device_request_ended = true;
+                return;
+            }
+            m_adapter = adapter;
+            request_device();
+        });
+}
 
+void WebGPUContext::request_device() {
     wgpu::DeviceDescriptor device_desc = {};
     device_desc.label = "TerraDevice";
     device_desc.defaultQueue.label = "MainQueue";
 
-    request_userdata<u32> data;
-
     device_desc.SetDeviceLostCallback(wgpu::CallbackMode::AllowSpontaneous, &on_device_lost);
 
     device_desc.SetUncapturedErrorCallback(&on_uncaptured_error);
 
-	m_device = request_device_sync(adapter, &device_desc);
+    // Optional; the GpuProfiler stays off without it.
+    std::vector<wgpu::FeatureName> features;
+    if (m_adapter.HasFeature(wgpu::FeatureName::TimestampQuery))
+        features.push_back(wgpu::FeatureName::TimestampQuery);
+    device_desc.requiredFeatureCount = features.size();
+    device_desc.requiredFeatures = features.data();
+
+    m_adapter.RequestDevice(
+        &device_desc,
+        wgpu::CallbackMode::AllowProcessEvents,
+        [this](wgpu::RequestDeviceStatus status, wgpu::Device device, const char* message) {
+            if (status == wgpu::RequestDeviceStatus::Success) {
+                m_device = device;
+            } else {
+                TR_CORE_ERROR("RequestDevice failed: {}", message ? message : "No message");
+            }
+            m_device_request_ended = true;
+        });
+}
 
+void WebGPUContext::finish_init() {
+    PROFILE_FUNCTION();
+
+    process_events_until(m_instance, m_device_request_ended);
+    TR_CORE_ASSERT(m_device, "Could not acquire a WebGPU device");
+
+	inspect_adapter(m_adapter);
     inspect_device(m_device);
 
 	m_queue = CommandQueue::create();
     m_queue->init(m_device);
 
-	m_surface_format = inspect_surface_capabilities(m_surface, adapter);
+	m_surface_format = inspect_surface_capabilities(m_surface, m_adapter);
+
+    wgpu::SurfaceCapabilities capabilities = {};
+    if (m_surface.GetCapabilities(m_adapter, &capabilities) == wgpu::Status::Success)
+        m_supported_present_modes.assign(capabilities.presentModes, capabilities.presentModes + capabilities.presentModeCount);
+
+    m_present_mode = wgpu::PresentMode::Fifo;
+    for (wgpu::PresentMode mode : m_props.present_modes) {
+        if (std::find(m_supported_present_modes.begin(), m_supported_present_modes.end(), mode) != m_supported_present_modes.end()) {
+            m_present_mode = mode;
+            break;
+        }
+    }
+    m_requested_present_mode = m_present_mode;
+    TR_CORE_INFO("Present mode: {}", m_present_mode);
+
 	configure_surface(m_surface_format);
 }
 
 void WebGPUContext::configure_surface(wgpu::TextureFormat preferred_format) {
 	TR_CORE_INFO("Configuring swap chain...");
 
+    m_present_mode = m_requested_present_mode;
+
     auto [fb_width, fb_height] = m_window_handle->get_framebuffer_size();
 
 	wgpu::SurfaceConfiguration config = {};
@@ -90,7 +152,7 @@ void WebGPUContext::configure_surface(wgpu::TextureFormat preferred_format) {
     config.usage        = wgpu::TextureUsage::RenderAttachment;
     config.width        = fb_width;
     config.height       = fb_height;
-    config.presentMode  = wgpu::PresentMode::Fifo;
+    config.presentMode  = m_present_mode;
     config.alphaMode    = wgpu::CompositeAlphaMode::Auto;
     config.viewFormatCount = 0;
     config.viewFormats     = nullptr;
@@ -100,10 +162,49 @@ void WebGPUContext::configure_surface(wgpu::TextureFormat preferred_format) {
     TR_CORE_INFO("Surface configured: {}x{} @ format {}", fb_width, fb_height, (i32)preferred_format);
 }
 
+bool WebGPUContext::set_present_mode(wgpu::PresentMode mode) {
+    if (std::find(m_supported_present_modes.begin(), m_supported_present_modes.end(), mode) == m_supported_present_modes.end()) {
+        TR_CORE_WARN("Present mode {} is not supported by the surface", mode);
+        return false;
+    }
+
+    m_requested_present_mode = mode;
+    return true;
+}
+
+void WebGPUContext::wait_for_frame_latency() {
+    PROFILE_FUNCTION();
+
+    if (m_props.max_frame_latency == 0)
+        return;
+
+    // Completion callbacks only fire from ProcessEvents. A lost device
+    // never completes anything, hence the bound on the wait.
+    const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    auto frames_in_flight = [this]() {
+        return m_frames_presented - std::max(m_frames_completed.load(), m_frames_abandoned);
+    };
+
+    m_instance.ProcessEvents();
+    while (frames_in_flight() >= m_props.max_frame_latency) {
+        if (std::chrono::steady_clock::now() > give_up) {
+            TR_CORE_WARN("Gave up waiting for the GPU to finish a frame");
+            m_frames_abandoned = m_frames_presented;
+            break;
+        }
+        sleep_for_ms(1);
+        m_instance.ProcessEvents();
+    }
+}
+
 wgpu::TextureView WebGPUContext::get_next_surface_view() {
     PROFILE_FUNCTION();
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    wait_for_frame_latency();
+
+    // The previous frame has been presented, so the surface is free to change.
+    if (m_requested_present_mode != m_present_mode)
+        configure_surface(m_surface_format);
 
     wgpu::SurfaceTexture surface_texture = {};
 
@@ -151,9 +252,13 @@ std::pair<u32, u32> WebGPUContext::get_framebuffer_size() {
 void WebGPUContext::swap_buffers() {
     PROFILE_FUNCTION();
 
-	// Present logic would go here
-	// In a real app, you'd acquire the next texture and render to it
-	m_surface.Present(); // Add this here
+	m_surface.Present();
+
+    // Every command buffer of the frame is submitted by now, so this fires
+    // once the GPU has finished the frame.
+    m_frames_presented++;
+    m_queue->get_native_queue().OnSubmittedWorkDone(wgpu::CallbackMode::AllowProcessEvents,
+        [this](wgpu::QueueWorkDoneStatus status) { m_frames_completed++; });
 }
 
 scope<WebGPUContext> WebGPUContext::create(const ContextProps& props) {
@@ -29,75 +29,20 @@ void sleep_for_ms(unsigned int milliseconds) {
     #endif
 }
 
-wgpu::Adapter request_adapter_sync(wgpu::Instance instance, wgpu::RequestAdapterOptions const* options) {
-	// A simple structure holding the local information shared with the
-	// onAdapterrequest_ended callback.
-	request_userdata<wgpu::Adapter> user_data;
-
-	// Callback called by wgpuInstanceRequestAdapter when the request returns
-	// This is a C++ lambda function, but could be any function defined in the
-	// global scope. It must be non-capturing (the brackets [] are empty) so
-	// that it behaves like a regular C function pointer, which is what
-	// wgpuInstanceRequestAdapter expects (WebGPU being a C API). The workaround
-	// is to convey what we want to capture through the pUserData pointer,
-	// provided as the last argument of wgpuInstanceRequestAdapter and received
-	// by the callback as its last argument.
-
-
-    instance.RequestAdapter(
-        options,
-        wgpu::CallbackMode::AllowProcessEvents,
-        [&user_data](wgpu::RequestAdapterStatus status, wgpu::Adapter adapter, const char* message) {
-            if (status == wgpu::RequestAdapterStatus::Success) {
-                user_data.result = adapter;
-            } else {
-                TR_CORE_ERROR("RequestAdapter failed: {}", message ? message : "No message");
-            }
-            user_data.request_ended = true;
-        });
-    
-    instance.ProcessEvents();
-    while (!user_data.request_ended) {
-        sleep_for_ms(200); // 200ms
-        instance.ProcessEvents();
-    }
-
-	TR_CORE_ASSERT(user_data.request_ended, "Request for adapter has not ended");
-
-    return user_data.result;
-
-}
-
-wgpu::Device request_device_sync(wgpu::Adapter adapter, wgpu::DeviceDescriptor const* descriptor) {
-
-    request_userdata<wgpu::Device> user_data;
-
-    adapter.RequestDevice(
-        descriptor,
-        wgpu::CallbackMode::AllowProcessEvents,
-        [&user_data](wgpu::RequestDeviceStatus status, wgpu::Device device, const char* message) {
-            if (status == wgpu::RequestDeviceStatus::Success) {
-                user_data.result = device;
-            } else {
-                TR_CORE_ERROR("RequestAdapter failed: {}", message ? message : "No message");
-            }
-            user_data.request_ended = true;
-        });
-
-    wgpu::Instance instance = adapter.GetInstance();
+void process_events_until(wgpu::Instance instance, const bool& done) {
+    PROFILE_FUNCTION();
 
     instance.ProcessEvents();
-    while (!user_data.request_ended) {
-        sleep_for_ms(200); // 200ms
+    while (!done) {
+    #ifdef __EMSCRIPTEN__
+        sleep_for_ms(1); // the browser only answers once we yield to it
+    #else
+        std::this_thread::yield();
+    #endif
         instance.ProcessEvents();
     }
-
-	TR_CORE_ASSERT(user_data.request_ended, "Request for device has not ended");
-
-    return user_data.result;
 }
 
-
 void inspect_adapter(wgpu::Adapter adapter) {
 #ifndef __EMSCRIPTEN__
 	wgpu::Limits supported_limits = {};
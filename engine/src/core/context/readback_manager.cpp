@@ -0,0 +1,261 @@
+#include "terra/core/context/readback_manager.h"
+#include "terra/renderer/gpu_counters.h"
+#include "terra/debug/profiler.h"
+
+namespace terra {
+
+static constexpr u32 ROW_ALIGNMENT = 256; // bytesPerRow of texture copies
+
+static u32 get_texel_size(wgpu::TextureFormat format) {
+    switch (format) {
+        case wgpu::TextureFormat::R8Unorm:
+        case wgpu::TextureFormat::R8Uint:
+            return 1;
+        case wgpu::TextureFormat::R16Float:
+        case wgpu::TextureFormat::Depth16Unorm:
+            return 2;
+        case wgpu::TextureFormat::RGBA8Unorm:
+        case wgpu::TextureFormat::RGBA8UnormSrgb:
+        case wgpu::TextureFormat::BGRA8Unorm:
+        case wgpu::TextureFormat::BGRA8UnormSrgb:
+        case wgpu::TextureFormat::R32Float:
+        case wgpu::TextureFormat::R32Uint:
+        case wgpu::TextureFormat::RG16Float:
+        case wgpu::TextureFormat::Depth32Float:
+            return 4;
+        case wgpu::TextureFormat::RGBA16Float:
+        case wgpu::TextureFormat::RGBA16Uint:
+        case wgpu::TextureFormat::RG32Float:
+            return 8;
+        case wgpu::TextureFormat::RGBA32Float:
+        case wgpu::TextureFormat::RGBA32Uint:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+static bool is_depth_format(wgpu::TextureFormat format) {
+    return format == wgpu::TextureFormat::Depth32Float || format == wgpu::TextureFormat::Depth16Unorm;
+}
+
+static u64 get_staging_size(u64 size) {
+    return std::bit_ceil(std::max(size, ReadbackManager::MIN_STAGING_SIZE));
+}
+
+// Copies the rows of a finished texture readback next to each other.
+static std::vector<u8> pack_rows(const ReadbackData& data, u32 row_size) {
+    std::vector<u8> packed;
+    if (!data.data) return packed;
+
+    packed.resize((u64) row_size * data.rows);
+    const u8* src = static_cast<const u8*>(data.data);
+    for (u32 row = 0; row < data.rows; ++row) {
+        std::memcpy(packed.data() + (u64) row * row_size, src + (u64) row * data.bytes_per_row, row_size);
+    }
+    return packed;
+}
+
+
+ReadbackManager::ReadbackManager(wgpu::Device device) : m_device(device), m_queue(device.GetQueue()) {}
+
+ReadbackManager::~ReadbackManager() {
+    // Destroying a buffer aborts its map, which runs the callback while the
+    // request it points at is still alive.
+    for (auto& request : m_pending) {
+        request->staging.Destroy();
+    }
+    m_pending.clear();
+    m_free.clear();
+}
+
+
+wgpu::Buffer ReadbackManager::acquire_staging(u64 size) {
+    auto it = m_free.find(size);
+    if (it != m_free.end() && !it->second.empty()) {
+        wgpu::Buffer buffer = it->second.back().buffer;
+        it->second.pop_back();
+        return buffer;
+    }
+
+    wgpu::BufferDescriptor desc = {};
+    desc.label = "Readback Staging Buffer";
+    desc.usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst;
+    desc.size = size;
+    desc.mappedAtCreation = false;
+
+    m_stats.staging_buffers++;
+    m_stats.staging_bytes += size;
+    GpuCounters::add_buffer();
+    return m_device.CreateBuffer(&desc);
+}
+
+void ReadbackManager::release_staging(wgpu::Buffer buffer, u64 size) {
+    m_free[size].push_back({ buffer, m_frame_index });
+}
+
+
+void ReadbackManager::submit(scope<Request> request, u64 copy_size, const std::function<void(wgpu::CommandEncoder, wgpu::Buffer)>& record) {
+    request->staging_size = get_staging_size(copy_size);
+    request->staging = acquire_staging(request->staging_size);
+
+    wgpu::CommandEncoderDescriptor encoder_desc = {};
+    encoder_desc.label = "Readback Encoder";
+    wgpu::CommandEncoder encoder = m_device.CreateCommandEncoder(&encoder_desc);
+    record(encoder, request->staging);
+    wgpu::CommandBuffer commands = encoder.Finish();
+    m_queue.Submit(1, &commands);
+
+    // Spontaneous, so the device tick in CommandQueue::poll is enough to
+    // complete it; the callback only flags the request, poll() handles it.
+    request->staging.MapAsync(
+        wgpu::MapMode::Read,
+        0,
+        copy_size,
+        wgpu::CallbackMode::AllowSpontaneous,
+        [](wgpu::MapAsyncStatus status, wgpu::StringView message, Request* request) {
+            if (status == wgpu::MapAsyncStatus::Success) {
+                request->state = State::Mapped;
+            } else {
+                TR_CORE_ERROR("Readback map failed. Status: {}, message: {}", (u32)status, message.data);
+                request->state = State::Failed;
+            }
+        },
+        request.get()
+    );
+
+    m_pending.push_back(std::move(request));
+    m_stats.pending = (u32) m_pending.size();
+}
+
+
+void ReadbackManager::read_buffer(wgpu::Buffer source, u64 offset, u64 size, ReadbackCallback callback) {
+    PROFILE_FUNCTION();
+
+    TR_CORE_ASSERT(source, "Readback source buffer is null");
+    TR_CORE_ASSERT(offset % 4 == 0 && size % 4 == 0, "Buffer readback offset and size must be multiples of 4");
+
+    auto request = create_scope<Request>();
+    request->data.size = size;
+    request->data.bytes_per_row = (u32) size;
+    request->data.rows = 1;
+    request->callback = std::move(callback);
+
+    submit(std::move(request), size, [&](wgpu::CommandEncoder encoder, wgpu::Buffer staging) {
+        encoder.CopyBufferToBuffer(source, offset, staging, 0, size);
+    });
+}
+
+std::future<std::vector<u8>> ReadbackManager::read_buffer(wgpu::Buffer source, u64 offset, u64 size) {
+    auto promise = std::make_shared<std::promise<std::vector<u8>>>();
+    std::future<std::vector<u8>> future = promise->get_future();
+
+    read_buffer(source, offset, size, [promise](const ReadbackData& data) {
+        std::vector<u8> bytes;
+        if (data.data) {
+            const u8* src = static_cast<const u8*>(data.data);
+            bytes.assign(src, src + data.size);
+        }
+        promise->set_value(std::move(bytes));
+    });
+
+    return future;
+}
+
+
+void ReadbackManager::read_texture(wgpu::Texture texture, wgpu::Origin3D origin, wgpu::Extent3D extent, u32 mip_level, ReadbackCallback callback) {
+    PROFILE_FUNCTION();
+
+    TR_CORE_ASSERT(texture, "Readback source texture is null");
+
+    const wgpu::TextureFormat format = texture.GetFormat();
+    const u32 texel_size = get_texel_size(format);
+    TR_CORE_ASSERT(texel_size != 0, "Texture format cannot be read back");
+
+    const u32 bytes_per_row = (extent.width * texel_size + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+    const u32 rows = extent.height * extent.depthOrArrayLayers;
+
+    auto request = create_scope<Request>();
+    request->data.size = (u64) bytes_per_row * rows;
+    request->data.bytes_per_row = bytes_per_row;
+    request->data.rows = rows;
+    request->callback = std::move(callback);
+
+    const u64 size = request->data.size;
+    submit(std::move(request), size, [&](wgpu::CommandEncoder encoder, wgpu::Buffer staging) {
+        wgpu::TexelCopyTextureInfo src = {};
+        src.texture = texture;
+        src.mipLevel = mip_level;
+        src.origin = origin;
+        src.aspect = is_depth_format(format) ? wgpu::TextureAspect::DepthOnly : wgpu::TextureAspect::All;
+
+        wgpu::TexelCopyBufferInfo dst = {};
+        dst.buffer = staging;
+        dst.layout.offset = 0;
+        dst.layout.bytesPerRow = bytes_per_row;
+        dst.layout.rowsPerImage = extent.height;
+
+        encoder.CopyTextureToBuffer(&src, &dst, &extent);
+    });
+}
+
+std::future<std::vector<u8>> ReadbackManager::read_texture(wgpu::Texture texture, wgpu::Origin3D origin, wgpu::Extent3D extent, u32 mip_level) {
+    auto promise = std::make_shared<std::promise<std::vector<u8>>>();
+    std::future<std::vector<u8>> future = promise->get_future();
+
+    const u32 row_size = extent.width * get_texel_size(texture.GetFormat());
+    read_texture(texture, origin, extent, mip_level, [promise, row_size](const ReadbackData& data) {
+        promise->set_value(pack_rows(data, row_size));
+    });
+
+    return future;
+}
+
+
+void ReadbackManager::poll() {
+    PROFILE_FUNCTION();
+
+    m_frame_index++;
+
+    // Callbacks may issue new requests, so finished ones are taken out first.
+    std::vector<scope<Request>> finished;
+    std::erase_if(m_pending, [&](scope<Request>& request) {
+        if (request->state.load() == State::Mapping) return false;
+        finished.push_back(std::move(request));
+        return true;
+    });
+    m_stats.pending = (u32) m_pending.size();
+
+    for (auto& request : finished) {
+        ReadbackData data = request->data;
+        const bool mapped = request->state.load() == State::Mapped;
+        if (mapped) {
+            data.data = request->staging.GetConstMappedRange(0, request->data.size);
+        }
+
+        if (request->callback) {
+            request->callback(data);
+        }
+
+        if (mapped) {
+            request->staging.Unmap();
+            release_staging(request->staging, request->staging_size);
+        } else {
+            m_stats.staging_buffers--;
+            m_stats.staging_bytes -= request->staging_size;
+        }
+    }
+
+    for (auto& [size, buffers] : m_free) {
+        std::erase_if(buffers, [&](const FreeBuffer& entry) {
+            if (entry.released_frame + RETIRE_FRAMES >= m_frame_index) return false;
+            entry.buffer.Destroy();
+            m_stats.staging_buffers--;
+            m_stats.staging_bytes -= size;
+            return true;
+        });
+    }
+    std::erase_if(m_free, [](const auto& entry) { return entry.second.empty(); });
+}
+
+} // namespace terra
@@ -0,0 +1,58 @@
+#include "terra/core/frame_limiter.h"
+#include "terra/debug/profiler.h"
+
+#include <thread>
+
+namespace terra {
+
+namespace {
+
+constexpr auto MIN_SPIN_MARGIN = std::chrono::microseconds(200);
+constexpr auto MAX_SPIN_MARGIN = std::chrono::microseconds(4000);
+
+} // namespace
+
+FrameLimiter::FrameLimiter(f32 target_fps) {
+    set_target_fps(target_fps);
+}
+
+void FrameLimiter::set_target_fps(f32 fps) {
+    m_target_fps = std::max(fps, 0.0f);
+    m_period = m_target_fps > 0.0f
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(1.0 / m_target_fps))
+        : Clock::duration{ 0 };
+    m_deadline = {};
+}
+
+void FrameLimiter::wait() {
+    PROFILE_FUNCTION();
+
+    if (m_period.count() == 0)
+        return;
+
+    Clock::time_point now = Clock::now();
+    if (m_deadline == Clock::time_point{} || now >= m_deadline) {
+        m_deadline = now + m_period;
+        return;
+    }
+
+    // Sleep in slices, so one long oversleep cannot blow the deadline.
+    while (m_deadline - now > m_spin_margin) {
+        const Clock::duration slice = std::min<Clock::duration>(m_deadline - now - m_spin_margin, std::chrono::milliseconds(4));
+        const Clock::time_point before = now;
+        std::this_thread::sleep_for(slice);
+        now = Clock::now();
+
+        // Track the worst recent overshoot, decaying slowly toward the floor.
+        const Clock::duration overshoot = (now - before) - slice;
+        m_spin_margin = std::clamp<Clock::duration>(std::max(overshoot + overshoot / 2, m_spin_margin - m_spin_margin / 64),
+            MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+    }
+
+    while (Clock::now() < m_deadline)
+        std::this_thread::yield();
+
+    m_deadline += m_period;
+}
+
+} // namespace terra
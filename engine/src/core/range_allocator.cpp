@@ -0,0 +1,78 @@
+#include "terrapch.h"
+#include "terra/core/range_allocator.h"
+#include "terra/core/assert.h"
+
+namespace terra {
+
+RangeAllocator::RangeAllocator(u64 capacity) : m_capacity(capacity) {
+    if (capacity > 0)
+        insert_block(0, capacity);
+}
+
+void RangeAllocator::insert_block(u64 offset, u64 size) {
+    auto by_size = m_by_size.emplace(size, offset);
+    m_by_offset.emplace(offset, std::make_pair(size, by_size));
+}
+
+void RangeAllocator::erase_block(std::map<u64, std::pair<u64, SizeIndex::iterator>>::iterator it) {
+    m_by_size.erase(it->second.second);
+    m_by_offset.erase(it);
+}
+
+u64 RangeAllocator::allocate(u64 size, u64 alignment) {
+    if (size == 0)
+        return INVALID_OFFSET;
+
+    // Smallest block that still fits once its start is aligned.
+    for (auto it = m_by_size.lower_bound(size); it != m_by_size.end(); ++it) {
+        const u64 block_offset = it->second;
+        const u64 block_size = it->first;
+        const u64 aligned = (block_offset + alignment - 1) / alignment * alignment;
+        const u64 padding = aligned - block_offset;
+        if (padding + size > block_size)
+            continue;
+
+        erase_block(m_by_offset.find(block_offset));
+
+        if (padding > 0)
+            insert_block(block_offset, padding);
+        if (padding + size < block_size)
+            insert_block(aligned + size, block_size - padding - size);
+
+        m_used += size;
+        return aligned;
+    }
+
+    return INVALID_OFFSET;
+}
+
+void RangeAllocator::free(u64 offset, u64 size) {
+    TR_CORE_ASSERT(offset + size <= m_capacity, "RangeAllocator::free out of range");
+
+    m_used -= size;
+
+    // Merge with the neighbouring free blocks on either side.
+    auto next = m_by_offset.lower_bound(offset);
+    if (next != m_by_offset.end() && next->first == offset + size) {
+        size += next->second.first;
+        next = std::next(next);
+        erase_block(std::prev(next));
+    }
+
+    if (next != m_by_offset.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second.first == offset) {
+            offset = prev->first;
+            size += prev->second.first;
+            erase_block(prev);
+        }
+    }
+
+    insert_block(offset, size);
+}
+
+u64 RangeAllocator::get_largest_free_block() const {
+    return m_by_size.empty() ? 0 : m_by_size.rbegin()->first;
+}
+
+} // namespace terra
@@ -0,0 +1,14 @@
+#include "terrapch.h"
+#include "terra/core/revision.h"
+
+#include <atomic>
+
+namespace terra {
+
+static std::atomic<u64> s_revision_counter{ 0 };
+
+u64 next_revision() {
+    return s_revision_counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+} // namespace terra
@@ -0,0 +1,112 @@
+#include "terra/core/thread_pool.h"
+#include "terra/debug/profiler.h"
+
+#include <atomic>
+
+namespace terra {
+
+ThreadPool::ThreadPool(u32 thread_count) {
+    if (thread_count == 0) {
+        u32 hw = std::thread::hardware_concurrency();
+        thread_count = hw > 1 ? hw - 1 : 1;
+    }
+
+    m_workers.reserve(thread_count);
+    for (u32 i = 0; i < thread_count; ++i)
+        m_workers.emplace_back([this, i]() {
+            PROFILE_THREAD("Worker " + std::to_string(i));
+            worker_loop();
+        });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_task_cv.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::get() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_task_cv.notify_one();
+}
+
+void ThreadPool::worker_loop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_task_cv.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+            if (m_stopping && m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            ++m_active;
+        }
+
+        task();
+
+        {
+            std::lock_guard lock(m_mutex);
+            --m_active;
+            if (m_active == 0 && m_tasks.empty())
+                m_idle_cv.notify_all();
+        }
+    }
+}
+
+void ThreadPool::wait_idle() {
+    std::unique_lock lock(m_mutex);
+    m_idle_cv.wait(lock, [this]() { return m_active == 0 && m_tasks.empty(); });
+}
+
+void ThreadPool::parallel_for(u32 count, const std::function<void(u32)>& fn) {
+    if (count == 0)
+        return;
+
+    struct State {
+        std::atomic<u32> next = 0;
+        std::atomic<u32> done = 0;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+
+    // Helpers that start after all indices are claimed exit without touching `fn`.
+    auto run = [state, count, &fn]() {
+        u32 finished = 0;
+        for (u32 i = state->next.fetch_add(1); i < count; i = state->next.fetch_add(1)) {
+            fn(i);
+            ++finished;
+        }
+        if (finished > 0 && state->done.fetch_add(finished) + finished == count) {
+            std::lock_guard lock(state->mutex);
+            state->cv.notify_all();
+        }
+    };
+
+    u32 helpers = std::min(get_thread_count(), count - 1);
+    for (u32 i = 0; i < helpers; ++i)
+        enqueue(run);
+
+    run();
+
+    std::unique_lock lock(state->mutex);
+    state->cv.wait(lock, [&]() { return state->done.load() == count; });
+}
+
+} // namespace terra
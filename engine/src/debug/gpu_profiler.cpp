@@ -0,0 +1,132 @@
+#include "terra/debug/gpu_profiler.h"
+#include "terra/debug/profiler.h"
+#include "terra/core/context/readback_manager.h"
+#include "terra/renderer/gpu_counters.h"
+
+namespace terra {
+
+static f64 cpu_now_us() {
+    return std::chrono::duration<f64, std::micro>(Profiler::Clock::now().time_since_epoch()).count();
+}
+
+
+GpuProfiler::GpuProfiler(wgpu::Device device, ReadbackManager& readback)
+    : m_device(device), m_readback(readback)
+{
+    if (!device.HasFeature(wgpu::FeatureName::TimestampQuery)) {
+        TR_CORE_INFO("TimestampQuery unavailable, GPU pass timings disabled");
+        return;
+    }
+
+    wgpu::QuerySetDescriptor query_desc = {};
+    query_desc.label = "GPU Profiler Timestamps";
+    query_desc.type = wgpu::QueryType::Timestamp;
+    query_desc.count = MAX_PASSES * 2;
+    m_query_set = device.CreateQuerySet(&query_desc);
+
+    wgpu::BufferDescriptor buffer_desc = {};
+    buffer_desc.label = "GPU Profiler Resolve Buffer";
+    buffer_desc.usage = wgpu::BufferUsage::QueryResolve | wgpu::BufferUsage::CopySrc;
+    buffer_desc.size = MAX_PASSES * 2 * sizeof(u64);
+    buffer_desc.mappedAtCreation = false;
+    m_resolve_buffer = device.CreateBuffer(&buffer_desc);
+    GpuCounters::add_buffer();
+
+    m_passes.reserve(MAX_PASSES);
+}
+
+GpuProfiler::~GpuProfiler() {
+    if (m_query_set) m_query_set.Destroy();
+    if (m_resolve_buffer) m_resolve_buffer.Destroy();
+}
+
+
+bool GpuProfiler::begin_pass(std::string_view name, wgpu::RenderPassTimestampWrites& writes) {
+    if (!m_query_set || m_passes.size() >= MAX_PASSES)
+        return false;
+
+    const u32 index = (u32) m_passes.size();
+    m_passes.push_back({ std::string(name), cpu_now_us() });
+
+    writes.querySet = m_query_set;
+    writes.beginningOfPassWriteIndex = index * 2;
+    writes.endOfPassWriteIndex = index * 2 + 1;
+    return true;
+}
+
+
+void GpuProfiler::end_frame() {
+    PROFILE_FUNCTION();
+
+    if (m_passes.empty())
+        return;
+
+    const u32 query_count = (u32) m_passes.size() * 2;
+
+    // The readback copies the resolved values out in its own submission, so
+    // next frame's resolve cannot overwrite them first.
+    wgpu::CommandEncoderDescriptor encoder_desc = {};
+    encoder_desc.label = "GPU Profiler Resolve";
+    wgpu::CommandEncoder encoder = m_device.CreateCommandEncoder(&encoder_desc);
+    encoder.ResolveQuerySet(m_query_set, 0, query_count, m_resolve_buffer, 0);
+    wgpu::CommandBuffer commands = encoder.Finish();
+    m_device.GetQueue().Submit(1, &commands);
+
+    m_readback.read_buffer(m_resolve_buffer, 0, query_count * sizeof(u64),
+        [this, passes = std::move(m_passes)](const ReadbackData& data) {
+            if (data.data)
+                on_resolved(passes, static_cast<const u64*>(data.data));
+        });
+
+    m_passes.clear();
+    m_passes.reserve(MAX_PASSES);
+}
+
+
+void GpuProfiler::on_resolved(const std::vector<Pass>& passes, const u64* timestamps) {
+    // Each window's smallest gap becomes the offset for the next one; the
+    // first window follows its running minimum.
+    for (u64 i = 0; i < passes.size(); ++i) {
+        const u64 begin = timestamps[i * 2];
+        if (begin == 0) continue;
+        m_window_offset_us = std::min(m_window_offset_us, begin / 1000.0 - passes[i].cpu_begin_us);
+    }
+    if (!m_calibrated)
+        m_clock_offset_us = m_window_offset_us;
+    if (++m_window_frames >= CALIBRATION_FRAMES) {
+        m_clock_offset_us = m_window_offset_us;
+        m_window_offset_us = std::numeric_limits<f64>::max();
+        m_window_frames = 0;
+        m_calibrated = true;
+    }
+
+    // Zero or reversed when the pass never ran or the GPU clock reset.
+    auto is_valid = [&](u64 i) { return timestamps[i * 2] != 0 && timestamps[i * 2 + 1] >= timestamps[i * 2]; };
+
+    u64 frame_begin = std::numeric_limits<u64>::max();
+    u64 frame_end = 0;
+    for (u64 i = 0; i < passes.size(); ++i) {
+        if (!is_valid(i)) continue;
+        frame_begin = std::min(frame_begin, timestamps[i * 2]);
+        frame_end = std::max(frame_end, timestamps[i * 2 + 1]);
+    }
+
+    m_last_frame.clear();
+    m_last_frame_ms = frame_end > frame_begin ? (frame_end - frame_begin) / 1e6 : 0.0;
+
+    for (u64 i = 0; i < passes.size(); ++i) {
+        if (!is_valid(i)) continue;
+        const u64 begin = timestamps[i * 2];
+        const u64 end = timestamps[i * 2 + 1];
+        m_last_frame.push_back({ passes[i].name, (begin - frame_begin) / 1e6, (end - begin) / 1e6 });
+
+    #if ENABLE_PROFILING
+        const f64 cpu_begin_us = begin / 1000.0 - m_clock_offset_us;
+        Profiler::Instrumentor::get().record_gpu(passes[i].name,
+            Profiler::microseconds_to_ticks(cpu_begin_us),
+            Profiler::microseconds_to_ticks(cpu_begin_us + (end - begin) / 1000.0));
+    #endif
+    }
+}
+
+} // namespace terra
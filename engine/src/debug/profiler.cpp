@@ -0,0 +1,562 @@
+#include "terra/debug/profiler.h"
+#include "terra/core/base.h"
+#include "terra/core/logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+// The perf_event counter code is kept for a Linux port: platform_detection.h
+// still rejects Linux, so no current build compiles or exercises it.
+#if defined(TR_PLATFORM_LINUX)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace Profiler {
+
+// .ttrace layout, little-endian (host order on every supported target):
+//
+//   header   "TTRC", u32 version, u64 ticks per second, u64 session start
+//            tick, u16 length + session name
+//   records  u8 tag, then
+//     NAME     u32 id, u16 length + name
+//     THREAD   u32 id, u16 length + name; a later record renames the track
+//     EVENTS   u32 thread, u32 count, count * Event; a counter event
+//              holds its time in start and its f64 value in end; hardware
+//              counter events follow the span they belong to
+//     DROPPED  u32 thread, u64 events lost to a full ring this session
+//
+// Names and threads are always written before the events that use them.
+// Flight recorder dumps use the same layout.
+// tools/ttrace_to_json.py converts a trace to Chrome's JSON format.
+static constexpr char     TRACE_MAGIC[4] = { 'T', 'T', 'R', 'C' };
+static constexpr uint32_t TRACE_VERSION  = 3;
+
+enum class RecordTag : uint8_t { Name = 1, Thread = 2, Events = 3, Dropped = 4 };
+
+static constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(5);
+
+template<typename T>
+static void write_value(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// When an event ended, in Clock ticks. Hardware counters carry no time of
+// their own and count as old as anything.
+static uint64_t get_end_ticks(const Event& event) {
+    switch (event.kind) {
+        case EventKind::Span:    return event.end;
+        case EventKind::Counter: return event.start;
+        default:                 return 0;
+    }
+}
+
+static void write_string(std::ofstream& out, std::string_view text) {
+    const uint16_t length = (uint16_t) std::min<size_t>(text.size(), UINT16_MAX);
+    write_value(out, length);
+    out.write(text.data(), length);
+}
+
+
+#if defined(TR_PLATFORM_LINUX)
+
+// In HARDWARE_COUNTER_NAMES order. User space only, which is also all
+// perf_event_paranoid 2 allows.
+static constexpr std::pair<uint32_t, uint64_t> PERF_COUNTERS[HARDWARE_COUNTERS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static int open_perf_counter(uint32_t type, uint64_t config, int leader) {
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = leader == -1; // the group starts once complete
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, leader, PERF_FLAG_FD_CLOEXEC);
+}
+
+// Opens what it can; counters the CPU or kernel lack read as zero.
+static void open_perf_group(ThreadBuffer& buffer) {
+    buffer.perf_opened = true;
+    buffer.perf_fds.fill(-1);
+    buffer.perf_slots.fill(-1);
+
+    int8_t slots = 0;
+    for (uint32_t i = 0; i < HARDWARE_COUNTERS; ++i) {
+        const int fd = open_perf_counter(PERF_COUNTERS[i].first, PERF_COUNTERS[i].second, buffer.perf_leader);
+        if (fd < 0) {
+            if (buffer.perf_leader < 0)
+                buffer.perf_error = errno;
+            continue;
+        }
+        if (buffer.perf_leader < 0)
+            buffer.perf_leader = fd;
+        buffer.perf_fds[i] = fd;
+        buffer.perf_slots[i] = slots++;
+    }
+
+    if (buffer.perf_leader >= 0) {
+        ioctl(buffer.perf_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(buffer.perf_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+#endif
+
+ThreadBuffer::~ThreadBuffer() {
+#if defined(TR_PLATFORM_LINUX)
+    if (!perf_opened)
+        return;
+    for (int fd : perf_fds)
+        if (fd >= 0) close(fd);
+#endif
+}
+
+
+Instrumentor::Instrumentor() {
+    m_gpu_buffer = std::make_shared<ThreadBuffer>(m_next_thread_id++, "GPU");
+    m_buffers.push_back(m_gpu_buffer);
+    m_thread_names[m_gpu_buffer->id] = m_gpu_buffer->name;
+    m_frame_name = intern("Frame");
+}
+
+Instrumentor::~Instrumentor() {
+    end_session();
+    disable_flight_recorder();
+    disable_live_view();
+}
+
+
+void Instrumentor::begin_session(const std::string& name, const std::string& filepath) {
+    end_session();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Whatever is pending predates the session.
+        drain_all();
+
+        output_stream.open(filepath, std::ios::binary | std::ios::trunc);
+        if (!output_stream.is_open())
+            return;
+
+        output_stream.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        write_value(output_stream, TRACE_VERSION);
+        write_value(output_stream, (uint64_t) (Clock::period::den / Clock::period::num));
+        write_value(output_stream, now_ticks());
+        write_string(output_stream, name);
+
+        for (auto& buffer : m_buffers)
+            buffer->dropped_written = buffer->get_dropped();
+        m_names_written = 0;
+        m_threads_written.clear();
+        m_session_open = true;
+    }
+    update_recording();
+}
+
+void Instrumentor::end_session() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!m_session_open)
+            return;
+
+        drain_all();
+        write_dropped();
+        output_stream.close();
+        m_session_open = false;
+    }
+    update_recording();
+}
+
+void Instrumentor::capture_frames(uint32_t frames, const std::string& filepath) {
+    if (frames == 0)
+        return;
+    if (is_capturing()) {
+        TR_CORE_WARN("Profiler: a frame capture is already under way, ignoring the request for {}", filepath);
+        return;
+    }
+    if (m_session_open)
+        TR_CORE_INFO("Profiler: a session is open, the {}-frame capture starts once it ends", frames);
+
+    m_capture_pending = true;
+    m_capture_frames = frames;
+    m_capture_path = filepath;
+}
+
+void Instrumentor::enable_flight_recorder(const FlightRecorderSettings& settings) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        m_flight = settings;
+        m_history.clear();
+        m_dump_requested = false;
+        m_last_dump = 0;
+    }
+    m_budget_ticks = microseconds_to_ticks(settings.frame_budget_ms * 1000.0);
+    m_last_frame = 0; // the frame in progress started before recording did
+    m_flight_enabled.store(true, std::memory_order_relaxed);
+    update_recording();
+}
+
+void Instrumentor::disable_flight_recorder() {
+    if (!m_flight_enabled.exchange(false, std::memory_order_relaxed))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        m_history.clear();
+        m_history.shrink_to_fit();
+        m_dump_requested = false;
+    }
+    update_recording();
+}
+
+bool Instrumentor::enable_hardware_counters() {
+#if defined(TR_PLATFORM_LINUX)
+    ThreadBuffer& buffer = thread_buffer();
+    if (!buffer.perf_opened)
+        open_perf_group(buffer);
+
+    if (buffer.perf_leader < 0) {
+        TR_CORE_WARN("Hardware counters unavailable: perf_event_open failed ({}); check /proc/sys/kernel/perf_event_paranoid", std::strerror(buffer.perf_error));
+        return false;
+    }
+
+    std::string opened;
+    for (uint32_t i = 0; i < HARDWARE_COUNTERS; ++i) {
+        if (buffer.perf_slots[i] < 0) continue;
+        opened += opened.empty() ? "" : ", ";
+        opened += HARDWARE_COUNTER_NAMES[i];
+    }
+    TR_CORE_INFO("Hardware counters on: {}", opened);
+
+    s_hardware.store(true, std::memory_order_relaxed);
+    return true;
+#else
+    TR_CORE_WARN("Hardware counters are only available on Linux");
+    return false;
+#endif
+}
+
+bool Instrumentor::read_hardware(HardwareSample& sample) {
+#if defined(TR_PLATFORM_LINUX)
+    ThreadBuffer& buffer = thread_buffer();
+    if (!buffer.perf_opened)
+        open_perf_group(buffer);
+    if (buffer.perf_leader < 0)
+        return false;
+
+    // PERF_FORMAT_GROUP layout with both time fields.
+    struct {
+        uint64_t count;
+        uint64_t time_enabled;
+        uint64_t time_running;
+        uint64_t values[HARDWARE_COUNTERS];
+    } group;
+    if (read(buffer.perf_leader, &group, sizeof(group)) <= 0)
+        return false;
+
+    for (uint32_t i = 0; i < HARDWARE_COUNTERS; ++i)
+        sample.values[i] = buffer.perf_slots[i] >= 0 ? group.values[buffer.perf_slots[i]] : 0;
+    sample.time_enabled = group.time_enabled;
+    sample.time_running = group.time_running;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Instrumentor::enable_live_view() {
+    m_live_enabled.store(true, std::memory_order_relaxed);
+    update_recording();
+}
+
+void Instrumentor::disable_live_view() {
+    if (!m_live_enabled.exchange(false, std::memory_order_relaxed))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        m_live.clear();
+        m_live.shrink_to_fit();
+    }
+    update_recording();
+}
+
+void Instrumentor::take_live_events(std::vector<ThreadEvent>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.insert(out.end(), m_live.begin(), m_live.end());
+    m_live.clear();
+}
+
+void Instrumentor::copy_names(std::vector<std::string>& names) {
+    std::lock_guard<std::mutex> lock(mutex);
+    names.insert(names.end(), m_names.begin() + (std::ptrdiff_t) std::min(names.size(), m_names.size()), m_names.end());
+}
+
+std::unordered_map<uint32_t, std::string> Instrumentor::get_thread_names() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return m_thread_names;
+}
+
+// Starts the writer when something consumes events and stops it when
+// nothing does.
+void Instrumentor::update_recording() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    const bool recording = m_session_open
+        || m_flight_enabled.load(std::memory_order_relaxed)
+        || m_live_enabled.load(std::memory_order_relaxed);
+    s_active.store(recording, std::memory_order_relaxed);
+
+    if (recording && !m_writer.joinable()) {
+        m_stopping = false;
+        m_writer = std::thread([this]() { writer_loop(); });
+    } else if (!recording && m_writer.joinable()) {
+        m_stopping = true;
+        lock.unlock();
+        m_writer_cv.notify_all();
+        m_writer.join();
+    }
+}
+
+
+void Instrumentor::mark_frame() {
+    const uint64_t now = now_ticks();
+    const uint64_t last = m_last_frame;
+    m_last_frame = now;
+
+    if (is_active() && last != 0) {
+        record(m_frame_name, last, now);
+
+        if (m_flight_enabled.load(std::memory_order_relaxed) && now - last > m_budget_ticks) {
+            const double ms = std::chrono::duration<double, std::milli>(Clock::duration(now - last)).count();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                const uint64_t spacing = microseconds_to_ticks(m_flight.history_seconds * 1e6);
+                if (!m_dump_requested && (m_last_dump == 0 || now - m_last_dump >= spacing)) {
+                    m_dump_requested = true;
+                    m_dump_frame_ms = ms;
+                    m_last_dump = now;
+                }
+            }
+            m_writer_cv.notify_all();
+        }
+    }
+
+    // A capture covers the frames between the boundary it starts on and
+    // the one `frames` boundaries later.
+    if (m_capture_remaining > 0 && --m_capture_remaining == 0) {
+        end_session();
+    } else if (m_capture_pending && !m_session_open) {
+        m_capture_pending = false;
+        begin_session("Frame Capture", m_capture_path);
+        m_capture_remaining = m_session_open ? m_capture_frames : 0;
+        m_last_frame = now;
+    }
+}
+
+
+uint32_t Instrumentor::intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto [it, inserted] = m_name_ids.try_emplace(std::string(name), (uint32_t) m_names.size());
+    if (inserted)
+        m_names.push_back(it->first);
+    return it->second;
+}
+
+void Instrumentor::record_gpu(std::string_view name, uint64_t start, uint64_t end) {
+    if (!is_active())
+        return;
+    m_gpu_buffer->push({ start, end, intern(name), EventKind::Span });
+}
+
+void Instrumentor::set_thread_name(std::string_view name) {
+    ThreadBuffer& buffer = thread_buffer();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.name = name;
+    m_thread_names[buffer.id] = buffer.name;
+    std::erase(m_threads_written, buffer.id);
+}
+
+std::shared_ptr<ThreadBuffer> Instrumentor::register_thread() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const uint32_t id = m_next_thread_id++;
+    auto buffer = std::make_shared<ThreadBuffer>(id, "Thread " + std::to_string(id));
+    m_buffers.push_back(buffer);
+    m_thread_names[id] = buffer->name;
+    return buffer;
+}
+
+
+void Instrumentor::writer_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!m_stopping) {
+        m_writer_cv.wait_for(lock, DRAIN_INTERVAL, [this]() { return m_stopping || m_dump_requested; });
+        drain_all();
+
+        if (m_dump_requested) {
+            dump_history();
+            m_dump_requested = false;
+        }
+    }
+}
+
+void Instrumentor::write_names() {
+    for (; m_names_written < m_names.size(); ++m_names_written) {
+        write_value(output_stream, RecordTag::Name);
+        write_value(output_stream, (uint32_t) m_names_written);
+        write_string(output_stream, m_names[m_names_written]);
+    }
+}
+
+void Instrumentor::write_thread(const ThreadBuffer& buffer) {
+    if (std::find(m_threads_written.begin(), m_threads_written.end(), buffer.id) != m_threads_written.end())
+        return;
+
+    write_value(output_stream, RecordTag::Thread);
+    write_value(output_stream, buffer.id);
+    write_string(output_stream, buffer.name);
+    m_threads_written.push_back(buffer.id);
+}
+
+void Instrumentor::write_dropped() {
+    for (auto& buffer : m_buffers) {
+        const uint64_t dropped = buffer->get_dropped();
+        if (dropped <= buffer->dropped_written)
+            continue;
+
+        write_thread(*buffer);
+        write_value(output_stream, RecordTag::Dropped);
+        write_value(output_stream, buffer->id);
+        write_value(output_stream, dropped - buffer->dropped_written);
+        buffer->dropped_written = dropped;
+    }
+}
+
+// Hands every pending event to the open session, the flight recorder and
+// the live view; with none of them, they are discarded.
+void Instrumentor::drain_all() {
+    const bool flight = m_flight_enabled.load(std::memory_order_relaxed);
+    const bool live = m_live_enabled.load(std::memory_order_relaxed);
+
+    for (auto& buffer : m_buffers) {
+        buffer->drain([&](const Event* events, uint64_t count) {
+            if (m_session_open) {
+                // Names are interned before the events that use them are pushed.
+                write_names();
+                write_thread(*buffer);
+
+                write_value(output_stream, RecordTag::Events);
+                write_value(output_stream, buffer->id);
+                write_value(output_stream, (uint32_t) count);
+                output_stream.write(reinterpret_cast<const char*>(events), (std::streamsize) (count * sizeof(Event)));
+            }
+            if (flight) {
+                for (uint64_t i = 0; i < count; ++i)
+                    m_history.push_back({ events[i], buffer->id });
+            }
+            if (live) {
+                for (uint64_t i = 0; i < count; ++i)
+                    m_live.push_back({ events[i], buffer->id });
+            }
+        });
+    }
+
+    if (m_live.size() > MAX_LIVE_EVENTS)
+        m_live.erase(m_live.begin(), m_live.begin() + (std::ptrdiff_t) (m_live.size() - MAX_LIVE_EVENTS / 2));
+
+    if (flight)
+        trim_history();
+
+    // Threads that have exited leave the writer holding the last reference.
+    std::erase_if(m_buffers, [](const std::shared_ptr<ThreadBuffer>& buffer) { return buffer.use_count() == 1; });
+}
+
+void Instrumentor::trim_history() {
+    const uint64_t window = microseconds_to_ticks(m_flight.history_seconds * 1e6);
+    const uint64_t now = now_ticks();
+    const uint64_t cutoff = now > window ? now - window : 0;
+
+    // Drained roughly in time order, which is close enough for trimming.
+    while (!m_history.empty() && (get_end_ticks(m_history.front().event) < cutoff || m_history.size() > m_flight.max_events))
+        m_history.pop_front();
+}
+
+void Instrumentor::dump_history() {
+    if (m_history.empty())
+        return;
+
+    char stamp[32];
+    const std::time_t time = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&time));
+    const std::string path = m_flight.output_directory + "/flight_" + stamp + ".ttrace";
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        TR_CORE_ERROR("Flight recorder could not write {}", path);
+        return;
+    }
+
+    uint64_t start = UINT64_MAX;
+    for (const ThreadEvent& entry : m_history) {
+        if (entry.event.kind != EventKind::Hardware)
+            start = std::min(start, entry.event.start);
+    }
+
+    out.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    write_value(out, TRACE_VERSION);
+    write_value(out, (uint64_t) (Clock::period::den / Clock::period::num));
+    write_value(out, start);
+    write_string(out, "Flight Recorder");
+
+    for (uint32_t id = 0; id < (uint32_t) m_names.size(); ++id) {
+        write_value(out, RecordTag::Name);
+        write_value(out, id);
+        write_string(out, m_names[id]);
+    }
+    for (const auto& [id, name] : m_thread_names) {
+        write_value(out, RecordTag::Thread);
+        write_value(out, id);
+        write_string(out, name);
+    }
+
+    // One record per run of events from the same thread.
+    std::vector<Event> run;
+    uint32_t run_thread = m_history.front().thread;
+    auto flush_run = [&]() {
+        if (run.empty()) return;
+        write_value(out, RecordTag::Events);
+        write_value(out, run_thread);
+        write_value(out, (uint32_t) run.size());
+        out.write(reinterpret_cast<const char*>(run.data()), (std::streamsize) (run.size() * sizeof(Event)));
+        run.clear();
+    };
+    for (const ThreadEvent& entry : m_history) {
+        if (entry.thread != run_thread) {
+            flush_run();
+            run_thread = entry.thread;
+        }
+        run.push_back(entry.event);
+    }
+    flush_run();
+
+    TR_CORE_WARN("Frame took {:.1f} ms; flight recorder saved the last {:.1f} s to {}",
+        m_dump_frame_ms, m_flight.history_seconds, path);
+}
+
+} // namespace Profiler
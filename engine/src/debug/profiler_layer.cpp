@@ -0,0 +1,371 @@
+#include "terra/debug/profiler_layer.h"
+#include "terra/input/key_codes.h"
+
+#include <imgui.h>
+
+namespace terra {
+
+static constexpr f64 TICKS_PER_MS = (f64) Profiler::Clock::period::den / Profiler::Clock::period::num / 1000.0;
+static constexpr f32 FRAME_BUDGET_MS = 1000.0f / 60.0f;
+
+static f64 ticks_to_ms(u64 ticks) {
+    return (f64) ticks / TICKS_PER_MS;
+}
+
+static ImU32 get_frame_color(f32 ms) {
+    if (ms <= FRAME_BUDGET_MS)        return IM_COL32(90, 190, 90, 255);
+    if (ms <= FRAME_BUDGET_MS * 2.0f) return IM_COL32(220, 190, 60, 255);
+    return IM_COL32(220, 80, 70, 255);
+}
+
+// Stable per name, so a scope keeps its colour from frame to frame.
+static ImU32 get_scope_color(u32 name) {
+    const f32 hue = (f32) ((name * 2654435761u) >> 8 & 0xFFFF) / 65535.0f;
+    return ImColor::HSV(hue, 0.45f, 0.75f);
+}
+
+static f64 get_percentile(const std::vector<f32>& sorted, f64 percentile) {
+    if (sorted.empty()) return 0.0;
+    const size_t index = std::min(sorted.size() - 1, (size_t) (percentile * (f64) (sorted.size() - 1) + 0.5));
+    return sorted[index];
+}
+
+
+void ProfilerLayer::on_detach() {
+    Profiler::Instrumentor::get().disable_live_view();
+}
+
+void ProfilerLayer::on_event(Event& event) {
+    EventDispatcher dispatcher(event);
+    dispatcher.dispatch<KeyPressedEvent>(TR_BIND_EVENT_FN(ProfilerLayer::on_key_pressed));
+}
+
+bool ProfilerLayer::on_key_pressed(KeyPressedEvent& e) {
+    if (e.get_key_code() != Key::F10 || e.get_repeat_count() != 0)
+        return false;
+
+    set_open(!m_open);
+    return true;
+}
+
+void ProfilerLayer::set_open(bool open) {
+    m_open = open;
+    if (m_open && !m_paused)
+        Profiler::Instrumentor::get().enable_live_view();
+    else
+        Profiler::Instrumentor::get().disable_live_view();
+}
+
+void ProfilerLayer::set_paused(bool paused) {
+    m_paused = paused;
+    set_open(m_open);
+}
+
+
+void ProfilerLayer::collect_events() {
+    Profiler::Instrumentor& instrumentor = Profiler::Instrumentor::get();
+    if (!instrumentor.is_live_view_enabled())
+        return;
+
+    m_incoming.clear();
+    instrumentor.take_live_events(m_incoming);
+    m_takes.push_back({ Profiler::now_ticks(), m_first_event + m_events.size() });
+
+    const u32 frame_name = instrumentor.get_frame_name();
+    bool new_names = false;
+    bool new_threads = false;
+    for (const Profiler::ThreadEvent& e : m_incoming) {
+        if (e.event.kind == Profiler::EventKind::Span && e.event.name == frame_name)
+            m_frames.push_back({ e.event.start, e.event.end });
+        else
+            m_events.push_back(e);
+
+        new_names |= e.event.name >= m_names.size();
+        new_threads |= !m_thread_names.contains(e.thread);
+    }
+    if (new_names)
+        instrumentor.copy_names(m_names);
+    if (new_threads)
+        m_thread_names = instrumentor.get_thread_names();
+
+    while (m_frames.size() > HISTORY_FRAMES)
+        m_frames.pop_front();
+    if (m_frames.empty())
+        return;
+
+    // An event is collected after it ends, so anything collected before the
+    // oldest frame began lies outside every frame kept.
+    const u64 oldest = m_frames.front().start;
+    while (!m_takes.empty() && m_takes.front().time < oldest)
+        m_takes.pop_front();
+
+    const u64 keep = m_takes.empty() ? m_first_event + m_events.size() : m_takes.front().first_event;
+    while (m_first_event < keep) {
+        m_events.pop_front();
+        m_first_event++;
+    }
+}
+
+void ProfilerLayer::build_view(u32 index) {
+    const Frame& frame = m_frames[index];
+    const u64 collected = m_first_event + m_events.size();
+    if (frame.start == m_view_frame.start && collected == m_view_events)
+        return;
+
+    m_view_frame = frame;
+    m_view_events = collected;
+    m_tracks.clear();
+    m_scopes.clear();
+
+    // The frame's events were all collected after it began.
+    auto take = std::lower_bound(m_takes.begin(), m_takes.end(), frame.start,
+        [](const Take& t, u64 time) { return t.time < time; });
+    if (take == m_takes.end())
+        return;
+
+    const u32 gpu_thread = Profiler::Instrumentor::get().get_gpu_thread();
+    for (u64 i = take->first_event - m_first_event; i < m_events.size(); ++i) {
+        const Profiler::ThreadEvent& e = m_events[i];
+        if (e.event.kind != Profiler::EventKind::Span) continue;
+        if (e.event.start >= frame.end || e.event.end <= frame.start) continue;
+
+        auto track = std::find_if(m_tracks.begin(), m_tracks.end(), [&](const Track& t) { return t.thread == e.thread; });
+        if (track == m_tracks.end())
+            track = m_tracks.insert(m_tracks.end(), { e.thread, 0, {} });
+        track->spans.push_back({ std::max(e.event.start, frame.start), std::min(e.event.end, frame.end), e.event.name, 0 });
+    }
+
+    // Threads in the order they were first seen, the GPU last.
+    std::sort(m_tracks.begin(), m_tracks.end(), [&](const Track& a, const Track& b) {
+        if ((a.thread == gpu_thread) != (b.thread == gpu_thread)) return b.thread == gpu_thread;
+        return a.thread < b.thread;
+    });
+
+    std::unordered_map<u32, ScopeStats> scopes;
+    std::vector<u32> stack;
+    std::vector<f64> exclusive;
+    for (Track& track : m_tracks) {
+        // Parents before their children.
+        std::sort(track.spans.begin(), track.spans.end(), [](const Span& a, const Span& b) {
+            return a.start != b.start ? a.start < b.start : a.end > b.end;
+        });
+
+        stack.clear();
+        exclusive.resize(track.spans.size());
+        for (u32 i = 0; i < track.spans.size(); ++i) {
+            Span& span = track.spans[i];
+            while (!stack.empty() && track.spans[stack.back()].end <= span.start)
+                stack.pop_back();
+
+            const f64 ms = ticks_to_ms(span.end - span.start);
+            exclusive[i] = ms;
+            if (!stack.empty())
+                exclusive[stack.back()] -= ms;
+
+            span.depth = (u32) stack.size();
+            track.depth = std::max(track.depth, span.depth + 1);
+            stack.push_back(i);
+        }
+
+        // GPU passes run on another clock; the tables compare CPU time only.
+        if (track.thread == gpu_thread) continue;
+
+        for (u32 i = 0; i < track.spans.size(); ++i) {
+            ScopeStats& stats = scopes[track.spans[i].name];
+            stats.name = track.spans[i].name;
+            stats.calls++;
+            stats.inclusive_ms += ticks_to_ms(track.spans[i].end - track.spans[i].start);
+            stats.exclusive_ms += std::max(exclusive[i], 0.0);
+        }
+    }
+
+    m_scopes.reserve(scopes.size());
+    for (const auto& [name, stats] : scopes)
+        m_scopes.push_back(stats);
+}
+
+const char* ProfilerLayer::get_name(u32 name) const {
+    return name < m_names.size() ? m_names[name].c_str() : "?";
+}
+
+
+void ProfilerLayer::on_ui_render() {
+    if (!m_open)
+        return;
+
+    collect_events();
+
+    bool open = true;
+    ImGui::SetNextWindowSize(ImVec2(900, 700), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Profiler", &open)) {
+        if (ImGui::Button(m_paused ? "Resume" : "Pause"))
+            set_paused(!m_paused);
+        ImGui::SameLine();
+        ImGui::TextDisabled("F10 to close, click a frame to inspect it");
+
+        if (m_frames.empty()) {
+            ImGui::TextUnformatted("Waiting for frames...");
+        } else {
+            if (!m_paused)
+                m_selected = (u32) m_frames.size() - 1 - std::min<u32>((u32) m_frames.size() - 1, LIVE_LAG_FRAMES);
+            m_selected = std::min(m_selected, (u32) m_frames.size() - 1);
+            build_view(m_selected);
+
+            if (ImGui::CollapsingHeader("Frame Times", ImGuiTreeNodeFlags_DefaultOpen))
+                draw_frame_times();
+            if (ImGui::CollapsingHeader("Flame Graph", ImGuiTreeNodeFlags_DefaultOpen))
+                draw_flame_graph();
+            if (ImGui::CollapsingHeader("Top Scopes", ImGuiTreeNodeFlags_DefaultOpen)) {
+                ImGui::TextUnformatted("By inclusive time");
+                draw_scope_table("##inclusive", false);
+                ImGui::TextUnformatted("By exclusive time");
+                draw_scope_table("##exclusive", true);
+            }
+        }
+    }
+    ImGui::End();
+
+    if (!open)
+        set_open(false);
+}
+
+void ProfilerLayer::draw_frame_times() {
+    std::vector<f32> times;
+    times.reserve(m_frames.size());
+    for (const Frame& frame : m_frames)
+        times.push_back((f32) ticks_to_ms(frame.end - frame.start));
+
+    std::vector<f32> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    f64 total = 0.0;
+    for (f32 ms : times) total += ms;
+
+    ImGui::Text("%u frames  avg %.2f ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f",
+        (u32) times.size(), total / times.size(),
+        get_percentile(sorted, 0.50), get_percentile(sorted, 0.95), get_percentile(sorted, 0.99), sorted.back());
+
+    // Scaled to the 99th percentile, so one hitch does not flatten the rest.
+    const f32 scale = std::max((f32) get_percentile(sorted, 0.99) * 1.25f, FRAME_BUDGET_MS * 1.5f);
+
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const ImVec2 size(std::max(ImGui::GetContentRegionAvail().x, 100.0f), 100.0f);
+    const f32 bar_width = size.x / HISTORY_FRAMES;
+
+    ImGui::InvisibleButton("##frame_times", size);
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    draw_list->AddRectFilled(origin, origin + size, IM_COL32(30, 30, 30, 255));
+
+    for (u32 i = 0; i < times.size(); ++i) {
+        const f32 x = origin.x + (HISTORY_FRAMES - times.size() + i) * bar_width;
+        const f32 height = std::min(times[i] / scale, 1.0f) * size.y;
+        draw_list->AddRectFilled(ImVec2(x, origin.y + size.y - height), ImVec2(x + std::max(bar_width - 1.0f, 1.0f), origin.y + size.y),
+            i == m_selected ? IM_COL32(255, 255, 255, 255) : get_frame_color(times[i]));
+    }
+
+    const f32 budget_y = origin.y + size.y - FRAME_BUDGET_MS / scale * size.y;
+    draw_list->AddLine(ImVec2(origin.x, budget_y), ImVec2(origin.x + size.x, budget_y), IM_COL32(255, 255, 255, 80));
+
+    if (ImGui::IsItemHovered()) {
+        const i32 slot = (i32) ((ImGui::GetIO().MousePos.x - origin.x) / bar_width);
+        const i32 index = slot - (i32) (HISTORY_FRAMES - times.size());
+        if (index >= 0 && index < (i32) times.size()) {
+            ImGui::SetTooltip("%.2f ms", times[index]);
+            if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+                set_paused(true);
+                m_selected = (u32) index;
+            }
+        }
+    }
+
+    if (m_paused) {
+        i32 selected = (i32) m_selected;
+        if (ImGui::SliderInt("Frame", &selected, 0, (i32) times.size() - 1))
+            m_selected = (u32) selected;
+    }
+}
+
+void ProfilerLayer::draw_flame_graph() {
+    const f64 frame_ms = ticks_to_ms(m_view_frame.end - m_view_frame.start);
+    ImGui::Text("Frame %.2f ms", frame_ms);
+
+    if (m_tracks.empty()) {
+        ImGui::TextDisabled("No scopes recorded in this frame");
+        return;
+    }
+
+    const f32 row_height = ImGui::GetTextLineHeight() + 4.0f;
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const f32 width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+    const f64 frame_ticks = (f64) std::max<u64>(m_view_frame.end - m_view_frame.start, 1);
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    f32 y = origin.y;
+    const Span* hovered = nullptr;
+
+    for (const Track& track : m_tracks) {
+        auto name = m_thread_names.find(track.thread);
+        draw_list->AddText(ImVec2(origin.x, y), IM_COL32(200, 200, 200, 255),
+            name != m_thread_names.end() ? name->second.c_str() : "Thread");
+        y += row_height;
+
+        for (const Span& span : track.spans) {
+            const f32 x0 = origin.x + (f32) ((span.start - m_view_frame.start) / frame_ticks * width);
+            const f32 x1 = std::max(origin.x + (f32) ((span.end - m_view_frame.start) / frame_ticks * width), x0 + 1.0f);
+            const f32 y0 = y + span.depth * row_height;
+            const ImVec2 min(x0, y0);
+            const ImVec2 max(x1, y0 + row_height - 1.0f);
+
+            draw_list->AddRectFilled(min, max, get_scope_color(span.name));
+            if (x1 - x0 > 20.0f) {
+                draw_list->PushClipRect(min, max, true);
+                draw_list->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), get_name(span.name));
+                draw_list->PopClipRect();
+            }
+
+            if (mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+                hovered = &span;
+        }
+        y += track.depth * row_height + 4.0f;
+    }
+
+    ImGui::Dummy(ImVec2(width, y - origin.y));
+    if (hovered && ImGui::IsWindowHovered())
+        ImGui::SetTooltip("%s\n%.3f ms", get_name(hovered->name), ticks_to_ms(hovered->end - hovered->start));
+}
+
+void ProfilerLayer::draw_scope_table(const char* id, bool by_exclusive) {
+    std::vector<const ScopeStats*> top;
+    top.reserve(m_scopes.size());
+    for (const ScopeStats& stats : m_scopes)
+        top.push_back(&stats);
+
+    const size_t count = std::min<size_t>(top.size(), TOP_SCOPES);
+    std::partial_sort(top.begin(), top.begin() + count, top.end(), [&](const ScopeStats* a, const ScopeStats* b) {
+        return by_exclusive ? a->exclusive_ms > b->exclusive_ms : a->inclusive_ms > b->inclusive_ms;
+    });
+
+    if (!ImGui::BeginTable(id, 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+        return;
+
+    ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch, 6.0f);
+    ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthStretch, 1.0f);
+    ImGui::TableSetupColumn("Inclusive ms", ImGuiTableColumnFlags_WidthStretch, 1.5f);
+    ImGui::TableSetupColumn("Exclusive ms", ImGuiTableColumnFlags_WidthStretch, 1.5f);
+    ImGui::TableHeadersRow();
+
+    for (size_t i = 0; i < count; ++i) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(get_name(top[i]->name));
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", top[i]->calls);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", top[i]->inclusive_ms);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", top[i]->exclusive_ms);
+    }
+    ImGui::EndTable();
+}
+
+} // namespace terra
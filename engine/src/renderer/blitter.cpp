@@ -0,0 +1,73 @@
+#include "terra/renderer/blitter.h"
+#include "terra/renderer/gpu_counters.h"
+#include "terra/renderer/renderer_api.h"
+#include "terra/debug/profiler.h"
+#include "terra/helpers/string.h"
+
+namespace terra {
+
+Blitter::Blitter(WebGPUContext& context, wgpu::TextureFormat target_format)
+    : m_context(context), m_target_format(target_format) {
+    PROFILE_FUNCTION();
+
+    const auto& device = m_context.get_native_device();
+    m_shader = RendererAPI::create_shader("shaders/blit.wgsl", "Blit Shader");
+
+    wgpu::BindGroupLayoutEntry entry = {};
+    entry.binding = 0;
+    entry.visibility = wgpu::ShaderStage::Fragment;
+    entry.texture.sampleType = wgpu::TextureSampleType::UnfilterableFloat;
+    entry.texture.viewDimension = wgpu::TextureViewDimension::e2D;
+
+    wgpu::BindGroupLayoutDescriptor bgl_desc = {};
+    bgl_desc.label = "Blit Bind Group Layout";
+    bgl_desc.entryCount = 1;
+    bgl_desc.entries = &entry;
+    m_bind_group_layout = device.CreateBindGroupLayout(&bgl_desc);
+
+    wgpu::PipelineLayoutDescriptor layout_desc = {};
+    layout_desc.bindGroupLayoutCount = 1;
+    layout_desc.bindGroupLayouts = &m_bind_group_layout;
+
+    wgpu::ColorTargetState color_target = {};
+    color_target.format = target_format;
+
+    wgpu::FragmentState fs = {};
+    fs.module = m_shader->module();
+    fs.entryPoint = to_wgpu_string_view(m_shader->fragment_entry);
+    fs.targetCount = 1;
+    fs.targets = &color_target;
+
+    wgpu::RenderPipelineDescriptor desc = {};
+    desc.label = "Blit Pipeline";
+    desc.layout = device.CreatePipelineLayout(&layout_desc);
+    desc.vertex.module = m_shader->module();
+    desc.vertex.entryPoint = to_wgpu_string_view(m_shader->vertex_entry);
+    desc.primitive.topology = wgpu::PrimitiveTopology::TriangleList;
+    desc.fragment = &fs;
+
+    m_pipeline = device.CreateRenderPipeline(&desc);
+}
+
+void Blitter::draw(wgpu::RenderPassEncoder pass, wgpu::TextureView source) {
+    if (!m_bind_group || m_bound_source.Get() != source.Get()) {
+        wgpu::BindGroupEntry entry = {};
+        entry.binding = 0;
+        entry.textureView = source;
+
+        wgpu::BindGroupDescriptor desc = {};
+        desc.label = "Blit Bind Group";
+        desc.layout = m_bind_group_layout;
+        desc.entryCount = 1;
+        desc.entries = &entry;
+        m_bind_group = m_context.get_native_device().CreateBindGroup(&desc);
+        GpuCounters::add_bind_group();
+        m_bound_source = source;
+    }
+
+    pass.SetPipeline(m_pipeline);
+    pass.SetBindGroup(0, m_bind_group, 0, nullptr);
+    pass.Draw(3, 1, 0, 0);
+}
+
+} // namespace terra
@@ -6,6 +6,7 @@
 #include "terra/core/context/context.h"
 #include "terra/core/context/command_queue.h"
 #include "terra/renderer/buffer.h"
+#include "terra/renderer/gpu_counters.h"
 #include "terra/helpers/string.h"
 #include "terra/helpers/user_data.h"
 
@@ -47,15 +48,14 @@ void fetch_buffer_data_sync(wgpu::Instance instance, wgpu::Buffer bufferB, std::
 	// 	callback_info
 	// );
 
-    instance.ProcessEvents();
-	while (!user_data.request_ended) {
-		sleep_for_ms(200);
-		instance.ProcessEvents();
-	}
+    // Blocks until mapped; per-frame readbacks should go through the
+    // CommandQueue's ReadbackManager instead.
+    process_events_until(instance, user_data.request_ended);
 	
 	if (user_data.result) {
         const void* buffer_data = bufferB.GetConstMappedRange(0, WGPU_WHOLE_MAP_SIZE);
 		process_buffer_data(buffer_data);
+		bufferB.Unmap();
 	}
 
 }
@@ -68,9 +68,11 @@ wgpu::Buffer Buffer::create(wgpu::Device device, wgpu::Queue queue, const void *
     desc.label = label ? label : "Unnamed Buffer";
 
     wgpu::Buffer buffer = device.CreateBuffer(&desc);
+    GpuCounters::add_buffer();
 
     if (data) {
         queue.WriteBuffer(buffer, 0, data, size);
+        GpuCounters::add_upload(size);
     }
 
     return buffer;
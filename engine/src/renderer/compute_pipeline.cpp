@@ -0,0 +1,81 @@
+#include "terra/renderer/compute_pipeline.h"
+#include "terra/renderer/gpu_counters.h"
+#include "terra/core/logger.h"
+#include "terra/debug/profiler.h"
+#include "terra/helpers/string.h"
+
+namespace terra {
+
+ComputePipeline::ComputePipeline(WebGPUContext& context, const ComputePipelineSpecification& spec)
+    : m_spec(spec), m_context(context) {
+    create_pipeline(spec);
+}
+
+ComputePipeline::~ComputePipeline() {}
+
+void ComputePipeline::bind(wgpu::ComputePassEncoder compute_pass) const {
+    if (!m_pipeline) {
+        TR_CORE_ERROR("Tried to bind a null compute pipeline!");
+        return;
+    }
+
+    compute_pass.SetPipeline(m_pipeline);
+    GpuCounters::add_pipeline_bind();
+}
+
+void ComputePipeline::create_pipeline(const ComputePipelineSpecification& spec) {
+    PROFILE_FUNCTION();
+
+    TR_CORE_ASSERT(spec.shader, "Compute pipeline needs a shader");
+
+    const auto& device = m_context.get_native_device();
+
+    for (const auto& group : spec.groups) {
+        std::vector<wgpu::BindGroupLayoutEntry> entries;
+        for (const ComputeBindingSpec& binding : group) {
+            wgpu::BindGroupLayoutEntry entry = {};
+            entry.binding = binding.binding;
+            entry.visibility = wgpu::ShaderStage::Compute;
+
+            switch (binding.kind) {
+            case ComputeBindingKind::Buffer:
+                entry.buffer.type = binding.buffer_type;
+                entry.buffer.minBindingSize = binding.min_size;
+                break;
+            case ComputeBindingKind::Texture:
+                entry.texture.sampleType = binding.sample_type;
+                entry.texture.viewDimension = wgpu::TextureViewDimension::e2D;
+                break;
+            case ComputeBindingKind::StorageTexture:
+                entry.storageTexture.access = wgpu::StorageTextureAccess::WriteOnly;
+                entry.storageTexture.format = binding.storage_format;
+                entry.storageTexture.viewDimension = wgpu::TextureViewDimension::e2D;
+                break;
+            }
+
+            entries.push_back(entry);
+        }
+
+        wgpu::BindGroupLayoutDescriptor bgl_desc = {};
+        bgl_desc.entryCount = (u32) entries.size();
+        bgl_desc.entries = entries.data();
+
+        m_bind_group_layouts.push_back(device.CreateBindGroupLayout(&bgl_desc));
+    }
+
+    wgpu::PipelineLayoutDescriptor layout_desc = {};
+    layout_desc.bindGroupLayoutCount = (u32) m_bind_group_layouts.size();
+    layout_desc.bindGroupLayouts = m_bind_group_layouts.data();
+
+    m_layout = device.CreatePipelineLayout(&layout_desc);
+
+    wgpu::ComputePipelineDescriptor desc = {};
+    desc.label = to_wgpu_string_view(spec.label);
+    desc.layout = m_layout;
+    desc.compute.module = spec.shader->module();
+    desc.compute.entryPoint = to_wgpu_string_view(spec.entry_point);
+
+    m_pipeline = device.CreateComputePipeline(&desc);
+}
+
+} // namespace terra
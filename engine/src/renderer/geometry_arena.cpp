@@ -0,0 +1,201 @@
+#include "terrapch.h"
+#include "terra/renderer/geometry_arena.h"
+#include "terra/renderer/gpu_counters.h"
+#include "terra/core/context/context.h"
+#include "terra/core/context/command_queue.h"
+#include "terra/debug/profiler.h"
+
+namespace terra {
+
+GeometryArena::GeometryArena(WebGPUContext& context) : m_context(context) {
+    wgpu::BindGroupLayoutEntry entry = {};
+    entry.binding = 0;
+    entry.visibility = wgpu::ShaderStage::Vertex;
+    entry.buffer.type = wgpu::BufferBindingType::Uniform;
+    entry.buffer.minBindingSize = sizeof(MeshDecodeParams);
+
+    wgpu::BindGroupLayoutDescriptor desc = {};
+    desc.label = "Mesh Decode Layout";
+    desc.entryCount = 1;
+    desc.entries = &entry;
+    m_decode_bind_group_layout = context.get_native_device().CreateBindGroupLayout(&desc);
+}
+
+u32 GeometryArena::find_or_create_pool(bool is_index, u32 element_size, wgpu::IndexFormat format) {
+    for (u32 i = 0; i < m_pools.size(); ++i) {
+        const Pool& pool = m_pools[i];
+        if (pool.is_index == is_index && pool.element_size == element_size && pool.index_format == format)
+            return i;
+    }
+
+    Pool pool;
+    pool.is_index = is_index;
+    pool.element_size = element_size;
+    pool.index_format = format;
+    m_pools.push_back(std::move(pool));
+    return (u32) m_pools.size() - 1;
+}
+
+bool GeometryArena::allocate_in_pool(u32 pool_index, u64 count, u64 alignment, u32& page_index, u32& offset, std::string_view debug_name) {
+    Pool& pool = m_pools[pool_index];
+
+    for (u32 i = 0; i < pool.pages.size(); ++i) {
+        Page* page = pool.pages[i].get();
+        if (!page || page->dedicated)
+            continue;
+
+        u64 at = page->allocator.allocate(count, alignment);
+        if (at != RangeAllocator::INVALID_OFFSET) {
+            page_index = i;
+            offset = (u32) at;
+            return true;
+        }
+    }
+
+    // New page: a standard one, or one sized to fit if the request is larger.
+    const u64 page_capacity = (pool.is_index ? INDEX_PAGE_SIZE : VERTEX_PAGE_SIZE) / pool.element_size;
+    auto page = create_scope<Page>();
+    page->dedicated = count > page_capacity;
+
+    const u64 capacity = page->dedicated ? (count + alignment - 1) / alignment * alignment : page_capacity;
+    const u64 bytes = capacity * pool.element_size;
+    page->allocator = RangeAllocator(capacity);
+
+    // Buffer structs keep the label pointer, so only literals here.
+    if (pool.is_index) {
+        // Storage too, so compute passes (meshlet culling) can read indices in place.
+        page->index_buffer.size = bytes;
+        page->index_buffer.format = pool.index_format;
+        page->index_buffer.label = "Geometry Arena Indices";
+        page->index_buffer.buffer = Buffer::create(
+            m_context.get_native_device(),
+            m_context.get_queue()->get_native_queue(),
+            nullptr,
+            bytes,
+            wgpu::BufferUsage::Index | wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+            page->index_buffer.label
+        );
+        if (!page->index_buffer.buffer)
+            return false;
+    } else {
+        page->vertex_buffer = Buffer::create_vertex_buffer(m_context, nullptr, bytes, 0, "Geometry Arena Vertices");
+        if (!page->vertex_buffer.buffer)
+            return false;
+    }
+
+    TR_CORE_TRACE("GeometryArena: new {} page {} ({:.1f} MiB{})", pool.is_index ? "index" : "vertex", pool.pages.size(),
+        bytes / (1024.0 * 1024.0), page->dedicated ? fmt::format(", dedicated to {}", debug_name) : "");
+
+    offset = (u32) page->allocator.allocate(count, alignment);
+
+    // Reuse a slot left by a released dedicated page.
+    for (u32 i = 0; i < pool.pages.size(); ++i) {
+        if (!pool.pages[i]) {
+            pool.pages[i] = std::move(page);
+            page_index = i;
+            return true;
+        }
+    }
+
+    pool.pages.push_back(std::move(page));
+    page_index = (u32) pool.pages.size() - 1;
+    return true;
+}
+
+void GeometryArena::free_in_pool(u32 pool_index, u32 page_index, u64 offset, u64 count) {
+    scope<Page>& page = m_pools[pool_index].pages[page_index];
+    page->allocator.free(offset, count);
+
+    if (page->dedicated && page->allocator.is_empty())
+        page.reset();
+}
+
+GeometryAllocation GeometryArena::allocate(
+    const void* vertex_data, u32 vertex_count, u32 vertex_stride,
+    const void* index_data, u32 index_count, wgpu::IndexFormat index_format,
+    std::string_view debug_name)
+{
+    PROFILE_FUNCTION();
+
+    TR_CORE_ASSERT(vertex_stride % 4 == 0, "GeometryArena: vertex stride must be a multiple of 4");
+
+    const u32 index_size = index_format == wgpu::IndexFormat::Uint16 ? sizeof(u16) : sizeof(u32);
+    // Queue writes need 4-byte offsets and sizes: 16-bit ranges start and end on even indices.
+    const u32 index_alignment = 4 / index_size;
+    const u32 padded_index_count = (index_count + index_alignment - 1) / index_alignment * index_alignment;
+
+    GeometryAllocation allocation;
+    allocation.vertex_count = vertex_count;
+    allocation.index_count = padded_index_count;
+
+    allocation.vertex_pool = find_or_create_pool(false, vertex_stride, wgpu::IndexFormat::Undefined);
+    if (!allocate_in_pool(allocation.vertex_pool, std::max(vertex_count, 1u), 1, allocation.vertex_page, allocation.base_vertex, debug_name)) {
+        TR_CORE_ERROR("GeometryArena: failed to allocate {} vertices for {}", vertex_count, debug_name);
+        return {};
+    }
+
+    allocation.index_pool = find_or_create_pool(true, index_size, index_format);
+    if (!allocate_in_pool(allocation.index_pool, std::max(padded_index_count, index_alignment), index_alignment, allocation.index_page, allocation.first_index, debug_name)) {
+        TR_CORE_ERROR("GeometryArena: failed to allocate {} indices for {}", index_count, debug_name);
+        free_in_pool(allocation.vertex_pool, allocation.vertex_page, allocation.base_vertex, std::max(vertex_count, 1u));
+        return {};
+    }
+
+    wgpu::Queue queue = m_context.get_queue()->get_native_queue();
+
+    if (vertex_count > 0) {
+        queue.WriteBuffer(get_vertex_buffer(allocation).buffer, (u64) allocation.base_vertex * vertex_stride,
+            vertex_data, (u64) vertex_count * vertex_stride);
+        GpuCounters::add_upload((u64) vertex_count * vertex_stride);
+    }
+
+    if (index_count > 0) {
+        const u64 bytes = (u64) index_count * index_size;
+        const u64 padded_bytes = (u64) padded_index_count * index_size;
+
+        std::vector<u8> padded;
+        if (padded_bytes != bytes) {
+            padded.resize(padded_bytes, 0);
+            std::memcpy(padded.data(), index_data, bytes);
+            index_data = padded.data();
+        }
+
+        queue.WriteBuffer(get_index_buffer(allocation).buffer, (u64) allocation.first_index * index_size, index_data, padded_bytes);
+        GpuCounters::add_upload(padded_bytes);
+    }
+
+    return allocation;
+}
+
+void GeometryArena::free(const GeometryAllocation& allocation) {
+    if (!allocation.is_valid())
+        return;
+
+    const u32 index_alignment = m_pools[allocation.index_pool].element_size == sizeof(u16) ? 2 : 1;
+
+    free_in_pool(allocation.vertex_pool, allocation.vertex_page, allocation.base_vertex, std::max(allocation.vertex_count, 1u));
+    free_in_pool(allocation.index_pool, allocation.index_page, allocation.first_index, std::max(allocation.index_count, index_alignment));
+}
+
+const VertexBuffer& GeometryArena::get_vertex_buffer(const GeometryAllocation& allocation) const {
+    return m_pools[allocation.vertex_pool].pages[allocation.vertex_page]->vertex_buffer;
+}
+
+const IndexBuffer& GeometryArena::get_index_buffer(const GeometryAllocation& allocation) const {
+    return m_pools[allocation.index_pool].pages[allocation.index_page]->index_buffer;
+}
+
+GeometryArena::Stats GeometryArena::get_stats() const {
+    Stats stats;
+    for (const Pool& pool : m_pools) {
+        for (const auto& page : pool.pages) {
+            if (!page) continue;
+            stats.page_count++;
+            stats.reserved_bytes += page->allocator.get_capacity() * pool.element_size;
+            stats.used_bytes += page->allocator.get_used() * pool.element_size;
+        }
+    }
+    return stats;
+}
+
+} // namespace terra
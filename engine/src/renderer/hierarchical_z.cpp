@@ -0,0 +1,129 @@
+#include "terrapch.h"
+#include "terra/renderer/hierarchical_z.h"
+#include "terra/renderer/gpu_counters.h"
+#include "terra/renderer/renderer_api.h"
+#include "terra/core/context/command_queue.h"
+#include "terra/debug/profiler.h"
+
+#include <bit>
+
+namespace terra {
+
+static constexpr u32 REDUCE_GROUP_SIZE = 8;
+
+HierarchicalZ::HierarchicalZ(WebGPUContext& context) : m_context(context) {
+    ref<Shader> shader = RendererAPI::create_shader("shaders/hzb_reduce.wgsl", "HZB Reduce Shader");
+
+    ComputePipelineSpecification spec;
+    spec.shader = shader;
+
+    spec.entry_point = "cs_reduce_depth";
+    spec.label = "HZB Reduce Depth";
+    spec.groups = { {
+        ComputeBindingSpec::texture(0, wgpu::TextureSampleType::Depth),
+        ComputeBindingSpec::storage_texture(2, FORMAT),
+        ComputeBindingSpec::buffer(3, wgpu::BufferBindingType::Uniform, sizeof(glm::uvec2)),
+    } };
+    m_reduce_depth = create_scope<ComputePipeline>(context, spec);
+
+    spec.entry_point = "cs_reduce";
+    spec.label = "HZB Reduce";
+    spec.groups = { {
+        ComputeBindingSpec::texture(1, wgpu::TextureSampleType::UnfilterableFloat),
+        ComputeBindingSpec::storage_texture(2, FORMAT),
+    } };
+    m_reduce = create_scope<ComputePipeline>(context, spec);
+
+    m_params = Buffer::create_uniform_buffer(context, nullptr, sizeof(glm::uvec2), 0, "HZB Reduce Params");
+}
+
+void HierarchicalZ::set_source(wgpu::TextureView depth, u32 width, u32 height) {
+    PROFILE_FUNCTION();
+
+    m_source = depth;
+    m_built = false;
+
+    const glm::uvec2 source_size(width, height);
+    m_context.get_queue()->get_native_queue().WriteBuffer(m_params.buffer, 0, &source_size, sizeof(source_size));
+    GpuCounters::add_upload(sizeof(source_size));
+
+    const u32 pyramid_width = std::bit_floor(std::max(width, 1u));
+    const u32 pyramid_height = std::bit_floor(std::max(height, 1u));
+    const auto& device = m_context.get_native_device();
+
+    if (pyramid_width != m_width || pyramid_height != m_height || !m_texture) {
+        m_width = pyramid_width;
+        m_height = pyramid_height;
+
+        const u32 mip_count = (u32) std::bit_width(std::max(m_width, m_height));
+
+        wgpu::TextureDescriptor desc = {};
+        desc.label = "HZB";
+        desc.usage = wgpu::TextureUsage::StorageBinding | wgpu::TextureUsage::TextureBinding;
+        desc.size = { m_width, m_height, 1 };
+        desc.format = FORMAT;
+        desc.mipLevelCount = mip_count;
+        m_texture = device.CreateTexture(&desc);
+        m_view = m_texture.CreateView();
+
+        m_mip_views.clear();
+        for (u32 mip = 0; mip < mip_count; ++mip) {
+            wgpu::TextureViewDescriptor view_desc = {};
+            view_desc.format = FORMAT;
+            view_desc.dimension = wgpu::TextureViewDimension::e2D;
+            view_desc.baseMipLevel = mip;
+            view_desc.mipLevelCount = 1;
+            view_desc.baseArrayLayer = 0;
+            view_desc.arrayLayerCount = 1;
+            m_mip_views.push_back(m_texture.CreateView(&view_desc));
+        }
+    }
+
+    // Level 0 reads the depth buffer, every other level the one above it.
+    m_bind_groups.clear();
+    for (u32 mip = 0; mip < m_mip_views.size(); ++mip) {
+        wgpu::BindGroupEntry entries[3] = {};
+        entries[0].binding = mip == 0 ? 0 : 1;
+        entries[0].textureView = mip == 0 ? m_source : m_mip_views[mip - 1];
+        entries[1].binding = 2;
+        entries[1].textureView = m_mip_views[mip];
+        entries[2].binding = 3;
+        entries[2].buffer = m_params.buffer;
+        entries[2].size = sizeof(glm::uvec2);
+
+        wgpu::BindGroupDescriptor desc = {};
+        desc.label = "HZB Reduce Bind Group";
+        desc.layout = (mip == 0 ? m_reduce_depth : m_reduce)->get_bind_group_layout(0);
+        desc.entryCount = mip == 0 ? 3 : 2;
+        desc.entries = entries;
+        m_bind_groups.push_back(device.CreateBindGroup(&desc));
+        GpuCounters::add_bind_group();
+    }
+}
+
+void HierarchicalZ::build(wgpu::CommandEncoder encoder) {
+    PROFILE_FUNCTION();
+
+    if (!m_source || m_bind_groups.empty())
+        return;
+
+    wgpu::ComputePassDescriptor pass_desc = {};
+    pass_desc.label = "HZB Build";
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&pass_desc);
+
+    for (u32 mip = 0; mip < m_bind_groups.size(); ++mip) {
+        const u32 width = std::max(m_width >> mip, 1u);
+        const u32 height = std::max(m_height >> mip, 1u);
+
+        (mip == 0 ? m_reduce_depth : m_reduce)->bind(pass);
+        pass.SetBindGroup(0, m_bind_groups[mip], 0, nullptr);
+        pass.DispatchWorkgroups(
+            ComputePipeline::get_group_count(width, REDUCE_GROUP_SIZE),
+            ComputePipeline::get_group_count(height, REDUCE_GROUP_SIZE));
+    }
+
+    pass.End();
+    m_built = true;
+}
+
+} // namespace terra
@@ -2,8 +2,10 @@
 #include "terra/core/context/command_queue.h"
 #include "terra/debug/profiler.h"
 #include "terra/renderer/buffer.h"
+#include "terra/renderer/gpu_counters.h"
 #include "terra/core/assert.h"
 #include "terra/core/logger.h"
+#include "terra/core/revision.h"
 #include <cstddef>
 
 namespace terra {
@@ -67,11 +69,17 @@ void MaterialInstance::create_bind_group() {
     auto device = m_context.get_native_device();
 
     m_bind_group = device.CreateBindGroup(&desc);
+    GpuCounters::add_bind_group();
+    m_revision = next_revision();
 }
 
 void MaterialInstance::bind_storage_buffer(u32 group, u32 binding, wgpu::Buffer buffer) {
     PROFILE_FUNCTION();
 
+    m_storage_bind_groups[group] = create_storage_bind_group(group, binding, buffer);
+}
+
+wgpu::BindGroup MaterialInstance::create_storage_bind_group(u32 group, u32 binding, wgpu::Buffer buffer) const {
     // 1) Prepare the single entry
     wgpu::BindGroupEntry entry{};
     entry.binding = binding;
@@ -85,7 +93,8 @@ void MaterialInstance::bind_storage_buffer(u32 group, u32 binding, wgpu::Buffer
     desc.entryCount = 1;
     desc.entries    = &entry;
 
-    m_storage_bind_groups[group] = m_context.get_native_device().CreateBindGroup(&desc);
+    GpuCounters::add_bind_group();
+    return m_context.get_native_device().CreateBindGroup(&desc);
 }
 
 void MaterialInstance::set_uniform_data(u32 binding_index, const void* data, u64 size) {
@@ -189,6 +198,29 @@ void MaterialInstance::bind(wgpu::RenderPassEncoder render_pass) {
     }
 }
 
+void MaterialInstance::bind(wgpu::RenderBundleEncoder bundle) const {
+    m_pipeline->bind(bundle);
+
+    bundle.SetBindGroup(0, m_bind_group, 0, nullptr);
+}
+
+void MaterialInstance::bind_depth(wgpu::RenderPassEncoder render_pass) {
+    PROFILE_FUNCTION();
+
+    m_pipeline->bind_depth(render_pass);
+
+    render_pass.SetBindGroup(0, m_bind_group, 0, nullptr);
+    for (auto& [group, bg] : m_storage_bind_groups) {
+        render_pass.SetBindGroup(group, bg, 0, nullptr);
+    }
+}
+
+void MaterialInstance::bind_depth(wgpu::RenderBundleEncoder bundle) const {
+    m_pipeline->bind_depth(bundle);
+
+    bundle.SetBindGroup(0, m_bind_group, 0, nullptr);
+}
+
 wgpu::BindGroup MaterialInstance::get_bind_group(u32 index) const {
     TR_CORE_ASSERT(index == 0, "Only one bind group currently supported");
     return m_bind_group;
@@ -218,6 +250,7 @@ void MaterialInstance::update_uniform_buffer(u32 binding_index) {
             param.data.data(), 
             param.data.size()
         );
+        GpuCounters::add_upload(param.data.size());
     }
 }
 
@@ -1,7 +1,12 @@
 #include "terrapch.h"
 #include "terra/renderer/mesh.h"
+#include "terra/renderer/gpu_counters.h"
 #include "terra/renderer/renderer_api.h"
 #include "terra/resources/resource_manager.h"
+#include "terra/resources/asset_registry.h"
+#include "terra/core/revision.h"
+
+#include <glm/gtc/type_ptr.hpp>
 
 namespace terra {
 
@@ -27,66 +32,161 @@ namespace terra {
 //     m_vertex_count = vertices.size();
 // }
 
+VertexQuantization Mesh::s_vertex_quantization = VertexQuantization::Unorm16;
+
 Mesh::Mesh(const MeshSpecification& spec) {
     auto& ctx = RendererAPI::get_context();
 
-    m_vertex_buffer = Buffer::create_vertex_buffer(
-        ctx, 
-        spec.vertex_data, 
-        spec.vertex_count * spec.layout.stride, 
-        0, 
-        spec.debug_name.data()
+    m_arena = RendererAPI::get_geometry_arena();
+    m_allocation = m_arena->allocate(
+        spec.vertex_data, spec.vertex_count, (u32) spec.layout.stride,
+        spec.index_data, spec.index_count, spec.index_format,
+        spec.debug_name
     );
 
-    m_index_buffer  = Buffer::create_index_buffer(
-        ctx, 
-        spec.index_data, 
-        spec.index_count * sizeof(u32), 
-        wgpu::IndexFormat::Uint32, 
-        spec.debug_name.data()
-    );
+    m_decode_buffer = Buffer::create_uniform_buffer(ctx, &spec.decode, sizeof(MeshDecodeParams), 0, "Mesh Decode Uniform");
+
+    {
+        const auto& device = ctx.get_native_device();
+
+        wgpu::BindGroupEntry entry = {};
+        entry.binding = 0;
+        entry.buffer = m_decode_buffer.buffer;
+        entry.size = sizeof(MeshDecodeParams);
+
+        wgpu::BindGroupDescriptor desc = {};
+        desc.layout = m_arena->get_decode_bind_group_layout();
+        desc.entryCount = 1;
+        desc.entries = &entry;
+        m_decode_bind_group = device.CreateBindGroup(&desc);
+        GpuCounters::add_bind_group();
+    }
+
+    if (spec.lods.empty())
+        m_lods.push_back({ 0, spec.index_count, spec.vertex_count, 0.0f });
+    else
+        m_lods.assign(spec.lods.begin(), spec.lods.end());
 
     m_vertex_count = spec.vertex_count;
-    m_index_count = spec.index_count;
-}
+    m_index_count = m_lods[0].index_count;
+    m_bounds = spec.bounds;
 
+    if (!spec.meshlets.empty()) {
+        m_meshlet_buffer = Buffer::create_storage_buffer(ctx, spec.meshlets.data(), spec.meshlets.size_bytes(), 1, "Mesh Meshlets");
+        m_meshlet_count = (u32) spec.meshlets.size();
+    }
 
+    m_revision = next_revision();
+}
 
+Mesh::~Mesh() {
+    m_arena->free(m_allocation);
+}
 
-ref<Mesh> Mesh::from_file(const std::filesystem::path& path) {
-    std::vector<f32> raw_vertex_data;
-    std::vector<u32> index_data;
+MeshHandle Mesh::from_file(const std::filesystem::path& path) {
+    return AssetRegistry::load_mesh(path);
+}
+
+ref<Mesh> Mesh::from_source(std::string_view source, std::string_view debug_name) {
+    MeshData data;
 
-    if (!ResourceManager::load_geometry(path, raw_vertex_data, index_data, true)) {
-        TR_CORE_ERROR("Mesh::from_file failed: {}", path.string());
+    if (!ResourceManager::import_geometry(source, debug_name, data)) {
+        TR_CORE_ERROR("Mesh::from_source failed: {}", debug_name);
         return nullptr;
     }
 
-    if (raw_vertex_data.size() % 6 != 0) {
-        TR_CORE_ERROR("Invalid vertex format: expected 6 floats per vertex (x, y, z, r, g, b)");
+    return from_data(data, debug_name);
+}
+
+ref<Mesh> Mesh::from_data(const MeshData& data, std::string_view debug_name) {
+    const bool normals = data.vertex_stride == vertex_quantization::NORMAL_VERTEX_STRIDE;
+    if ((data.vertex_stride != 6 && !normals) || data.vertices.size() % data.vertex_stride != 0) {
+        TR_CORE_ERROR("Invalid vertex format: expected 6 floats per vertex (x, y, z, r, g, b), optionally followed by a normal");
         return nullptr;
     }
 
+    const QuantizedVertices vertices = vertex_quantization::quantize(data, s_vertex_quantization);
+
+    // Every index fits in 16 bits when the vertex count does.
+    std::vector<u16> narrow_indices;
+    if (data.get_vertex_count() <= 0x10000) {
+        narrow_indices.assign(data.indices.begin(), data.indices.end());
+    }
+
     MeshSpecification spec;
-    spec.vertex_data = raw_vertex_data.data();
-    spec.vertex_count = raw_vertex_data.size() / 6;
-    spec.index_data = index_data.data();
-    spec.index_count = index_data.size();
-    spec.layout = get_default_layout();
-    spec.debug_name = path.filename().string();
+    spec.vertex_data = vertices.data.data();
+    spec.vertex_count = data.get_vertex_count();
+    spec.index_count = data.get_index_count();
+    if (!narrow_indices.empty()) {
+        spec.index_data = narrow_indices.data();
+        spec.index_format = wgpu::IndexFormat::Uint16;
+    } else {
+        spec.index_data = data.indices.data();
+        spec.index_format = wgpu::IndexFormat::Uint32;
+    }
+    spec.layout = get_layout(s_vertex_quantization, normals);
+    spec.decode = vertices.decode;
+    spec.lods = data.lods;
+    spec.bounds = compute_bounds(data);
+    spec.meshlets = data.meshlets;
+    spec.debug_name = debug_name;
 
     return create_ref<Mesh>(spec);
 }
 
+BoundingSphere Mesh::compute_bounds(const MeshData& data) {
+    const u32 vertex_count = data.get_vertex_count();
+    if (vertex_count == 0)
+        return {};
+
+    auto position = [&](u32 v) { return glm::make_vec3(&data.vertices[(size_t) v * data.vertex_stride]); };
+
+    // Centred on the bounding box: not minimal, but cheap and stable.
+    glm::vec3 lo = position(0), hi = lo;
+    for (u32 v = 1; v < vertex_count; ++v) {
+        lo = glm::min(lo, position(v));
+        hi = glm::max(hi, position(v));
+    }
+
+    BoundingSphere bounds;
+    bounds.center = (lo + hi) * 0.5f;
+    for (u32 v = 0; v < vertex_count; ++v)
+        bounds.radius = std::max(bounds.radius, glm::distance(bounds.center, position(v)));
+
+    return bounds;
+}
+
 VertexBufferLayoutSpec Mesh::get_default_layout() {
+    return get_layout(s_vertex_quantization);
+}
 
+VertexBufferLayoutSpec Mesh::get_layout(VertexQuantization mode, bool normals) {
     VertexBufferLayoutSpec layout;
-    layout.stride = sizeof(f32) * 6;
+    layout.stride = vertex_quantization::get_vertex_size(mode, normals);
     layout.step_mode = wgpu::VertexStepMode::Vertex;
-    layout.attributes = {
-        { 0, wgpu::VertexFormat::Float32x3, 0 },
-        { 1, wgpu::VertexFormat::Float32x3, sizeof(f32) * 3 },
-    };
+
+    // Shaders read locations 0 and 1 as vec3f whatever the encoding; only the
+    // position needs MeshDecodeParams applied. A quantized normal arrives as
+    // an octahedral vec2f (see vertex_quantization::encode_octahedral).
+    switch (mode) {
+    case VertexQuantization::None:
+        layout.attributes = {
+            { 0, wgpu::VertexFormat::Float32x3, 0 },
+            { 1, wgpu::VertexFormat::Float32x3, sizeof(f32) * 3 },
+        };
+        if (normals)
+            layout.attributes.push_back({ 2, wgpu::VertexFormat::Float32x3, sizeof(f32) * 6 });
+        break;
+    case VertexQuantization::Unorm16:
+    case VertexQuantization::Float16:
+        layout.attributes = {
+            { 0, mode == VertexQuantization::Unorm16 ? wgpu::VertexFormat::Unorm16x4 : wgpu::VertexFormat::Float16x4, 0 },
+            { 1, wgpu::VertexFormat::Unorm8x4, 8 },
+        };
+        if (normals)
+            layout.attributes.push_back({ 2, wgpu::VertexFormat::Snorm16x2, 12 });
+        break;
+    }
 
     return layout;
 }
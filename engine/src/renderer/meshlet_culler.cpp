@@ -0,0 +1,162 @@
+#include "terrapch.h"
+#include "terra/renderer/meshlet_culler.h"
+#include "terra/renderer/gpu_counters.h"
+#include "terra/renderer/mesh.h"
+#include "terra/renderer/renderer_api.h"
+#include "terra/core/context/command_queue.h"
+#include "terra/debug/profiler.h"
+
+namespace terra {
+
+// WebGPU's default limit on workgroups per dispatch dimension.
+static constexpr u32 MAX_GROUPS_PER_DIMENSION = 65535;
+
+MeshletCuller::MeshletCuller(WebGPUContext& context) : m_context(context) {
+    ComputePipelineSpecification spec;
+    spec.shader = RendererAPI::create_shader("shaders/meshlet_cull.wgsl", "Meshlet Cull Shader");
+    spec.label = "Meshlet Cull";
+    spec.groups = { {
+        ComputeBindingSpec::buffer(0, wgpu::BufferBindingType::Uniform, sizeof(CullParams)),
+        ComputeBindingSpec::buffer(1, wgpu::BufferBindingType::ReadOnlyStorage, sizeof(Meshlet)),
+        ComputeBindingSpec::buffer(2, wgpu::BufferBindingType::ReadOnlyStorage),
+        ComputeBindingSpec::buffer(3, wgpu::BufferBindingType::Storage),
+        ComputeBindingSpec::buffer(4, wgpu::BufferBindingType::Storage, sizeof(DrawArgs)),
+    } };
+
+    m_pipeline = create_scope<ComputePipeline>(context, spec);
+
+    wgpu::Limits limits = {};
+#ifdef WEBGPU_BACKEND_DAWN
+    const bool has_limits = context.get_native_device().GetLimits(&limits) == wgpu::Status::Success;
+#else
+    const bool has_limits = context.get_native_device().GetLimits(&limits);
+#endif
+    // The WebGPU default, which is what the device is created with.
+    m_max_binding_size = has_limits ? limits.maxStorageBufferBindingSize : 128ull << 20;
+}
+
+bool MeshletCuller::can_cull(const Mesh& mesh) const {
+    const u64 output_size = (u64) std::max(mesh.get_lod(0).index_count, 3u) * sizeof(u32);
+    return mesh.get_index_buffer().size <= m_max_binding_size
+        && mesh.get_meshlet_buffer().size <= m_max_binding_size
+        && output_size <= m_max_binding_size;
+}
+
+u32 MeshletCuller::add(const Mesh& mesh, const glm::mat4& transform) {
+    if (m_active == m_slots.size())
+        m_slots.emplace_back();
+
+    Slot& slot = m_slots[m_active];
+    slot.mesh = &mesh;
+    slot.transform = transform;
+
+    const u64 needed = std::max(mesh.get_lod(0).index_count, 3u);
+    if (needed > slot.output_capacity) {
+        slot.output = Buffer::create(
+            m_context.get_native_device(),
+            m_context.get_queue()->get_native_queue(),
+            nullptr,
+            needed * sizeof(u32),
+            wgpu::BufferUsage::Index | wgpu::BufferUsage::Storage,
+            "Meshlet Cull Indices"
+        );
+        slot.output_capacity = needed;
+        slot.bind_group = nullptr;
+    }
+
+    if (!slot.indirect) {
+        slot.indirect = Buffer::create(
+            m_context.get_native_device(),
+            m_context.get_queue()->get_native_queue(),
+            nullptr,
+            sizeof(DrawArgs),
+            wgpu::BufferUsage::Indirect | wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+            "Meshlet Cull Draw Args"
+        );
+        slot.params = Buffer::create_uniform_buffer(m_context, nullptr, sizeof(CullParams), 0, "Meshlet Cull Params");
+    }
+
+    return m_active++;
+}
+
+void MeshletCuller::cull(wgpu::CommandEncoder encoder, const Frustum& frustum, const glm::vec3& camera_position, bool cone_culling) {
+    PROFILE_FUNCTION();
+
+    if (m_active == 0)
+        return;
+
+    const auto& device = m_context.get_native_device();
+    wgpu::Queue queue = m_context.get_queue()->get_native_queue();
+
+    wgpu::ComputePassDescriptor pass_desc = {};
+    pass_desc.label = "Meshlet Cull";
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&pass_desc);
+    m_pipeline->bind(pass);
+
+    for (u32 i = 0; i < m_active; ++i) {
+        Slot& slot = m_slots[i];
+        const Mesh& mesh = *slot.mesh;
+        const IndexBuffer& source = mesh.get_index_buffer();
+
+        CullParams params;
+        params.model = slot.transform;
+        params.normal_matrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(slot.transform))));
+        for (u32 p = 0; p < 6; ++p)
+            params.planes[p] = frustum.get_planes()[p];
+        const f32 scale = std::max({ glm::length(glm::vec3(slot.transform[0])), glm::length(glm::vec3(slot.transform[1])), glm::length(glm::vec3(slot.transform[2])) });
+        params.camera_position = glm::vec4(camera_position, scale);
+        params.meshlet_count = mesh.get_meshlet_count();
+        params.first_index = mesh.get_first_index();
+        params.index_u16 = source.format == wgpu::IndexFormat::Uint16 ? 1 : 0;
+        // Mirroring transforms flip the winding, and with it which side a cone faces.
+        params.cone_culling = cone_culling && glm::determinant(glm::mat3(slot.transform)) > 0.0f ? 1 : 0;
+        queue.WriteBuffer(slot.params.buffer, 0, &params, sizeof(params));
+
+        const DrawArgs args = { 0, 1, 0, (i32) mesh.get_base_vertex(), 0 };
+        queue.WriteBuffer(slot.indirect, 0, &args, sizeof(args));
+        GpuCounters::add_upload(sizeof(params) + sizeof(args));
+
+        if (!slot.bind_group || slot.bound_mesh_revision != mesh.get_revision()) {
+            auto entry = [](u32 binding, const wgpu::Buffer& buffer, u64 size) {
+                wgpu::BindGroupEntry e = {};
+                e.binding = binding;
+                e.buffer = buffer;
+                e.offset = 0;
+                e.size = size;
+                return e;
+            };
+
+            const wgpu::BindGroupEntry entries[] = {
+                entry(0, slot.params.buffer, sizeof(CullParams)),
+                entry(1, mesh.get_meshlet_buffer().buffer, mesh.get_meshlet_buffer().size),
+                entry(2, source.buffer, source.size),
+                entry(3, slot.output, slot.output_capacity * sizeof(u32)),
+                entry(4, slot.indirect, sizeof(DrawArgs)),
+            };
+
+            wgpu::BindGroupDescriptor desc = {};
+            desc.label = "Meshlet Cull Bind Group";
+            desc.layout = m_pipeline->get_bind_group_layout(0);
+            desc.entryCount = std::size(entries);
+            desc.entries = entries;
+
+            slot.bind_group = device.CreateBindGroup(&desc);
+            GpuCounters::add_bind_group();
+            slot.bound_mesh_revision = mesh.get_revision();
+        }
+
+        pass.SetBindGroup(0, slot.bind_group, 0, nullptr);
+
+        const u32 groups = mesh.get_meshlet_count();
+        const u32 groups_x = std::min(groups, MAX_GROUPS_PER_DIMENSION);
+        pass.DispatchWorkgroups(groups_x, ComputePipeline::get_group_count(groups, groups_x));
+
+        slot.mesh = nullptr;
+    }
+
+    pass.End();
+
+    m_active = 0;
+}
+
+} // namespace terra
@@ -0,0 +1,180 @@
+#include "terrapch.h"
+#include "terra/renderer/occlusion_culler.h"
+#include "terra/renderer/gpu_counters.h"
+#include "terra/renderer/renderer_api.h"
+#include "terra/core/context/command_queue.h"
+#include "terra/debug/profiler.h"
+
+namespace terra {
+
+static constexpr u32 CULL_GROUP_SIZE = 64;
+
+OcclusionCuller::OcclusionCuller(WebGPUContext& context) : m_context(context) {
+    ComputePipelineSpecification spec;
+    spec.shader = RendererAPI::create_shader("shaders/instance_cull.wgsl", "Instance Cull Shader");
+    spec.label = "Instance Cull";
+    spec.groups = { {
+        ComputeBindingSpec::buffer(0, wgpu::BufferBindingType::Uniform, sizeof(CullParams)),
+        ComputeBindingSpec::buffer(1, wgpu::BufferBindingType::ReadOnlyStorage),
+        ComputeBindingSpec::buffer(2, wgpu::BufferBindingType::ReadOnlyStorage),
+        ComputeBindingSpec::buffer(3, wgpu::BufferBindingType::Storage),
+        ComputeBindingSpec::buffer(4, wgpu::BufferBindingType::Storage, sizeof(DrawArgs)),
+        ComputeBindingSpec::buffer(5, wgpu::BufferBindingType::Storage),
+        ComputeBindingSpec::texture(6, wgpu::TextureSampleType::UnfilterableFloat),
+    } };
+
+    m_pipeline = create_scope<ComputePipeline>(context, spec);
+    m_hzb = create_scope<HierarchicalZ>(context);
+}
+
+void OcclusionCuller::set_depth_source(wgpu::TextureView depth, u32 width, u32 height) {
+    m_hzb->set_source(depth, width, height);
+}
+
+u32 OcclusionCuller::add(wgpu::Buffer instances, u32 instance_count, u32 stride, std::span<const glm::vec4> bounds,
+    u32 index_count, u32 first_index, i32 base_vertex)
+{
+    TR_CORE_ASSERT(stride % sizeof(u32) == 0 && bounds.size() == instance_count, "Invalid occlusion cull draw");
+
+    if (m_active == m_slots.size())
+        m_slots.emplace_back();
+
+    Slot& slot = m_slots[m_active];
+    slot.source = instances;
+    slot.instance_count = instance_count;
+    slot.stride = stride;
+    slot.args = { index_count, 0, first_index, base_vertex, 0 };
+
+    const auto& device = m_context.get_native_device();
+    wgpu::Queue queue = m_context.get_queue()->get_native_queue();
+
+    // Buffer structs keep the label pointer, so only literals here.
+    if (instance_count > slot.capacity) {
+        slot.capacity = std::max<u64>(instance_count, slot.capacity * 2);
+        slot.bounds = Buffer::create(device, queue, nullptr, slot.capacity * sizeof(glm::vec4),
+            wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst, "Occlusion Bounds");
+        slot.flags = Buffer::create(device, queue, nullptr, slot.capacity * sizeof(u32),
+            wgpu::BufferUsage::Storage, "Occlusion Flags");
+    }
+
+    const u64 instance_bytes = slot.capacity * stride;
+    if (instance_bytes > slot.instance_capacity) {
+        for (PhaseResources& phase : slot.phases) {
+            phase.instances = Buffer::create(device, queue, nullptr, instance_bytes,
+                wgpu::BufferUsage::Storage, "Occlusion Visible Instances");
+        }
+        slot.instance_capacity = instance_bytes;
+    }
+
+    for (PhaseResources& phase : slot.phases) {
+        if (!phase.indirect) {
+            phase.indirect = Buffer::create(device, queue, nullptr, sizeof(DrawArgs),
+                wgpu::BufferUsage::Indirect | wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst, "Occlusion Draw Args");
+            phase.params = Buffer::create_uniform_buffer(m_context, nullptr, sizeof(CullParams), 0, "Occlusion Cull Params");
+        }
+    }
+
+    queue.WriteBuffer(slot.bounds, 0, bounds.data(), bounds.size_bytes());
+    GpuCounters::add_upload(bounds.size_bytes());
+
+    return m_active++;
+}
+
+void OcclusionCuller::dispatch(Phase phase, const CullParams& shared, wgpu::CommandEncoder encoder) {
+    TR_CORE_ASSERT(m_hzb->get_view(), "OcclusionCuller needs a depth source before culling");
+
+    const auto& device = m_context.get_native_device();
+    wgpu::Queue queue = m_context.get_queue()->get_native_queue();
+
+    wgpu::ComputePassDescriptor pass_desc = {};
+    pass_desc.label = phase == Phase::Early ? "Occlusion Cull Early" : "Occlusion Cull Late";
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&pass_desc);
+    m_pipeline->bind(pass);
+
+    for (u32 i = 0; i < m_active; ++i) {
+        Slot& slot = m_slots[i];
+        PhaseResources& resources = slot.phases[(u32) phase];
+
+        CullParams params = shared;
+        params.instance_count = slot.instance_count;
+        params.instance_words = slot.stride / sizeof(u32);
+        queue.WriteBuffer(resources.params.buffer, 0, &params, sizeof(params));
+        queue.WriteBuffer(resources.indirect, 0, &slot.args, sizeof(DrawArgs));
+        GpuCounters::add_upload(sizeof(params) + sizeof(DrawArgs));
+
+        auto entry = [](u32 binding, const wgpu::Buffer& buffer, u64 size) {
+            wgpu::BindGroupEntry e = {};
+            e.binding = binding;
+            e.buffer = buffer;
+            e.offset = 0;
+            e.size = size;
+            return e;
+        };
+
+        // The source instance buffer is new every frame, so is the bind group.
+        wgpu::BindGroupEntry entries[] = {
+            entry(0, resources.params.buffer, sizeof(CullParams)),
+            entry(1, slot.bounds, slot.capacity * sizeof(glm::vec4)),
+            entry(2, slot.source, (u64) slot.instance_count * slot.stride),
+            entry(3, resources.instances, slot.instance_capacity),
+            entry(4, resources.indirect, sizeof(DrawArgs)),
+            entry(5, slot.flags, slot.capacity * sizeof(u32)),
+            {},
+        };
+        entries[6].binding = 6;
+        entries[6].textureView = m_hzb->get_view();
+
+        wgpu::BindGroupDescriptor desc = {};
+        desc.label = "Occlusion Cull Bind Group";
+        desc.layout = m_pipeline->get_bind_group_layout(0);
+        desc.entryCount = std::size(entries);
+        desc.entries = entries;
+
+        pass.SetBindGroup(0, device.CreateBindGroup(&desc), 0, nullptr);
+        GpuCounters::add_bind_group();
+        pass.DispatchWorkgroups(ComputePipeline::get_group_count(slot.instance_count, CULL_GROUP_SIZE));
+    }
+
+    pass.End();
+}
+
+void OcclusionCuller::cull_early(wgpu::CommandEncoder encoder, const Frustum& frustum) {
+    PROFILE_FUNCTION();
+
+    if (m_active == 0)
+        return;
+
+    CullParams params;
+    params.view = m_hzb_view;
+    params.projection = m_hzb_projection;
+    for (u32 p = 0; p < 6; ++p)
+        params.planes[p] = frustum.get_planes()[p];
+    params.hzb_size = glm::vec2(m_hzb->get_size());
+    params.hzb_mip_count = m_hzb->get_mip_count();
+    params.use_hzb = m_hzb->is_built() ? 1 : 0;
+    params.phase = (u32) Phase::Early;
+
+    dispatch(Phase::Early, params, encoder);
+}
+
+void OcclusionCuller::cull_late(wgpu::CommandEncoder encoder, const glm::mat4& view, const glm::mat4& projection) {
+    PROFILE_FUNCTION();
+
+    m_hzb->build(encoder);
+    m_hzb_view = view;
+    m_hzb_projection = projection;
+
+    if (m_active > 0) {
+        CullParams params;
+        params.view = view;
+        params.projection = projection;
+        params.hzb_size = glm::vec2(m_hzb->get_size());
+        params.hzb_mip_count = m_hzb->get_mip_count();
+        params.use_hzb = 1;
+        params.phase = (u32) Phase::Late;
+
+        dispatch(Phase::Late, params, encoder);
+    }
+}
+
+} // namespace terra
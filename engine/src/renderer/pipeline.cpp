@@ -1,10 +1,12 @@
 #include "terra/renderer/pipeline.h"
+#include "terra/renderer/gpu_counters.h"
 #include "terra/core/logger.h"
 #include "terra/debug/profiler.h"
 #include "terra/helpers/error.h"
 #include "terra/helpers/string.h"
 #include "terra/helpers/user_data.h"
 #include "terra/renderer/pipeline_specification.h"
+#include "terra/renderer/mesh.h"
 
 
 namespace terra {
@@ -29,6 +31,27 @@ void Pipeline::bind(wgpu::RenderPassEncoder render_pass) const {
     }
 
 	render_pass.SetPipeline(m_pipeline);
+    GpuCounters::add_pipeline_bind();
+}
+
+void Pipeline::bind(wgpu::RenderBundleEncoder bundle) const {
+    if (!m_pipeline) {
+        TR_CORE_ERROR("Tried to bind a null pipeline!");
+        return;
+    }
+
+	bundle.SetPipeline(m_pipeline);
+}
+
+void Pipeline::bind_depth(wgpu::RenderPassEncoder render_pass) const {
+    TR_CORE_ASSERT(m_depth_pipeline, "Pipeline has no depth prepass variant");
+	render_pass.SetPipeline(m_depth_pipeline);
+    GpuCounters::add_pipeline_bind();
+}
+
+void Pipeline::bind_depth(wgpu::RenderBundleEncoder bundle) const {
+    TR_CORE_ASSERT(m_depth_pipeline, "Pipeline has no depth prepass variant");
+	bundle.SetPipeline(m_depth_pipeline);
 }
 
 
@@ -104,6 +127,18 @@ void Pipeline::create_pipeline(const PipelineSpecification& spec) {
 		m_bind_group_layouts.push_back(bind_group_layout);
 	}
 
+	if (spec.mesh_decode) {
+		// Groups below the decode group that the spec leaves unused stay empty.
+		TR_CORE_ASSERT(m_bind_group_layouts.size() <= MESH_DECODE_GROUP, "Mesh decode group collides with material groups");
+		while (m_bind_group_layouts.size() < MESH_DECODE_GROUP) {
+			wgpu::BindGroupLayoutDescriptor empty_desc = {};
+			m_bind_group_layouts.push_back(device.CreateBindGroupLayout(&empty_desc));
+		}
+
+		TR_CORE_ASSERT(spec.mesh_decode_layout, "mesh_decode pipelines need the arena's decode layout");
+		m_bind_group_layouts.push_back(spec.mesh_decode_layout);
+	}
+
 	wgpu::PipelineLayoutDescriptor layout_desc = {};
     layout_desc.bindGroupLayoutCount = (u32) m_bind_group_layouts.size();
     layout_desc.bindGroupLayouts     = m_bind_group_layouts.data();
@@ -125,11 +160,7 @@ void Pipeline::create_pipeline(const PipelineSpecification& spec) {
 	// from the front of the face, its corner vertices are enumerated
 	// in the counter-clockwise (CCW) order.
 	p.primitive.frontFace = wgpu::FrontFace::CCW;
-
-	// But the face orientation does not matter much because we do not
-	// cull (i.e. "hide") the faces pointing away from us (which is often
-	// used for optimization).
-	p.primitive.cullMode = wgpu::CullMode::None;
+	p.primitive.cullMode = spec.cull_mode;
 
 
 	// Vertex state
@@ -154,11 +185,16 @@ void Pipeline::create_pipeline(const PipelineSpecification& spec) {
 	p.vertex = vs;
 	p.fragment = &fs;
 
+	const bool depth_prepass = spec.depth_prepass && spec.depth_view;
+
 	wgpu::DepthStencilState depth_stencil = {};
 	if (spec.depth_view) {
 		depth_stencil.format = spec.depth_format;
-		depth_stencil.depthWriteEnabled = wgpu::OptionalBool::True;
-		depth_stencil.depthCompare = wgpu::CompareFunction::Less;
+
+		// After a prepass the depth buffer already holds the nearest surface;
+		// only fragments exactly on it are shaded.
+		depth_stencil.depthWriteEnabled = depth_prepass ? wgpu::OptionalBool::False : wgpu::OptionalBool::True;
+		depth_stencil.depthCompare = depth_prepass ? wgpu::CompareFunction::Equal : wgpu::CompareFunction::Less;
 
 		// depth_stencil.stencilFront = wgpu::StencilFaceState{
 		// 	.compare = wgpu::CompareFunction_Always,
@@ -177,6 +213,22 @@ void Pipeline::create_pipeline(const PipelineSpecification& spec) {
 		p.depthStencil = nullptr;
 	}
 
+	if (depth_prepass) {
+		wgpu::RenderPipelineDescriptor depth_desc = p;
+		depth_desc.label = "Depth Prepass Pipeline";
+
+		const std::string& entry = spec.depth_vertex_entry.empty() ? spec.shader->vertex_entry : spec.depth_vertex_entry;
+		depth_desc.vertex.entryPoint = to_wgpu_string_view(entry);
+		depth_desc.fragment = nullptr;
+
+		wgpu::DepthStencilState depth_only = depth_stencil;
+		depth_only.depthWriteEnabled = wgpu::OptionalBool::True;
+		depth_only.depthCompare = wgpu::CompareFunction::Less;
+		depth_desc.depthStencil = &depth_only;
+
+		m_depth_pipeline = device.CreateRenderPipeline(&depth_desc);
+	}
+
 	m_pipeline = device.CreateRenderPipeline(&p);
 
 }
@@ -0,0 +1,432 @@
+#include "terra/renderer/render_graph.h"
+#include "terra/core/assert.h"
+#include "terra/core/context/context.h"
+#include "terra/core/context/command_queue.h"
+#include "terra/debug/profiler.h"
+
+#include <queue>
+
+namespace terra {
+
+namespace {
+
+void add_unique(std::vector<u32>& list, u32 value) {
+    if (std::find(list.begin(), list.end(), value) == list.end())
+        list.push_back(value);
+}
+
+} // namespace
+
+// --- RenderGraphBuilder ---
+
+RenderGraphTexture RenderGraphBuilder::create_texture(std::string_view name, const RenderGraphTextureDesc& desc) {
+    TR_CORE_ASSERT(desc.width > 0 && desc.height > 0 && desc.format != wgpu::TextureFormat::Undefined, "Transient textures need a size and a format");
+
+    RenderGraph::Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    m_graph.m_resources.push_back(std::move(resource));
+    return { (u32) m_graph.m_resources.size() - 1 };
+}
+
+void RenderGraphBuilder::write_color(RenderGraphTexture texture, wgpu::LoadOp load_op, wgpu::Color clear_color) {
+    RenderGraph::Pass& pass = m_graph.m_passes[m_pass];
+    m_graph.get_texture_resource(texture).usage |= wgpu::TextureUsage::RenderAttachment;
+
+    RenderGraph::Attachment attachment;
+    attachment.resource = texture.index;
+    attachment.load_op = load_op;
+    attachment.clear_color = clear_color;
+    pass.color_attachments.push_back(attachment);
+
+    if (load_op == wgpu::LoadOp::Load)
+        add_unique(pass.reads, texture.index);
+    add_unique(pass.writes, texture.index);
+}
+
+void RenderGraphBuilder::write_depth(RenderGraphTexture texture, wgpu::LoadOp load_op, f32 clear_depth) {
+    RenderGraph::Pass& pass = m_graph.m_passes[m_pass];
+    TR_CORE_ASSERT(pass.depth_attachment.resource == RenderGraph::NONE, "Render graph pass already has a depth attachment");
+    m_graph.get_texture_resource(texture).usage |= wgpu::TextureUsage::RenderAttachment;
+
+    pass.depth_attachment.resource = texture.index;
+    pass.depth_attachment.load_op = load_op;
+    pass.depth_attachment.clear_depth = clear_depth;
+
+    if (load_op == wgpu::LoadOp::Load)
+        add_unique(pass.reads, texture.index);
+    add_unique(pass.writes, texture.index);
+}
+
+void RenderGraphBuilder::read_depth(RenderGraphTexture texture) {
+    RenderGraph::Pass& pass = m_graph.m_passes[m_pass];
+    TR_CORE_ASSERT(pass.depth_attachment.resource == RenderGraph::NONE, "Render graph pass already has a depth attachment");
+    m_graph.get_texture_resource(texture).usage |= wgpu::TextureUsage::RenderAttachment;
+
+    pass.depth_attachment.resource = texture.index;
+    pass.depth_attachment.read_only = true;
+    add_unique(pass.reads, texture.index);
+}
+
+void RenderGraphBuilder::read(RenderGraphTexture texture, wgpu::TextureUsage usage) {
+    m_graph.get_texture_resource(texture).usage |= usage;
+    add_unique(m_graph.m_passes[m_pass].reads, texture.index);
+}
+
+void RenderGraphBuilder::write(RenderGraphTexture texture, wgpu::TextureUsage usage) {
+    m_graph.get_texture_resource(texture).usage |= usage;
+    add_unique(m_graph.m_passes[m_pass].writes, texture.index);
+}
+
+void RenderGraphBuilder::read(RenderGraphBuffer buffer) {
+    m_graph.get_buffer_resource(buffer);
+    add_unique(m_graph.m_passes[m_pass].reads, buffer.index);
+}
+
+void RenderGraphBuilder::write(RenderGraphBuffer buffer) {
+    m_graph.get_buffer_resource(buffer);
+    add_unique(m_graph.m_passes[m_pass].writes, buffer.index);
+}
+
+void RenderGraphBuilder::set_side_effect() {
+    m_graph.m_passes[m_pass].side_effect = true;
+}
+
+// --- RenderGraphContext ---
+
+wgpu::Texture RenderGraphContext::get_texture(RenderGraphTexture texture) const {
+    return const_cast<RenderGraph&>(m_graph).get_texture_resource(texture).native_texture;
+}
+
+wgpu::TextureView RenderGraphContext::get_texture_view(RenderGraphTexture texture) const {
+    return const_cast<RenderGraph&>(m_graph).get_texture_resource(texture).view;
+}
+
+wgpu::Buffer RenderGraphContext::get_buffer(RenderGraphBuffer buffer) const {
+    return const_cast<RenderGraph&>(m_graph).get_buffer_resource(buffer).buffer;
+}
+
+// --- RenderGraph ---
+
+RenderGraph::RenderGraph(WebGPUContext& context, RenderTargetPool& targets) : m_context(context), m_targets(targets) {}
+
+RenderGraph::~RenderGraph() {}
+
+RenderGraphTexture RenderGraph::import_texture(std::string_view name, wgpu::TextureView view, const RenderGraphTextureDesc& desc, wgpu::Texture texture) {
+    TR_CORE_ASSERT(!m_compiled, "Cannot import into a compiled graph");
+
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.desc = desc;
+    resource.native_texture = texture;
+    resource.view = view;
+    m_resources.push_back(std::move(resource));
+    return { (u32) m_resources.size() - 1 };
+}
+
+RenderGraphBuffer RenderGraph::import_buffer(std::string_view name, wgpu::Buffer buffer) {
+    TR_CORE_ASSERT(!m_compiled, "Cannot import into a compiled graph");
+
+    Resource resource;
+    resource.name = name;
+    resource.texture = false;
+    resource.imported = true;
+    resource.buffer = buffer;
+    m_resources.push_back(std::move(resource));
+    return { (u32) m_resources.size() - 1 };
+}
+
+void RenderGraph::add_pass(std::string_view name, const SetupFn& setup, ExecuteFn execute) {
+    TR_CORE_ASSERT(!m_compiled, "Cannot add passes to a compiled graph");
+
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+
+    RenderGraphBuilder builder(*this, (u32) m_passes.size() - 1);
+    setup(builder);
+}
+
+const RenderGraphTextureDesc& RenderGraph::get_desc(RenderGraphTexture texture) const {
+    return const_cast<RenderGraph*>(this)->get_texture_resource(texture).desc;
+}
+
+RenderGraph::Resource& RenderGraph::get_texture_resource(RenderGraphTexture texture) {
+    TR_CORE_ASSERT(texture.index < m_resources.size() && m_resources[texture.index].texture, "Invalid render graph texture");
+    return m_resources[texture.index];
+}
+
+RenderGraph::Resource& RenderGraph::get_buffer_resource(RenderGraphBuffer buffer) {
+    TR_CORE_ASSERT(buffer.index < m_resources.size() && !m_resources[buffer.index].texture, "Invalid render graph buffer");
+    return m_resources[buffer.index];
+}
+
+void RenderGraph::compile() {
+    PROFILE_FUNCTION();
+
+    TR_CORE_ASSERT(!m_compiled, "Render graph compiled twice");
+
+    build_dependencies();
+    cull_passes();
+    sort_passes();
+    allocate_transients();
+    create_render_passes();
+
+    m_stats.passes = (u32) m_order.size();
+    m_stats.passes_culled = (u32) (m_passes.size() - m_order.size());
+    m_compiled = true;
+}
+
+void RenderGraph::build_dependencies() {
+    // Hazards follow the order passes were added in: a read sees the last
+    // write before it, and a write waits for every earlier use since then.
+    std::vector<u32> last_writer(m_resources.size(), NONE);
+    std::vector<std::vector<u32>> readers(m_resources.size());
+
+    for (u32 p = 0; p < m_passes.size(); ++p) {
+        Pass& pass = m_passes[p];
+
+        for (u32 r : pass.reads) {
+            if (last_writer[r] != NONE) {
+                add_unique(pass.producers, last_writer[r]);
+                add_unique(pass.dependencies, last_writer[r]);
+            } else if (!m_resources[r].imported) {
+                TR_CORE_WARN("Render graph pass '{}' reads '{}' before anything writes it", pass.name, m_resources[r].name);
+            }
+        }
+
+        for (u32 r : pass.writes) {
+            if (last_writer[r] != NONE && last_writer[r] != p)
+                add_unique(pass.dependencies, last_writer[r]);
+            for (u32 reader : readers[r]) {
+                if (reader != p)
+                    add_unique(pass.dependencies, reader);
+            }
+        }
+
+        for (u32 r : pass.reads)
+            readers[r].push_back(p);
+        for (u32 r : pass.writes) {
+            last_writer[r] = p;
+            readers[r].clear();
+        }
+    }
+}
+
+void RenderGraph::cull_passes() {
+    // Walk back from the passes whose results leave the graph; anything not
+    // reached only produces data nobody reads.
+    std::vector<u32> stack;
+    for (u32 p = 0; p < m_passes.size(); ++p) {
+        Pass& pass = m_passes[p];
+        pass.culled = true;
+
+        bool root = pass.side_effect;
+        for (u32 r : pass.writes)
+            root = root || m_resources[r].imported;
+
+        if (root) {
+            pass.culled = false;
+            stack.push_back(p);
+        }
+    }
+
+    while (!stack.empty()) {
+        const u32 p = stack.back();
+        stack.pop_back();
+
+        for (u32 producer : m_passes[p].producers) {
+            if (m_passes[producer].culled) {
+                m_passes[producer].culled = false;
+                stack.push_back(producer);
+            }
+        }
+    }
+}
+
+void RenderGraph::sort_passes() {
+    // Kahn's algorithm over the surviving passes, taking the earliest added
+    // whenever several are ready.
+    std::vector<u32> pending(m_passes.size(), 0);
+    std::vector<std::vector<u32>> dependents(m_passes.size());
+
+    for (u32 p = 0; p < m_passes.size(); ++p) {
+        if (m_passes[p].culled) continue;
+        for (u32 d : m_passes[p].dependencies) {
+            if (m_passes[d].culled) continue;
+            pending[p]++;
+            dependents[d].push_back(p);
+        }
+    }
+
+    std::priority_queue<u32, std::vector<u32>, std::greater<u32>> ready;
+    for (u32 p = 0; p < m_passes.size(); ++p) {
+        if (!m_passes[p].culled && pending[p] == 0)
+            ready.push(p);
+    }
+
+    m_order.clear();
+    while (!ready.empty()) {
+        const u32 p = ready.top();
+        ready.pop();
+        m_order.push_back(p);
+
+        for (u32 d : dependents[p]) {
+            if (--pending[d] == 0)
+                ready.push(d);
+        }
+    }
+
+    [[maybe_unused]] const auto alive = std::count_if(m_passes.begin(), m_passes.end(), [](const Pass& p) { return !p.culled; });
+    TR_CORE_ASSERT(alive == (i64) m_order.size(), "Render graph has a dependency cycle");
+}
+
+void RenderGraph::allocate_transients() {
+    PROFILE_FUNCTION();
+
+    for (u32 i = 0; i < m_order.size(); ++i) {
+        const Pass& pass = m_passes[m_order[i]];
+        auto touch = [&](u32 r) {
+            Resource& resource = m_resources[r];
+            if (resource.first_use == NONE)
+                resource.first_use = i;
+            resource.last_use = i;
+        };
+        for (u32 r : pass.reads) touch(r);
+        for (u32 r : pass.writes) touch(r);
+    }
+
+    std::vector<u32> transients;
+    for (u32 r = 0; r < m_resources.size(); ++r) {
+        const Resource& resource = m_resources[r];
+        if (resource.texture && !resource.imported && resource.first_use != NONE)
+            transients.push_back(r);
+    }
+    std::sort(transients.begin(), transients.end(),
+        [&](u32 a, u32 b) { return m_resources[a].first_use < m_resources[b].first_use; });
+
+    // Greedy interval assignment: a physical texture is free for the next
+    // transient with its description once its current user's last pass has run.
+    struct Physical {
+        RenderTarget target;
+        u32 busy_until = NONE;
+    };
+    std::vector<Physical> physical;
+
+    for (u32 r : transients) {
+        Resource& resource = m_resources[r];
+
+        RenderGraphTextureDesc desc = resource.desc;
+        desc.usage = desc.usage | resource.usage;
+
+        Physical* match = nullptr;
+        for (Physical& p : physical) {
+            if (p.target.desc == desc && p.busy_until < resource.first_use) {
+                match = &p;
+                break;
+            }
+        }
+
+        if (!match) {
+            physical.push_back({ m_targets.acquire(desc, "Render Graph Transient"), NONE });
+            match = &physical.back();
+        }
+
+        match->busy_until = resource.last_use;
+        resource.native_texture = match->target.texture;
+        resource.view = match->target.view;
+    }
+
+    m_stats.transient_textures = (u32) transients.size();
+    m_stats.physical_textures = (u32) physical.size();
+}
+
+void RenderGraph::create_render_passes() {
+    for (u32 p : m_order) {
+        Pass& pass = m_passes[p];
+        if (pass.color_attachments.empty() && pass.depth_attachment.resource == NONE)
+            continue;
+
+        RenderPassDesc desc;
+        desc.name = pass.name;
+
+        for (const Attachment& src : pass.color_attachments) {
+            RenderPassAttachment attachment;
+            attachment.view = m_resources[src.resource].view;
+            attachment.load_op = src.load_op;
+            attachment.store_op = wgpu::StoreOp::Store;
+            attachment.clear_color = src.clear_color;
+            desc.color_attachments.push_back(attachment);
+        }
+
+        if (pass.depth_attachment.resource != NONE) {
+            const Attachment& src = pass.depth_attachment;
+            desc.depth_stencil_attachment.view = m_resources[src.resource].view;
+            desc.depth_stencil_attachment.load_op = src.load_op;
+            desc.depth_stencil_attachment.store_op = wgpu::StoreOp::Store;
+            desc.depth_stencil_attachment.clear_depth = src.clear_depth;
+            desc.depth_stencil_attachment.read_only_depth = src.read_only;
+        }
+
+        pass.render_pass = create_scope<RenderPass>(desc, *m_context.get_queue());
+    }
+
+    // Mirror the ordering constraints between render passes.
+    for (u32 p : m_order) {
+        Pass& pass = m_passes[p];
+        if (!pass.render_pass) continue;
+        for (u32 d : pass.dependencies) {
+            if (m_passes[d].render_pass)
+                pass.render_pass->add_dependency(m_passes[d].render_pass.get());
+        }
+    }
+}
+
+void RenderGraph::execute() {
+    PROFILE_FUNCTION();
+
+    TR_CORE_ASSERT(m_compiled, "Render graph must be compiled before it is executed");
+
+    const auto& device = m_context.get_native_device();
+    wgpu::Queue queue = m_context.get_queue()->get_native_queue();
+
+    for (u32 p : m_order) {
+        Pass& pass = m_passes[p];
+
+        RenderGraphContext context(*this);
+
+        if (pass.render_pass) {
+            pass.render_pass->begin();
+            context.m_render_pass = pass.render_pass->get_encoder();
+            if (pass.execute)
+                pass.execute(context);
+            pass.render_pass->end();
+            continue;
+        }
+
+        wgpu::CommandEncoderDescriptor encoder_desc = {};
+        encoder_desc.label = pass.name;
+        context.m_encoder = device.CreateCommandEncoder(&encoder_desc);
+
+        if (pass.execute)
+            pass.execute(context);
+
+        wgpu::CommandBufferDescriptor cmd_desc = {};
+        cmd_desc.label = pass.name;
+        wgpu::CommandBuffer commands = context.m_encoder.Finish(&cmd_desc);
+        queue.Submit(1, &commands);
+    }
+}
+
+void RenderGraph::reset() {
+    m_passes.clear();
+    m_resources.clear();
+    m_order.clear();
+    m_compiled = false;
+
+    m_stats = {};
+}
+
+} // namespace terra
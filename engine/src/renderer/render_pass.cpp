@@ -1,4 +1,5 @@
 #include "terra/renderer/render_pass.h"
+#include "terra/renderer/renderer_command.h"
 #include "terra/core/assert.h"
 
 namespace terra {
@@ -12,17 +13,14 @@ RenderPass::~RenderPass() {
 
 void RenderPass::begin() {
     TR_CORE_ASSERT(m_encoder == nullptr, "RenderPass already begun!");
-    // For now, only support one color attachment
-    TR_CORE_ASSERT(!m_desc.color_attachments.empty());
-    const auto& att = m_desc.color_attachments[0];
-    // m_queue.begin_frame(m_desc.name.c_str());
-    // m_encoder = m_queue.create_render_pass(att.view, att.clear_color, att.load_op);
+    TR_CORE_ASSERT(!m_desc.color_attachments.empty() || m_desc.depth_stencil_attachment.view, "RenderPass has no attachments!");
+
+    m_encoder = RendererCommand::begin_render_pass(m_queue, m_desc);
 }
 
 void RenderPass::end() {
     TR_CORE_ASSERT(m_encoder != nullptr, "RenderPass not begun!");
-    // m_queue.end_render_pass();
-    // m_queue.end_frame();
+    RendererCommand::end_render_pass(m_queue);
     m_encoder = nullptr;
 }
 
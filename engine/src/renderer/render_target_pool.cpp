@@ -0,0 +1,77 @@
+#include "terra/renderer/render_target_pool.h"
+#include "terra/core/context/context.h"
+#include "terra/debug/profiler.h"
+
+namespace terra {
+
+size_t RenderTargetPool::DescHash::operator()(const RenderTargetDesc& desc) const {
+    u64 h = desc.width;
+    h = h * 31 + desc.height;
+    h = h * 31 + (u64) desc.format;
+    h = h * 31 + (u64) desc.usage;
+    h = h * 31 + desc.sample_count;
+    h = h * 31 + desc.mip_level_count;
+    return std::hash<u64>{}(h);
+}
+
+RenderTargetPool::RenderTargetPool(WebGPUContext& context) : m_context(context) {}
+
+RenderTargetPool::~RenderTargetPool() {}
+
+RenderTarget RenderTargetPool::acquire(const RenderTargetDesc& desc, std::string_view label) {
+    TR_CORE_ASSERT(desc.width > 0 && desc.height > 0, "Render targets cannot be empty");
+
+    std::vector<Entry>& entries = m_entries[desc];
+    for (Entry& entry : entries) {
+        if (!entry.in_use) {
+            entry.in_use = true;
+            entry.last_used_frame = m_frame_index;
+            return entry.target;
+        }
+    }
+
+    PROFILE_FUNCTION();
+
+    wgpu::TextureDescriptor texture_desc = {};
+    texture_desc.label = label;
+    texture_desc.usage = desc.usage;
+    texture_desc.size = { desc.width, desc.height, 1 };
+    texture_desc.format = desc.format;
+    texture_desc.sampleCount = desc.sample_count;
+    texture_desc.mipLevelCount = desc.mip_level_count;
+
+    Entry entry;
+    entry.target.texture = m_context.get_native_device().CreateTexture(&texture_desc);
+    entry.target.view = entry.target.texture.CreateView();
+    entry.target.desc = desc;
+    entry.last_used_frame = m_frame_index;
+    entry.in_use = true;
+    entries.push_back(entry);
+
+    m_stats.textures++;
+    m_stats.created++;
+    return entry.target;
+}
+
+void RenderTargetPool::end_frame() {
+    m_frame_index++;
+    m_stats.created = 0;
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        std::vector<Entry>& entries = it->second;
+        for (Entry& entry : entries)
+            entry.in_use = false;
+
+        std::erase_if(entries, [&](const Entry& entry) {
+            return entry.last_used_frame + RETIRE_FRAMES < m_frame_index;
+        });
+
+        it = entries.empty() ? m_entries.erase(it) : std::next(it);
+    }
+
+    m_stats.textures = 0;
+    for (const auto& [desc, entries] : m_entries)
+        m_stats.textures += (u32) entries.size();
+}
+
+} // namespace terra
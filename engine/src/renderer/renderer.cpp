@@ -5,15 +5,21 @@
 #include "terrapch.h"
 
 #include "terra/resources/resource_manager.h"
+#include "terra/resources/asset_registry.h"
 #include "terra/renderer/renderer_command.h"
 #include "terra/renderer/renderer.h"
 #include "terra/renderer/material.h"
+#include "terra/renderer/blitter.h"
+#include "terra/renderer/gpu_counters.h"
 #include "terra/helpers/string.h"
 
 namespace terra {
 
 Renderer::Renderer(WebGPUContext& ctx) : m_context(ctx), m_queue(*ctx.get_queue()) {
     m_scene_data = create_scope<SceneData>();
+    m_geometry_arena = create_ref<GeometryArena>(ctx);
+    m_render_targets = create_scope<RenderTargetPool>(ctx);
+    m_render_graph = create_scope<RenderGraph>(ctx, *m_render_targets);
 }
 
 Renderer::~Renderer() {
@@ -25,6 +31,7 @@ void Renderer::init() {
     auto [fb_width, fb_height] = m_context.get_framebuffer_size();
 
     on_resize(fb_width, fb_height);
+    acquire_scene_targets(); // pipelines created before the first frame need the depth view
 }
 
 u64 Renderer::create_pipeline(const PipelineSpecification& spec) {
@@ -38,6 +45,7 @@ u64 Renderer::create_pipeline(const PipelineSpecification& spec) {
     internal_spec.surface_format = m_context.get_preferred_format();
     internal_spec.depth_view = m_depth_texture_view;
     internal_spec.depth_format = m_depth_texture_format;
+    internal_spec.mesh_decode_layout = m_geometry_arena->get_decode_bind_group_layout();
 
     ref<Pipeline> pipeline = create_ref<Pipeline>(m_context, internal_spec);
     m_pipeline_cache[id] = pipeline;
@@ -59,6 +67,54 @@ void Renderer::begin_frame() {
 
     m_stats.reset();
     m_target_texture_view = m_context.get_next_surface_view();
+    acquire_scene_targets();
+}
+
+void Renderer::acquire_scene_targets() {
+    // Once per frame: init() may already have done it before the first one.
+    if (m_targets_frame == m_frame_index)
+        return;
+    m_targets_frame = m_frame_index;
+
+    if (m_resizing && m_frame_index - m_last_resize_frame >= RESIZE_SETTLE_FRAMES)
+        m_resizing = false;
+
+    if (!m_resizing) {
+        m_target_width = m_surface_width;
+        m_target_height = m_surface_height;
+    } else if (m_surface_width > m_target_width || m_surface_height > m_target_height) {
+        // Mid-drag the targets only grow, in coarse steps, so a drag goes
+        // through a handful of sizes instead of one per resize event.
+        auto round_up = [](u32 size) { return (size + RESIZE_GRANULARITY - 1) / RESIZE_GRANULARITY * RESIZE_GRANULARITY; };
+        m_target_width = round_up(std::max(m_surface_width, m_target_width));
+        m_target_height = round_up(std::max(m_surface_height, m_target_height));
+    }
+
+    RenderTargetDesc depth_desc;
+    depth_desc.width = m_target_width;
+    depth_desc.height = m_target_height;
+    depth_desc.format = m_depth_texture_format;
+    // Sampled too, to build the occlusion culler's depth pyramid.
+    depth_desc.usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding;
+
+    const RenderTarget depth = m_render_targets->acquire(depth_desc, "Z Buffer");
+    if (depth.view.Get() != m_depth_texture_view.Get())
+        m_depth_source_dirty = true;
+    m_depth_texture_view = depth.view;
+
+    if (m_depth_source_dirty && m_occlusion_culler) {
+        m_occlusion_culler->set_depth_source(m_depth_texture_view, m_surface_width, m_surface_height);
+        m_depth_source_dirty = false;
+    }
+
+    // Larger than the surface: draw the scene into the top-left of an
+    // offscreen target and blit it across at the end.
+    m_scene_color_view = nullptr;
+    if (m_target_width != m_surface_width || m_target_height != m_surface_height) {
+        RenderTargetDesc color_desc = depth_desc;
+        color_desc.format = m_context.get_preferred_format();
+        m_scene_color_view = m_render_targets->acquire(color_desc, "Scene Color").view;
+    }
 }
 
 void Renderer::begin_scene(const Camera& camera) {
@@ -66,43 +122,44 @@ void Renderer::begin_scene(const Camera& camera) {
 
     m_scene_data->camera = &camera;
 
-    RenderPassDesc scene_pass;
-    scene_pass.name = "MainScene";
+    // LOD selection only needs the eye position and the projection's vertical scale.
+    const glm::mat4& projection = camera.get_projection_matrix();
+    m_scene_data->camera_position = glm::vec3(glm::inverse(camera.get_view_matrix())[3]);
+    m_scene_data->perspective = projection[2][3] != 0.0f;
+    m_scene_data->pixels_per_unit = std::abs(projection[1][1]) * 0.5f * (f32) m_viewport_height;
+    m_scene_data->frustum.set(projection * camera.get_view_matrix());
 
-    // Color attachment
-    RenderPassAttachment color_attachment;
-    color_attachment.view = m_target_texture_view;
-    color_attachment.load_op = wgpu::LoadOp::Clear;
-    color_attachment.store_op = wgpu::StoreOp::Store;
-    color_attachment.clear_color = m_clear_color;
-    scene_pass.color_attachments.push_back(color_attachment);
+    const glm::mat4& view = camera.get_view_matrix();
+    m_scene_data->view_direction = -glm::vec3(view[0][2], view[1][2], view[2][2]);
 
-    // Depth attachment
-    RenderPassAttachment depth_attachment;
-    depth_attachment.view = m_depth_texture_view;
-    depth_attachment.load_op = wgpu::LoadOp::Clear;
-    depth_attachment.store_op = wgpu::StoreOp::Store;
-    depth_attachment.clear_depth = 1.0f;
-    depth_attachment.read_only_depth = false;
-    scene_pass.depth_stencil_attachment = depth_attachment;
-
-    // clears to clearColor
-    m_current_pass = RendererCommand::begin_render_pass(m_queue, scene_pass);
+    // Bundles are only compatible with passes of the formats they were recorded for.
+    if (m_context.get_preferred_format() != m_bundle_color_format) {
+        m_bundle_cache.clear();
+        m_bundle_color_format = m_context.get_preferred_format();
+    }
 
+    // Passes are opened in end_scene, once it is known whether a depth
+    // prepass has to come first.
+    m_scene_active = true;
 }
 
 void Renderer::end_scene() {
     PROFILE_FUNCTION();
 
-    // 1) For each batch, update (or allocate) its GPU buffer & draw
+    if (!m_scene_active) return;
+    m_scene_active = false;
+
+    m_stats.batches = (u32) m_draw_batches.size();
+    for (const auto& b : m_draw_batches)
+        m_stats.instances += b.instance_count;
+
+    // 1) Upload (or allocate) each batch's instance buffer. Culling below
+    //    reads them, so this happens before anything is drawn.
     for (auto& b : m_draw_batches) {
-        if (b.instance_count == 0) continue;
+        if (b.instance_count == 0 || b.persistent) continue; // static batches bring their own, already filled
 
         u64 needed = b.instance_data.size();
-        // allocate or resize
         if (!b.instance_buffer || needed > b.buffer_capacity) {
-            // if (b.instance_buffer) wgpuBufferRelease(b.instance_buffer);
-
             b.instance_buffer = Buffer::create_storage_buffer(
                 m_context,
                 b.instance_data.data(),
@@ -112,45 +169,503 @@ void Renderer::end_scene() {
             ).buffer;
 
             b.buffer_capacity = needed;
-
         } else {
-            m_queue.get_native_queue().WriteBuffer(b.instance_buffer, 0, b.instance_data.data(), needed);
             // just update contents
+            m_queue.get_native_queue().WriteBuffer(b.instance_buffer, 0, b.instance_data.data(), needed);
+            GpuCounters::add_upload(needed);
         }
 
-        // bind storage buffer
-        b.material->bind_storage_buffer(b.group, b.binding, b.instance_buffer);
+        // Batches with a bounding sphere per instance are occlusion culled.
+        if (m_occlusion_culling_enabled
+         && m_scene_data->perspective
+         && b.cluster_slot == DrawBatch::NO_CLUSTER
+         && b.instance_bounds.size() == b.instance_count
+         && b.instance_stride % sizeof(u32) == 0)
+        {
+            Mesh* mesh = AssetRegistry::get(b.mesh);
+            if (!mesh || !mesh->is_valid()) continue;
+
+            if (!m_occlusion_culler) {
+                m_occlusion_culler = create_scope<OcclusionCuller>(m_context);
+                m_occlusion_culler->set_depth_source(m_depth_texture_view, m_surface_width, m_surface_height);
+                m_depth_source_dirty = false;
+            }
+
+            const MeshLod& lod = mesh->get_lod(b.lod);
+            b.occlusion_slot = m_occlusion_culler->add(
+                b.instance_buffer, b.instance_count, b.instance_stride, b.instance_bounds,
+                lod.index_count, mesh->get_first_index() + lod.index_offset, (i32) mesh->get_base_vertex());
+            m_stats.occlusion_draws++;
+        }
+    }
 
-        b.material->bind(m_current_pass);
+    // 2) Front to back, so nearer surfaces fill depth first and hide the rest.
+    {
+        PROFILE_SCOPE("Sort Batches");
 
-        auto const& vb = b.mesh->get_vertex_buffer();
-        auto const& ib = b.mesh->get_index_buffer();
+        std::stable_sort(m_draw_batches.begin(), m_draw_batches.end(),
+            [](const DrawBatch& a, const DrawBatch& b) { return a.view_depth < b.view_depth; });
+        std::stable_sort(m_scene_bundles.begin(), m_scene_bundles.end(),
+            [](const SceneBundle& a, const SceneBundle& b) { return a.view_depth < b.view_depth; });
+    }
 
-        m_current_pass.SetVertexBuffer(0, vb.buffer, 0, vb.size);
+    // 3) Build the frame's passes
+    RenderGraph& graph = *m_render_graph;
+
+    SceneTargets targets;
+    targets.width = m_surface_width;
+    targets.height = m_surface_height;
+
+    const RenderGraphTexture backbuffer = graph.import_texture("Backbuffer", m_target_texture_view,
+        { m_surface_width, m_surface_height, m_context.get_preferred_format() });
+    targets.color = m_scene_color_view
+        ? graph.import_texture("SceneColor", m_scene_color_view, { m_target_width, m_target_height, m_context.get_preferred_format() })
+        : backbuffer;
+    targets.depth = graph.import_texture("Depth", m_depth_texture_view,
+        { m_target_width, m_target_height, m_depth_texture_format });
+
+    // Culler outputs are imported so the scene passes that draw them are
+    // ordered after the passes that fill them.
+    std::vector<RenderGraphBuffer> early_draws; // meshlet and early occlusion results
+    std::vector<RenderGraphBuffer> late_draws;
+    std::vector<RenderGraphBuffer> meshlet_outputs;
+    std::vector<RenderGraphBuffer> occlusion_flags;
+
+    if (m_meshlet_culler && m_meshlet_culler->has_pending()) {
+        for (u32 slot = 0; slot < m_meshlet_culler->get_slot_count(); ++slot) {
+            meshlet_outputs.push_back(graph.import_buffer("MeshletIndices", m_meshlet_culler->get_index_buffer(slot)));
+            meshlet_outputs.push_back(graph.import_buffer("MeshletDrawArgs", m_meshlet_culler->get_indirect_buffer(slot)));
+        }
+        early_draws.insert(early_draws.end(), meshlet_outputs.begin(), meshlet_outputs.end());
+
+        graph.add_pass("MeshletCull",
+            [&](RenderGraphBuilder& builder) {
+                for (RenderGraphBuffer buffer : meshlet_outputs)
+                    builder.write(buffer);
+            },
+            [this](const RenderGraphContext& ctx) {
+                m_meshlet_culler->cull(ctx.get_command_encoder(), m_scene_data->frustum, m_scene_data->camera_position, m_cluster_cone_culling);
+            });
+    }
 
-        m_current_pass.SetIndexBuffer(ib.buffer, ib.format, 0, ib.size);
+    const bool occlusion_pending = m_occlusion_culler && m_occlusion_culler->has_pending();
+    if (occlusion_pending) {
+        using Phase = OcclusionCuller::Phase;
+        std::vector<RenderGraphBuffer> early_outputs;
+        for (u32 slot = 0; slot < m_occlusion_culler->get_slot_count(); ++slot) {
+            early_outputs.push_back(graph.import_buffer("OcclusionInstances", m_occlusion_culler->get_instance_buffer(slot, Phase::Early)));
+            early_outputs.push_back(graph.import_buffer("OcclusionDrawArgs", m_occlusion_culler->get_indirect_buffer(slot, Phase::Early)));
+            late_draws.push_back(graph.import_buffer("OcclusionInstancesLate", m_occlusion_culler->get_instance_buffer(slot, Phase::Late)));
+            late_draws.push_back(graph.import_buffer("OcclusionDrawArgsLate", m_occlusion_culler->get_indirect_buffer(slot, Phase::Late)));
+            occlusion_flags.push_back(graph.import_buffer("OcclusionFlags", m_occlusion_culler->get_flag_buffer(slot)));
+        }
+        early_draws.insert(early_draws.end(), early_outputs.begin(), early_outputs.end());
+
+        graph.add_pass("OcclusionCullEarly",
+            [&](RenderGraphBuilder& builder) {
+                for (RenderGraphBuffer buffer : early_outputs)
+                    builder.write(buffer);
+                for (RenderGraphBuffer buffer : occlusion_flags)
+                    builder.write(buffer);
+            },
+            [this](const RenderGraphContext& ctx) {
+                m_occlusion_culler->cull_early(ctx.get_command_encoder(), m_scene_data->frustum);
+            });
+    }
 
-        m_current_pass.DrawIndexed(b.mesh->get_index_count(), b.instance_count, 0, 0, 0);
+    // Depth prepass for every batch whose pipeline has one, then shading
+    // against that depth.
+    const bool prepass = uses_depth_prepass();
+    if (prepass)
+        add_scene_pass("DepthPrepass", targets, false, true, true, false, early_draws);
+    add_scene_pass("MainScene", targets, true, !prepass, false, false, early_draws);
+
+    // Rebuild the HZB from this frame's depth and draw what the early test
+    // hid but the current depth does not.
+    if (occlusion_pending) {
+        graph.add_pass("OcclusionCullLate",
+            [&](RenderGraphBuilder& builder) {
+                builder.read(targets.depth);
+                for (RenderGraphBuffer buffer : occlusion_flags)
+                    builder.read(buffer);
+                for (RenderGraphBuffer buffer : late_draws)
+                    builder.write(buffer);
+            },
+            [this](const RenderGraphContext& ctx) {
+                m_occlusion_culler->cull_late(ctx.get_command_encoder(), m_scene_data->camera->get_view_matrix(), m_scene_data->camera->get_projection_matrix());
+            });
+
+        if (prepass)
+            add_scene_pass("DepthPrepassLate", targets, false, false, true, true, late_draws);
+        add_scene_pass("MainSceneLate", targets, false, false, false, true, late_draws);
+    }
 
-        m_stats.draw_calls++;
-        m_stats.mesh_count  += 1;
-        m_stats.vertex_count += b.mesh->get_vertex_count() * b.instance_count;
-        m_stats.index_count  += b.mesh->get_index_count()  * b.instance_count;
+    for (const RenderGraphCallback& callback : m_render_graph_callbacks)
+        callback(graph, targets);
+
+    if (m_scene_color_view) {
+        if (!m_blitter || m_blitter->get_target_format() != m_context.get_preferred_format())
+            m_blitter = create_scope<Blitter>(m_context, m_context.get_preferred_format());
+
+        graph.add_pass("Present",
+            [&](RenderGraphBuilder& builder) {
+                builder.read(targets.color);
+                builder.write_color(backbuffer, wgpu::LoadOp::Clear);
+            },
+            [this, color = targets.color](const RenderGraphContext& ctx) {
+                m_blitter->draw(ctx.get_render_pass(), ctx.get_texture_view(color));
+            });
     }
 
-    // 2) clear batches
+    // 4) Run them
+    graph.compile();
+    graph.execute();
+
+    m_stats.render_graph_passes = graph.get_stats().passes;
+    m_stats.render_graph_culled = graph.get_stats().passes_culled;
+    m_stats.render_graph_textures = graph.get_stats().physical_textures;
+    m_stats.render_targets = m_render_targets->get_stats().textures;
+    m_stats.render_targets_created = m_render_targets->get_stats().created;
+    graph.reset();
+
+    // 5) clear batches
+    if (m_occlusion_culler)
+        m_occlusion_culler->reset();
     m_draw_batches.clear();
+    m_scene_bundles.clear();
+}
 
-    // 3) end the pass
-    RendererCommand::end_render_pass(m_queue);
-    m_current_pass = nullptr;
+void Renderer::add_scene_pass(std::string_view name, const SceneTargets& targets, bool clear_color, bool clear_depth, bool depth_only, bool late,
+    std::span<const RenderGraphBuffer> culled) {
+    m_render_graph->add_pass(name,
+        [&](RenderGraphBuilder& builder) {
+            for (RenderGraphBuffer buffer : culled)
+                builder.read(buffer);
+            if (!depth_only)
+                builder.write_color(targets.color, clear_color ? wgpu::LoadOp::Clear : wgpu::LoadOp::Load, m_clear_color);
+            builder.write_depth(targets.depth, clear_depth ? wgpu::LoadOp::Clear : wgpu::LoadOp::Load, 1.0f);
+        },
+        [this, depth_only, late, width = targets.width, height = targets.height](const RenderGraphContext& ctx) {
+            m_current_pass = ctx.get_render_pass();
+            if (m_scene_color_view) {
+                m_current_pass.SetViewport(0.0f, 0.0f, (f32) width, (f32) height, 0.0f, 1.0f);
+                m_current_pass.SetScissorRect(0, 0, width, height);
+            }
+            // Static chunks are never occlusion culled, so they are all in the early passes.
+            if (!late)
+                execute_bundles(depth_only);
+            draw_batches(depth_only, late);
+            m_current_pass = nullptr;
+        });
+}
+
+bool Renderer::uses_depth_prepass() const {
+    for (const SceneBundle& sb : m_scene_bundles) {
+        if (sb.depth_bundle)
+            return true;
+    }
+
+    for (const DrawBatch& b : m_draw_batches) {
+        MaterialInstance* material = AssetRegistry::get(b.material);
+        if (material && material->get_pipeline()->has_depth_prepass())
+            return true;
+    }
+    return false;
+}
+
+void Renderer::execute_bundles(bool depth_only) {
+    PROFILE_FUNCTION();
+
+    // Recorded static chunks first: executing bundles resets the pass state,
+    // and the draws after them bind everything they need anyway.
+    std::vector<wgpu::RenderBundle>& bundles = m_execute_scratch;
+    bundles.clear();
+    for (const SceneBundle& sb : m_scene_bundles) {
+        if (depth_only && !sb.depth_bundle) continue;
+        bundles.push_back(depth_only ? sb.depth_bundle : sb.bundle);
+    }
+
+    if (bundles.empty())
+        return;
+
+    m_current_pass.ExecuteBundles(bundles.size(), bundles.data());
+    if (!depth_only)
+        m_stats.bundles_executed += (u32) bundles.size();
+}
+
+void Renderer::draw_batches(bool depth_only, bool late) {
+    PROFILE_FUNCTION();
+
+    const OcclusionCuller::Phase phase = late ? OcclusionCuller::Phase::Late : OcclusionCuller::Phase::Early;
+
+    // Meshes share geometry arena pages, so buffers are only rebound when the page changes.
+    const wgpu::Buffer* bound_vertex_buffer = nullptr;
+    const wgpu::Buffer* bound_index_buffer = nullptr;
+
+    for (auto& b : m_draw_batches) {
+        if (b.instance_count == 0) continue;
+        if (late && b.occlusion_slot == DrawBatch::NO_SLOT) continue;
+
+        Mesh* mesh = AssetRegistry::get(b.mesh);
+        MaterialInstance* material = AssetRegistry::get(b.material);
+        if (!mesh || !material || !mesh->is_valid()) continue; // unloaded since submit
+
+        // Pipelines with a prepass variant test Equal in the colour pass, so they have to be in it.
+        if (depth_only && !material->get_pipeline()->has_depth_prepass()) continue;
+
+        // Occlusion-culled batches draw the survivors of this phase, compacted.
+        const wgpu::Buffer& instances = b.occlusion_slot != DrawBatch::NO_SLOT
+            ? m_occlusion_culler->get_instance_buffer(b.occlusion_slot, phase)
+            : b.instance_buffer;
+
+        material->bind_storage_buffer(b.group, b.binding, instances);
+        if (depth_only)
+            material->bind_depth(m_current_pass);
+        else
+            material->bind(m_current_pass);
+
+        if (material->get_pipeline()->uses_mesh_decode())
+            m_current_pass.SetBindGroup(MESH_DECODE_GROUP, mesh->get_decode_bind_group(), 0, nullptr);
+
+        auto const& vb = mesh->get_vertex_buffer();
+        if (&vb.buffer != bound_vertex_buffer) {
+            m_current_pass.SetVertexBuffer(0, vb.buffer, 0, vb.size);
+            bound_vertex_buffer = &vb.buffer;
+            m_stats.buffer_binds++;
+        }
+
+        auto bind_index_buffer = [&](const wgpu::Buffer& buffer, wgpu::IndexFormat format, u64 size) {
+            if (&buffer != bound_index_buffer) {
+                m_current_pass.SetIndexBuffer(buffer, format, 0, size);
+                bound_index_buffer = &buffer;
+                m_stats.buffer_binds++;
+            }
+        };
+
+        m_stats.draw_calls++;
+        if (depth_only) {
+            m_stats.depth_prepass_draws++;
+        }
+
+        if (b.cluster_slot != DrawBatch::NO_CLUSTER) {
+            bind_index_buffer(m_meshlet_culler->get_index_buffer(b.cluster_slot), wgpu::IndexFormat::Uint32, WGPU_WHOLE_SIZE);
+
+            // The surviving triangle count is only known on the GPU.
+            m_current_pass.DrawIndexedIndirect(m_meshlet_culler->get_indirect_buffer(b.cluster_slot), 0);
+            if (!depth_only) {
+                m_stats.mesh_count++;
+                m_stats.lod_instances[0]++;
+            }
+            continue;
+        }
+
+        const MeshLod& lod = mesh->get_lod(b.lod);
+        auto const& ib = mesh->get_index_buffer();
+        bind_index_buffer(ib.buffer, ib.format, ib.size);
+
+        if (b.occlusion_slot != DrawBatch::NO_SLOT) {
+            // The instance count is only known on the GPU.
+            m_current_pass.DrawIndexedIndirect(m_occlusion_culler->get_indirect_buffer(b.occlusion_slot, phase), 0);
+        } else {
+            m_current_pass.DrawIndexed(lod.index_count, b.instance_count, mesh->get_first_index() + lod.index_offset, (i32) mesh->get_base_vertex(), 0);
+        }
+
+        // Counted once, at submission size, in the early colour pass.
+        if (!depth_only && !late) {
+            m_stats.mesh_count  += 1;
+            m_stats.vertex_count += lod.vertex_count * b.instance_count;
+            m_stats.index_count  += lod.index_count  * b.instance_count;
+            m_stats.lod_instances[std::min(b.lod, MAX_MESH_LODS - 1)] += b.instance_count;
+        }
+    }
+}
+
+void Renderer::submit(MeshHandle mesh, MaterialHandle material, const void* instance, u32 i_size, u32 binding, u32 group) {
+    if (!m_scene_active) return;
+
+    add_to_batch(mesh, 0, material, instance, i_size, binding, group);
+}
+
+void Renderer::submit(MeshHandle mesh, MaterialHandle material, const glm::mat4& transform, const void* instance, u32 i_size, u32 binding, u32 group) {
+    if (!m_scene_active) return;
+
+    // Meshes still loading get LOD 0; end_scene skips them anyway.
+    const Mesh* m = AssetRegistry::get(mesh);
+    const u32 lod = m ? select_lod(*m, transform) : 0;
+
+    // World-space bounding sphere, for sorting and occlusion culling.
+    glm::vec4 bounds(0.0f);
+    if (m) {
+        const f32 scale = std::max({ glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])) });
+        bounds = glm::vec4(glm::vec3(transform * glm::vec4(m->get_bounds().center, 1.0f)), m->get_bounds().radius * scale);
+    }
+
+    if (lod == 0 && m && m->has_meshlets() && m->is_valid() && m_cluster_culling_enabled) {
+        if (!m_meshlet_culler)
+            m_meshlet_culler = create_scope<MeshletCuller>(m_context);
+
+        // Meshes on pages too large to bind as storage fall back to a plain draw.
+        if (m_meshlet_culler->can_cull(*m)) {
+            // Culled per instance, so never merged with other instances.
+            DrawBatch nb;
+            nb.mesh            = mesh;
+            nb.material        = material;
+            nb.binding         = binding;
+            nb.group           = group;
+            nb.instance_stride = i_size;
+            nb.instance_count  = 1;
+            nb.instance_data.assign((const u8*) instance, (const u8*) instance + i_size);
+            nb.cluster_slot    = m_meshlet_culler->add(*m, transform);
+            nb.view_depth      = get_view_depth(glm::vec3(bounds), bounds.w);
+            m_draw_batches.push_back(std::move(nb));
+
+            m_stats.cluster_draws++;
+            m_stats.meshlets_tested += m->get_meshlet_count();
+            return;
+        }
+    }
+
+    add_to_batch(mesh, lod, material, instance, i_size, binding, group, m ? &bounds : nullptr);
+}
+
+f32 Renderer::get_view_depth(const glm::vec3& center, f32 radius) const {
+    return glm::dot(center - m_scene_data->camera_position, m_scene_data->view_direction) - radius;
+}
+
+u32 Renderer::select_lod(const Mesh& mesh, const glm::mat4& transform) const {
+    const u32 lod_count = mesh.get_lod_count();
+    if (lod_count <= 1 || m_lod_threshold <= 0.0f)
+        return 0;
+
+    const BoundingSphere& bounds = mesh.get_bounds();
+    const f32 scale = std::max({ glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])) });
+
+    f32 pixels_per_unit = m_scene_data->pixels_per_unit;
+    if (m_scene_data->perspective) {
+        // Distance to the nearest point of the bounding sphere; inside it, full detail.
+        const glm::vec3 center = glm::vec3(transform * glm::vec4(bounds.center, 1.0f));
+        const f32 distance = glm::distance(center, m_scene_data->camera_position) - bounds.radius * scale;
+        if (distance <= 0.0f)
+            return 0;
+        pixels_per_unit /= distance;
+    }
+
+    // LOD errors grow monotonically, so walk down from the coarsest level.
+    for (u32 lod = lod_count - 1; lod > 0; --lod) {
+        if (mesh.get_lod(lod).error * scale * pixels_per_unit <= m_lod_threshold)
+            return lod;
+    }
+    return 0;
+}
+
+void Renderer::submit(const StaticBatch& batch) {
+    if (!m_scene_active) return;
+
+    const auto& chunks = batch.get_chunks();
+
+    BatchBundles* bundles = nullptr;
+    if (m_render_bundles_enabled) {
+        bundles = &m_bundle_cache[batch.get_id()];
+        bundles->last_used_frame = m_frame_index;
+        if (bundles->revision != batch.get_revision() || bundles->chunks.size() != chunks.size()) {
+            bundles->chunks.assign(chunks.size(), {});
+            bundles->revision = batch.get_revision();
+        }
+    }
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const StaticBatch::Chunk& chunk = chunks[i];
+
+        if (!m_scene_data->frustum.intersects(chunk.bounds)) {
+            m_stats.static_chunks_culled++;
+            continue;
+        }
+
+        m_stats.static_chunks_drawn++;
+
+        const f32 view_depth = get_view_depth(chunk.bounds.get_center(), glm::length(chunk.bounds.get_extent()));
+
+        if (!bundles) {
+            DrawBatch nb;
+            nb.mesh            = chunk.mesh;
+            nb.material        = chunk.material;
+            nb.binding         = batch.get_binding();
+            nb.group           = batch.get_group();
+            nb.instance_stride = batch.get_instance_size();
+            nb.instance_count  = 1;
+            nb.instance_buffer = batch.get_instance_buffer();
+            nb.persistent      = true;
+            nb.view_depth      = view_depth;
+            m_draw_batches.push_back(std::move(nb));
+            continue;
+        }
+
+        Mesh* mesh = AssetRegistry::get(chunk.mesh);
+        MaterialInstance* material = AssetRegistry::get(chunk.material);
+        if (!mesh || !material || !mesh->is_valid()) continue;
+
+        ChunkBundle& cb = bundles->chunks[i];
+        if (!cb.bundle
+         || cb.mesh_revision != mesh->get_revision()
+         || cb.material_revision != material->get_revision())
+        {
+            cb.bundle = record_bundle(batch, *mesh, *material, false);
+            cb.depth_bundle = material->get_pipeline()->has_depth_prepass() ? record_bundle(batch, *mesh, *material, true) : nullptr;
+            cb.mesh_revision = mesh->get_revision();
+            cb.material_revision = material->get_revision();
+            m_stats.bundles_recorded++;
+        }
+
+        m_scene_bundles.push_back({ cb.bundle, cb.depth_bundle, view_depth });
+
+        const MeshLod& lod = mesh->get_lod(0);
+        m_stats.draw_calls++;
+        m_stats.mesh_count++;
+        m_stats.vertex_count += lod.vertex_count;
+        m_stats.index_count  += lod.index_count;
+        m_stats.lod_instances[0]++;
+    }
 }
 
-void Renderer::submit(const ref<Mesh>& mesh, const ref<MaterialInstance>& material, const void* instance, u32 i_size, u32 binding, u32 group) {
-    if (!m_current_pass) return;
+wgpu::RenderBundle Renderer::record_bundle(const StaticBatch& batch, Mesh& mesh, MaterialInstance& material, bool depth_only) const {
+    PROFILE_FUNCTION();
+
+    // Must match the scene pass attachments exactly; the prepass has no colour.
+    wgpu::RenderBundleEncoderDescriptor desc = {};
+    desc.label = depth_only ? "Static Chunk Depth Bundle" : "Static Chunk Bundle";
+    desc.colorFormatCount = depth_only ? 0 : 1;
+    desc.colorFormats = depth_only ? nullptr : &m_bundle_color_format;
+    desc.depthStencilFormat = m_depth_texture_format;
+    desc.sampleCount = 1;
+
+    wgpu::RenderBundleEncoder encoder = m_context.get_native_device().CreateRenderBundleEncoder(&desc);
+
+    if (depth_only)
+        material.bind_depth(encoder);
+    else
+        material.bind(encoder);
+    encoder.SetBindGroup(batch.get_group(), material.create_storage_bind_group(batch.get_group(), batch.get_binding(), batch.get_instance_buffer()), 0, nullptr);
+
+    if (material.get_pipeline()->uses_mesh_decode())
+        encoder.SetBindGroup(MESH_DECODE_GROUP, mesh.get_decode_bind_group(), 0, nullptr);
 
+    const auto& vb = mesh.get_vertex_buffer();
+    const auto& ib = mesh.get_index_buffer();
+    encoder.SetVertexBuffer(0, vb.buffer, 0, vb.size);
+    encoder.SetIndexBuffer(ib.buffer, ib.format, 0, ib.size);
+
+    const MeshLod& lod = mesh.get_lod(0);
+    encoder.DrawIndexed(lod.index_count, 1, mesh.get_first_index() + lod.index_offset, (i32) mesh.get_base_vertex(), 0);
+
+    return encoder.Finish();
+}
+
+void Renderer::add_to_batch(MeshHandle mesh, u32 lod, MaterialHandle material, const void* instance, u32 i_size, u32 binding, u32 group, const glm::vec4* bounds) {
     for (auto& b : m_draw_batches) {
-        if (b.mesh == mesh
+        if (!b.persistent
+         && b.cluster_slot == DrawBatch::NO_CLUSTER
+         && b.mesh == mesh
+         && b.lod == lod
          && b.material == material
          && b.binding == binding
          && b.group == group
@@ -163,12 +678,17 @@ void Renderer::submit(const ref<Mesh>& mesh, const ref<MaterialInstance>& materi
                 src, src + i_size
             );
             b.instance_count++;
+            if (bounds) {
+                b.instance_bounds.push_back(*bounds);
+                b.view_depth = std::min(b.view_depth, get_view_depth(glm::vec3(*bounds), bounds->w));
+            }
             return;
         }
     }
 
     DrawBatch nb;
     nb.mesh            = mesh;
+    nb.lod             = lod;
     nb.material        = material;
     nb.binding         = binding;
     nb.group           = group;
@@ -176,9 +696,13 @@ void Renderer::submit(const ref<Mesh>& mesh, const ref<MaterialInstance>& materi
     nb.instance_count  = 1;
     nb.instance_data.resize(i_size);
     memcpy(nb.instance_data.data(), instance, i_size);
+    if (bounds) {
+        nb.instance_bounds.push_back(*bounds);
+        nb.view_depth = get_view_depth(glm::vec3(*bounds), bounds->w);
+    }
     nb.instance_buffer     = nullptr;
     nb.buffer_capacity     = 0;
-    m_draw_batches.push_back(nb);
+    m_draw_batches.push_back(std::move(nb));
 }
 
 
@@ -211,6 +735,31 @@ void Renderer::end_frame() {
 
     m_context.swap_buffers();
     m_queue.poll(false);
+    m_stats.gpu_time_ms = (f32) m_queue.get_gpu_profiler().get_last_frame_ms();
+
+    const GpuCounters::Frame counters = GpuCounters::collect();
+    m_stats.bytes_uploaded = counters.bytes_uploaded;
+    m_stats.buffers_created = counters.buffers_created;
+    m_stats.bind_groups_created = counters.bind_groups_created;
+    m_stats.pipelines_bound = counters.pipelines_bound;
+
+    PROFILE_COUNTER("Bytes Uploaded", m_stats.bytes_uploaded);
+    PROFILE_COUNTER("Buffers Created", m_stats.buffers_created);
+    PROFILE_COUNTER("Bind Groups Created", m_stats.bind_groups_created);
+    PROFILE_COUNTER("Pipelines Bound", m_stats.pipelines_bound);
+    PROFILE_COUNTER("Batches", m_stats.batches);
+    PROFILE_COUNTER("Instances", m_stats.instances);
+    PROFILE_COUNTER("Draw Calls", m_stats.draw_calls);
+
+    AssetRegistry::update();
+
+    m_render_targets->end_frame();
+
+    // Drop bundles of static batches that are gone or no longer drawn.
+    m_frame_index++;
+    std::erase_if(m_bundle_cache, [&](const auto& entry) {
+        return entry.second.last_used_frame + BUNDLE_RETIRE_FRAMES < m_frame_index;
+    });
 }
 
 
@@ -225,25 +774,19 @@ void Renderer::clear_color(f32 r, f32 g, f32 b, f32 a) {
     };
 }
 
-// RenderPass* Renderer::create_render_pass(const RenderPassDesc& desc) {
-//     m_render_passes.push_back(create_scope<RenderPass>(desc, m_queue));
-//     return m_render_passes.back().get();
-// }
-
 void Renderer::on_resize(u32 width, u32 height) {
     TR_CORE_INFO("Resizing renderer to {}x{}", width, height);
 
-    const auto& device = m_context.get_native_device();
-
-    wgpu::TextureDescriptor depth_texture_desc = {};
-    depth_texture_desc.label = "Z Buffer";
-    depth_texture_desc.usage = wgpu::TextureUsage::RenderAttachment;
-    depth_texture_desc.size = { width, height, 1 };
-    depth_texture_desc.format = m_depth_texture_format;
-    
-    wgpu::Texture depth_texture = device.CreateTexture(&depth_texture_desc);
+    m_viewport_height = std::max(height, 1u);
+    m_surface_width = std::max(width, 1u);
+    m_surface_height = std::max(height, 1u);
+    m_depth_source_dirty = true;
 
-    m_depth_texture_view = depth_texture.CreateView();
+    // Targets are sized when the next frame starts. The first size is
+    // final; later ones may be followed by more while a drag is going on.
+    m_resizing = m_target_width != 0;
+    m_last_resize_frame = m_frame_index;
+    m_targets_frame = ~0ull;
 }
 
 void Renderer::invalidate_surface_view() {
@@ -9,12 +9,14 @@ scope<RendererAPI::RendererAPIData> RendererAPI::s_data = create_scope<RendererA
 
 void RendererAPI::init(WebGPUContext* context) {
     s_data->context = context;
+    AssetRegistry::init();
     s_renderer = create_scope<Renderer>(*s_data->context);
     s_renderer->init();
 }
 
 void RendererAPI::shutdown() {
     s_renderer.reset();
+    AssetRegistry::shutdown();
 }
 
 void RendererAPI::begin_frame() {
@@ -76,6 +78,34 @@ RendererStats& RendererAPI::get_stats_mutable() {
     return s_renderer->get_stats_mutable();
 }
 
+const ref<GeometryArena>& RendererAPI::get_geometry_arena() {
+    return s_renderer->get_geometry_arena();
+}
+
+void RendererAPI::submit(const StaticBatch& batch) {
+    s_renderer->submit(batch);
+}
+
+void RendererAPI::set_lod_threshold(f32 pixels) {
+    s_renderer->set_lod_threshold(pixels);
+}
+
+void RendererAPI::set_render_bundles_enabled(bool enabled) {
+    s_renderer->set_render_bundles_enabled(enabled);
+}
+
+void RendererAPI::set_cluster_culling_enabled(bool enabled) {
+    s_renderer->set_cluster_culling_enabled(enabled);
+}
+
+void RendererAPI::set_occlusion_culling_enabled(bool enabled) {
+    s_renderer->set_occlusion_culling_enabled(enabled);
+}
+
+void RendererAPI::add_render_graph_callback(Renderer::RenderGraphCallback callback) {
+    s_renderer->add_render_graph_callback(std::move(callback));
+}
+
 u64 RendererAPI::create_pipeline(const PipelineSpecification& spec) {
     return s_renderer->create_pipeline(spec);
 }
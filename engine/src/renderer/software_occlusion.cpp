@@ -0,0 +1,373 @@
+#include "terrapch.h"
+#include "terra/renderer/software_occlusion.h"
+#include "terra/core/thread_pool.h"
+#include "terra/debug/profiler.h"
+
+#include <cfloat>
+
+#if defined(__AVX2__)
+    #define TR_OCCLUSION_AVX2 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #define TR_OCCLUSION_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+    #define TR_OCCLUSION_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace terra {
+
+// Edge function through screen points p and q, positive to the left of p -> q.
+static glm::vec3 make_edge(const glm::vec2& p, const glm::vec2& q) {
+    return { p.y - q.y, q.x - p.x, p.x * q.y - p.y * q.x };
+}
+
+// Raises row[x] to the triangle's 1/w at every covered pixel of [x, end).
+// `x` and `end - x` are multiples of the SIMD width, which divides TILE_WIDTH.
+static void rasterize_row(f32* row, i32 x, i32 end, f32 y, const glm::vec3 edges[3], const glm::vec3& inv_w) {
+    f32 e0 = edges[0].x * x + edges[0].y * y + edges[0].z;
+    f32 e1 = edges[1].x * x + edges[1].y * y + edges[1].z;
+    f32 e2 = edges[2].x * x + edges[2].y * y + edges[2].z;
+    f32 z  = inv_w.x * x + inv_w.y * y + inv_w.z;
+
+    // Masked-off lanes contribute 0, which never raises the stored 1/w.
+#if defined(TR_OCCLUSION_AVX2)
+    const __m256 ramp = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 ve0 = _mm256_add_ps(_mm256_set1_ps(e0), _mm256_mul_ps(ramp, _mm256_set1_ps(edges[0].x)));
+    __m256 ve1 = _mm256_add_ps(_mm256_set1_ps(e1), _mm256_mul_ps(ramp, _mm256_set1_ps(edges[1].x)));
+    __m256 ve2 = _mm256_add_ps(_mm256_set1_ps(e2), _mm256_mul_ps(ramp, _mm256_set1_ps(edges[2].x)));
+    __m256 vz  = _mm256_add_ps(_mm256_set1_ps(z),  _mm256_mul_ps(ramp, _mm256_set1_ps(inv_w.x)));
+    const __m256 s0 = _mm256_set1_ps(edges[0].x * 8), s1 = _mm256_set1_ps(edges[1].x * 8);
+    const __m256 s2 = _mm256_set1_ps(edges[2].x * 8), sz = _mm256_set1_ps(inv_w.x * 8);
+
+    for (; x < end; x += 8) {
+        const __m256 inside = _mm256_cmp_ps(_mm256_min_ps(_mm256_min_ps(ve0, ve1), ve2), zero, _CMP_GE_OQ);
+        const __m256 depth = _mm256_loadu_ps(row + x);
+        _mm256_storeu_ps(row + x, _mm256_max_ps(depth, _mm256_and_ps(vz, inside)));
+        ve0 = _mm256_add_ps(ve0, s0);
+        ve1 = _mm256_add_ps(ve1, s1);
+        ve2 = _mm256_add_ps(ve2, s2);
+        vz  = _mm256_add_ps(vz, sz);
+    }
+#elif defined(TR_OCCLUSION_SSE2)
+    const __m128 ramp = _mm_setr_ps(0, 1, 2, 3);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 ve0 = _mm_add_ps(_mm_set1_ps(e0), _mm_mul_ps(ramp, _mm_set1_ps(edges[0].x)));
+    __m128 ve1 = _mm_add_ps(_mm_set1_ps(e1), _mm_mul_ps(ramp, _mm_set1_ps(edges[1].x)));
+    __m128 ve2 = _mm_add_ps(_mm_set1_ps(e2), _mm_mul_ps(ramp, _mm_set1_ps(edges[2].x)));
+    __m128 vz  = _mm_add_ps(_mm_set1_ps(z),  _mm_mul_ps(ramp, _mm_set1_ps(inv_w.x)));
+    const __m128 s0 = _mm_set1_ps(edges[0].x * 4), s1 = _mm_set1_ps(edges[1].x * 4);
+    const __m128 s2 = _mm_set1_ps(edges[2].x * 4), sz = _mm_set1_ps(inv_w.x * 4);
+
+    for (; x < end; x += 4) {
+        const __m128 inside = _mm_cmpge_ps(_mm_min_ps(_mm_min_ps(ve0, ve1), ve2), zero);
+        const __m128 depth = _mm_loadu_ps(row + x);
+        _mm_storeu_ps(row + x, _mm_max_ps(depth, _mm_and_ps(vz, inside)));
+        ve0 = _mm_add_ps(ve0, s0);
+        ve1 = _mm_add_ps(ve1, s1);
+        ve2 = _mm_add_ps(ve2, s2);
+        vz  = _mm_add_ps(vz, sz);
+    }
+#elif defined(TR_OCCLUSION_NEON)
+    const float ramp_values[4] = { 0, 1, 2, 3 };
+    const float32x4_t ramp = vld1q_f32(ramp_values);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t ve0 = vmlaq_n_f32(vdupq_n_f32(e0), ramp, edges[0].x);
+    float32x4_t ve1 = vmlaq_n_f32(vdupq_n_f32(e1), ramp, edges[1].x);
+    float32x4_t ve2 = vmlaq_n_f32(vdupq_n_f32(e2), ramp, edges[2].x);
+    float32x4_t vz  = vmlaq_n_f32(vdupq_n_f32(z),  ramp, inv_w.x);
+    const float32x4_t s0 = vdupq_n_f32(edges[0].x * 4), s1 = vdupq_n_f32(edges[1].x * 4);
+    const float32x4_t s2 = vdupq_n_f32(edges[2].x * 4), sz = vdupq_n_f32(inv_w.x * 4);
+
+    for (; x < end; x += 4) {
+        const uint32x4_t inside = vcgeq_f32(vminq_f32(vminq_f32(ve0, ve1), ve2), zero);
+        const float32x4_t masked = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vz), inside));
+        vst1q_f32(row + x, vmaxq_f32(vld1q_f32(row + x), masked));
+        ve0 = vaddq_f32(ve0, s0);
+        ve1 = vaddq_f32(ve1, s1);
+        ve2 = vaddq_f32(ve2, s2);
+        vz  = vaddq_f32(vz, sz);
+    }
+#endif
+
+    for (; x < end; ++x) {
+        if (std::min({ e0, e1, e2 }) >= 0.0f)
+            row[x] = std::max(row[x], z);
+        e0 += edges[0].x;
+        e1 += edges[1].x;
+        e2 += edges[2].x;
+        z  += inv_w.x;
+    }
+}
+
+// Whether any of row[x..end] is farther than `nearest` (a smaller 1/w).
+static bool row_has_farther(const f32* row, i32 x, i32 end, f32 nearest) {
+#if defined(TR_OCCLUSION_AVX2)
+    const __m256 limit = _mm256_set1_ps(nearest);
+    for (; x + 8 <= end + 1; x += 8) {
+        if (_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(row + x), limit, _CMP_LT_OQ)))
+            return true;
+    }
+#elif defined(TR_OCCLUSION_SSE2)
+    const __m128 limit = _mm_set1_ps(nearest);
+    for (; x + 4 <= end + 1; x += 4) {
+        if (_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(row + x), limit)))
+            return true;
+    }
+#elif defined(TR_OCCLUSION_NEON)
+    const float32x4_t limit = vdupq_n_f32(nearest);
+    for (; x + 4 <= end + 1; x += 4) {
+        if (vmaxvq_u32(vcltq_f32(vld1q_f32(row + x), limit)))
+            return true;
+    }
+#endif
+
+    for (; x <= end; ++x) {
+        if (row[x] < nearest)
+            return true;
+    }
+    return false;
+}
+
+SoftwareOcclusion::SoftwareOcclusion(u32 width, u32 height, ThreadPool* pool)
+    : m_pool(pool ? *pool : ThreadPool::get())
+{
+    m_tiles_x = std::max((width + TILE_WIDTH - 1) / TILE_WIDTH, 1u);
+    m_tiles_y = std::max((height + TILE_HEIGHT - 1) / TILE_HEIGHT, 1u);
+    m_width = m_tiles_x * TILE_WIDTH;
+    m_height = m_tiles_y * TILE_HEIGHT;
+
+    m_depth.assign((size_t) m_width * m_height, 0.0f);
+    m_bins.resize(m_tiles_x * m_tiles_y);
+}
+
+void SoftwareOcclusion::begin(const glm::mat4& view_projection) {
+    m_view_projection = view_projection;
+    m_triangles.clear();
+    m_rasterized = false;
+    m_stats = {};
+}
+
+void SoftwareOcclusion::add_occluder(const MeshData& mesh, const glm::mat4& transform, u32 lod) {
+    u32 offset = 0;
+    u32 count = mesh.get_index_count();
+    if (lod < mesh.lods.size()) {
+        offset = mesh.lods[lod].index_offset;
+        count = mesh.lods[lod].index_count;
+    }
+
+    add_occluder(mesh.vertices.data(), mesh.vertex_stride, { mesh.indices.data() + offset, count }, transform);
+}
+
+void SoftwareOcclusion::add_occluder(const f32* vertices, u32 vertex_stride, std::span<const u32> indices, const glm::mat4& transform) {
+    PROFILE_FUNCTION();
+
+    if (indices.empty())
+        return;
+
+    const glm::mat4 to_clip = m_view_projection * transform;
+
+    // Shared vertices are transformed once, not per triangle.
+    const u32 vertex_count = *std::max_element(indices.begin(), indices.end()) + 1;
+    m_clip_vertices.resize(vertex_count);
+    for (u32 v = 0; v < vertex_count; ++v) {
+        const f32* p = &vertices[(size_t) v * vertex_stride];
+        m_clip_vertices[v] = to_clip * glm::vec4(p[0], p[1], p[2], 1.0f);
+    }
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec4 tri[3] = { m_clip_vertices[indices[i]], m_clip_vertices[indices[i + 1]], m_clip_vertices[indices[i + 2]] };
+
+        // Entirely outside one side of the frustum.
+        if ((tri[0].x >  tri[0].w && tri[1].x >  tri[1].w && tri[2].x >  tri[2].w)
+         || (tri[0].x < -tri[0].w && tri[1].x < -tri[1].w && tri[2].x < -tri[2].w)
+         || (tri[0].y >  tri[0].w && tri[1].y >  tri[1].w && tri[2].y >  tri[2].w)
+         || (tri[0].y < -tri[0].w && tri[1].y < -tri[1].w && tri[2].y < -tri[2].w)
+         || (tri[0].z >  tri[0].w && tri[1].z >  tri[1].w && tri[2].z >  tri[2].w))
+            continue;
+
+        add_clipped(tri, 3);
+    }
+}
+
+void SoftwareOcclusion::add_clipped(const glm::vec4* clip, u32 count) {
+    // Against the near plane (z >= -w), which keeps w positive and bounded
+    // away from 0. A triangle clips to at most a quad.
+    glm::vec4 polygon[4];
+    u32 size = 0;
+
+    for (u32 i = 0; i < count; ++i) {
+        const glm::vec4& a = clip[i];
+        const glm::vec4& b = clip[(i + 1) % count];
+        const f32 da = a.z + a.w;
+        const f32 db = b.z + b.w;
+
+        if (da >= 0.0f)
+            polygon[size++] = a;
+        if ((da >= 0.0f) != (db >= 0.0f))
+            polygon[size++] = a + (b - a) * (da / (da - db));
+    }
+
+    for (u32 i = 1; i + 1 < size; ++i)
+        add_screen_triangle(polygon[0], polygon[i], polygon[i + 1]);
+}
+
+void SoftwareOcclusion::add_screen_triangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+    const glm::vec4* clip[3] = { &a, &b, &c };
+
+    glm::vec2 p[3];
+    glm::vec3 inv_w;
+    for (u32 i = 0; i < 3; ++i) {
+        const f32 rw = 1.0f / clip[i]->w;
+        p[i] = { (clip[i]->x * rw * 0.5f + 0.5f) * m_width, (0.5f - clip[i]->y * rw * 0.5f) * m_height };
+        inv_w[i] = rw;
+    }
+
+    Triangle tri;
+    tri.edges[0] = make_edge(p[1], p[2]);
+    tri.edges[1] = make_edge(p[2], p[0]);
+    tri.edges[2] = make_edge(p[0], p[1]);
+
+    f32 area = glm::dot(tri.edges[2], glm::vec3(p[2], 1.0f));
+    if (std::abs(area) < 1e-6f)
+        return;
+
+    // Double-sided: flip clockwise triangles so inside is always positive.
+    if (area < 0.0f) {
+        for (glm::vec3& e : tri.edges)
+            e = -e;
+        area = -area;
+    }
+
+    // Barycentrics are the edge functions over the area, so 1/w is a plane too.
+    tri.inv_w = (tri.edges[0] * inv_w[0] + tri.edges[1] * inv_w[1] + tri.edges[2] * inv_w[2]) / area;
+
+    // Sample at pixel centres from integer coordinates.
+    for (glm::vec3& e : tri.edges)
+        e.z += 0.5f * (e.x + e.y);
+    tri.inv_w.z += 0.5f * (tri.inv_w.x + tri.inv_w.y);
+
+    const glm::vec2 lo = glm::min(p[0], glm::min(p[1], p[2]));
+    const glm::vec2 hi = glm::max(p[0], glm::max(p[1], p[2]));
+    tri.min_x = std::max((i32) std::ceil(lo.x - 0.5f), 0);
+    tri.min_y = std::max((i32) std::ceil(lo.y - 0.5f), 0);
+    tri.max_x = std::min((i32) std::floor(hi.x - 0.5f), (i32) m_width - 1);
+    tri.max_y = std::min((i32) std::floor(hi.y - 0.5f), (i32) m_height - 1);
+    if (tri.min_x > tri.max_x || tri.min_y > tri.max_y)
+        return;
+
+    m_triangles.push_back(tri);
+}
+
+void SoftwareOcclusion::rasterize() {
+    PROFILE_FUNCTION();
+
+    for (auto& bin : m_bins)
+        bin.clear();
+
+    m_stats.occluder_triangles = (u32) m_triangles.size();
+
+    {
+        PROFILE_SCOPE("Bin Triangles");
+
+        for (u32 i = 0; i < m_triangles.size(); ++i) {
+            const Triangle& tri = m_triangles[i];
+            for (u32 ty = tri.min_y / TILE_HEIGHT; ty <= tri.max_y / TILE_HEIGHT; ++ty) {
+                for (u32 tx = tri.min_x / TILE_WIDTH; tx <= tri.max_x / TILE_WIDTH; ++tx)
+                    m_bins[ty * m_tiles_x + tx].push_back(i);
+            }
+        }
+    }
+
+    for (const auto& bin : m_bins)
+        m_stats.binned_triangles += (u32) bin.size();
+
+    // Tiles own disjoint pixels, so they need no synchronisation.
+    m_pool.parallel_for(m_tiles_x * m_tiles_y, [this](u32 tile) { rasterize_tile(tile); });
+
+    m_rasterized = true;
+}
+
+void SoftwareOcclusion::rasterize_tile(u32 tile) {
+    const i32 tile_x = (i32) (tile % m_tiles_x * TILE_WIDTH);
+    const i32 tile_y = (i32) (tile / m_tiles_x * TILE_HEIGHT);
+
+    for (u32 y = 0; y < TILE_HEIGHT; ++y)
+        std::fill_n(&m_depth[(size_t) (tile_y + y) * m_width + tile_x], TILE_WIDTH, 0.0f);
+
+    // Whole SIMD groups from the triangle's first column; the edge
+    // functions reject the extra pixels, which all lie inside the tile.
+    constexpr i32 GROUP = 8;
+    static_assert(TILE_WIDTH % GROUP == 0);
+
+    for (u32 index : m_bins[tile]) {
+        const Triangle& tri = m_triangles[index];
+
+        const i32 x0 = std::max(tri.min_x, tile_x) / GROUP * GROUP;
+        const i32 x1 = std::min(tri.max_x + 1, tile_x + (i32) TILE_WIDTH);
+        const i32 end = x0 + (x1 - x0 + GROUP - 1) / GROUP * GROUP;
+        const i32 y0 = std::max(tri.min_y, tile_y);
+        const i32 y1 = std::min(tri.max_y + 1, tile_y + (i32) TILE_HEIGHT);
+
+        for (i32 y = y0; y < y1; ++y)
+            rasterize_row(&m_depth[(size_t) y * m_width], x0, end, (f32) y, tri.edges, tri.inv_w);
+    }
+}
+
+bool SoftwareOcclusion::is_visible(const BoundingBox& world_bounds) const {
+    return test_box(world_bounds, m_view_projection);
+}
+
+bool SoftwareOcclusion::is_visible(const BoundingBox& local_bounds, const glm::mat4& transform) const {
+    return test_box(local_bounds, m_view_projection * transform);
+}
+
+bool SoftwareOcclusion::test_box(const BoundingBox& bounds, const glm::mat4& to_clip) const {
+    TR_CORE_ASSERT(m_rasterized, "SoftwareOcclusion queried before rasterize()");
+
+    glm::vec2 lo(FLT_MAX), hi(-FLT_MAX);
+    f32 nearest = 0.0f; // largest 1/w of the corners
+    u32 behind = 0;
+
+    for (u32 i = 0; i < 8; ++i) {
+        const glm::vec3 corner(
+            i & 1 ? bounds.max.x : bounds.min.x,
+            i & 2 ? bounds.max.y : bounds.min.y,
+            i & 4 ? bounds.max.z : bounds.min.z);
+        const glm::vec4 clip = to_clip * glm::vec4(corner, 1.0f);
+
+        if (clip.z < -clip.w) {
+            behind++;
+            continue;
+        }
+
+        const f32 rw = 1.0f / clip.w;
+        const glm::vec2 ndc = glm::vec2(clip) * rw;
+        lo = glm::min(lo, ndc);
+        hi = glm::max(hi, ndc);
+        nearest = std::max(nearest, rw);
+    }
+
+    // Wholly before the near plane is out of view; partly is never occluded.
+    if (behind > 0)
+        return behind < 8;
+
+    if (hi.x < -1.0f || lo.x > 1.0f || hi.y < -1.0f || lo.y > 1.0f)
+        return false;
+
+    // Every pixel the rectangle touches; rows run top to bottom.
+    const i32 x0 = std::clamp((i32) std::floor((lo.x * 0.5f + 0.5f) * m_width), 0, (i32) m_width - 1);
+    const i32 x1 = std::clamp((i32) std::floor((hi.x * 0.5f + 0.5f) * m_width), 0, (i32) m_width - 1);
+    const i32 y0 = std::clamp((i32) std::floor((0.5f - hi.y * 0.5f) * m_height), 0, (i32) m_height - 1);
+    const i32 y1 = std::clamp((i32) std::floor((0.5f - lo.y * 0.5f) * m_height), 0, (i32) m_height - 1);
+
+    for (i32 y = y0; y <= y1; ++y) {
+        if (row_has_farther(&m_depth[(size_t) y * m_width], x0, x1, nearest))
+            return true;
+    }
+    return false;
+}
+
+} // namespace terra
@@ -0,0 +1,58 @@
+#include "terrapch.h"
+#include "terra/renderer/static_batch.h"
+#include "terra/renderer/gpu_counters.h"
+#include "terra/renderer/mesh.h"
+#include "terra/renderer/renderer_api.h"
+#include "terra/resources/asset_registry.h"
+#include "terra/core/revision.h"
+#include "terra/core/context/command_queue.h"
+#include "terra/debug/profiler.h"
+
+namespace terra {
+
+StaticBatch::StaticBatch(const std::vector<StaticChunk>& chunks, const void* instance, u32 instance_size, u32 binding, u32 group)
+    : m_instance_size(instance_size), m_binding(binding), m_group(group)
+{
+    PROFILE_FUNCTION();
+
+    u32 objects = 0;
+    u32 vertices = 0;
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const StaticChunk& chunk = chunks[i];
+
+        ref<Mesh> mesh = Mesh::from_data(chunk.mesh, "Static Batch Chunk");
+        if (!mesh)
+            continue;
+
+        m_chunks.push_back({ AssetRegistry::add_mesh(std::move(mesh)), chunk.material, chunk.bounds });
+        objects += chunk.object_count;
+        vertices += chunk.mesh.get_vertex_count();
+    }
+
+    m_instance_buffer = Buffer::create_storage_buffer(RendererAPI::get_context(), instance, instance_size, binding, "Static Batch Instance").buffer;
+    m_id = m_revision = next_revision();
+
+    TR_CORE_INFO("StaticBatch: {} objects in {} chunks ({} vertices)", objects, m_chunks.size(), vertices);
+}
+
+StaticBatch::~StaticBatch() {
+    for (const Chunk& chunk : m_chunks)
+        AssetRegistry::release(chunk.mesh);
+}
+
+void StaticBatch::set_instance(const void* instance, u32 instance_size) {
+    auto& ctx = RendererAPI::get_context();
+
+    if (instance_size == m_instance_size) {
+        ctx.get_queue()->get_native_queue().WriteBuffer(m_instance_buffer, 0, instance, instance_size);
+        GpuCounters::add_upload(instance_size);
+        return;
+    }
+
+    m_instance_buffer = Buffer::create_storage_buffer(ctx, instance, instance_size, m_binding, "Static Batch Instance").buffer;
+    m_instance_size = instance_size;
+    m_revision = next_revision();
+}
+
+} // namespace terra
@@ -0,0 +1,316 @@
+#include "terra/resources/asset_registry.h"
+#include "terra/core/thread_pool.h"
+#include "terra/debug/profiler.h"
+#include "terra/helpers/hash.h"
+#include "terra/renderer/mesh.h"
+#include "terra/renderer/material_instance.h"
+#include "terra/resources/resource_manager.h"
+#include "terra/resources/mesh_format.h"
+#include "terra/resources/virtual_file_system.h"
+
+namespace terra {
+
+scope<AssetRegistry::RegistryData> AssetRegistry::s_data = create_scope<AssetRegistry::RegistryData>();
+
+static std::string normalize_asset_path(const std::filesystem::path& path) {
+    return path.lexically_normal().generic_string();
+}
+
+void AssetRegistry::init() {
+    s_data = create_scope<RegistryData>();
+}
+
+void AssetRegistry::shutdown() {
+    if (!s_data) return;
+
+    TR_CORE_INFO("AssetRegistry shutting down ({} meshes, {} materials still loaded)",
+        s_data->meshes.size(), s_data->materials.size());
+
+    // Workers never touch registry state, so in-flight decodes can simply be dropped.
+    s_data->pending_loads.clear();
+    s_data->pending_unloads.clear();
+    s_data->mesh_by_path.clear();
+    s_data->mesh_by_content.clear();
+    s_data->mesh_keys.clear();
+    s_data->meshes.clear();
+    s_data->materials.clear();
+}
+
+void AssetRegistry::update() {
+    PROFILE_FUNCTION();
+
+    finish_pending_loads();
+
+    u64 frame = ++s_data->frame_index;
+    auto& pending = s_data->pending_unloads;
+
+    auto it = std::remove_if(pending.begin(), pending.end(), [frame](const PendingUnload& p) {
+        if (frame - p.release_frame < UNLOAD_DELAY_FRAMES)
+            return false;
+
+        if (p.kind == AssetKind::Mesh) {
+            MeshHandle handle{ p.handle };
+            // Re-acquired during the grace period: keep it.
+            if (s_data->meshes.get_ref_count(handle) == 0)
+                unload_mesh(handle);
+        } else {
+            MaterialHandle handle{ p.handle };
+            if (s_data->materials.get_ref_count(handle) == 0)
+                s_data->materials.destroy(handle);
+        }
+        return true;
+    });
+    pending.erase(it, pending.end());
+}
+
+// Reads the cooked .tmesh when one is mounted, otherwise the source file. A
+// source on a mount that shadows the cooked one (the loose overlay in Debug)
+// wins, so edits show up without recooking.
+static FileData read_mesh_asset(const std::string& key, bool& is_cooked) {
+    const std::string cooked_path = get_cooked_mesh_path(key);
+    if (cooked_path == key) {
+        is_cooked = true;
+    } else {
+        const i32 cooked_mount = VirtualFileSystem::find_mount(cooked_path);
+        const i32 source_mount = VirtualFileSystem::find_mount(key);
+        is_cooked = cooked_mount >= 0 && (source_mount < 0 || cooked_mount <= source_mount);
+    }
+    return ResourceManager::read_file(is_cooked ? cooked_path : key);
+}
+
+// Thread-safe: touches nothing but the file contents.
+static bool decode_mesh_asset(const FileData& file, bool is_cooked, const std::string& key, MeshData& data) {
+    if (is_cooked) {
+        if (!read_mesh_file(file.data(), file.size(), data)) {
+            TR_CORE_ERROR("AssetRegistry: '{}' is not a valid cooked mesh", get_cooked_mesh_path(key));
+            return false;
+        }
+        return true;
+    }
+    return ResourceManager::import_geometry(file.as_string(), key, data);
+}
+
+MeshHandle AssetRegistry::find_loaded_mesh(const std::string& key) {
+    if (auto it = s_data->mesh_by_path.find(key); it != s_data->mesh_by_path.end()) {
+        if (s_data->meshes.acquire(it->second) > 0)
+            return it->second;
+        s_data->mesh_by_path.erase(it);
+    }
+    return {};
+}
+
+MeshHandle AssetRegistry::find_mesh_by_content(u64 content_hash, const FileData& file) {
+    auto it = s_data->mesh_by_content.find(content_hash);
+    if (it == s_data->mesh_by_content.end())
+        return {};
+
+    if (!s_data->meshes.is_loaded(it->second)) {
+        s_data->mesh_by_content.erase(it);
+        return {};
+    }
+
+    // A 64-bit hash match alone would let a collision alias two different
+    // meshes, so confirm against the other asset's bytes before sharing.
+    const MeshKeys& keys = s_data->mesh_keys[it->second];
+    if (keys.content_size != file.size())
+        return {};
+
+    bool is_cooked = false;
+    FileData other = read_mesh_asset(keys.path, is_cooked);
+    if (!other || other.size() != file.size() || std::memcmp(other.data(), file.data(), file.size()) != 0)
+        return {};
+
+    return it->second;
+}
+
+MeshHandle AssetRegistry::load_mesh(const std::filesystem::path& path) {
+    PROFILE_FUNCTION();
+
+    std::string key = normalize_asset_path(path);
+
+    if (MeshHandle existing = find_loaded_mesh(key); existing.is_valid())
+        return existing;
+
+    bool is_cooked = false;
+    FileData file = read_mesh_asset(key, is_cooked);
+    if (!file || file.size() == 0) {
+        TR_CORE_ERROR("AssetRegistry: could not read mesh '{}'", key);
+        return {};
+    }
+
+    u64 content_hash = hash_bytes(file.data(), file.size());
+
+    if (MeshHandle same = find_mesh_by_content(content_hash, file); same.is_valid()) {
+        TR_CORE_TRACE("AssetRegistry: '{}' has the same contents as '{}', sharing it",
+            key, s_data->mesh_keys[same].path);
+        s_data->meshes.acquire(same);
+        s_data->mesh_by_path[key] = same;
+        return same;
+    }
+
+    MeshData data;
+    ref<Mesh> mesh = decode_mesh_asset(file, is_cooked, key, data) ? Mesh::from_data(data, key) : nullptr;
+
+    if (!mesh) {
+        TR_CORE_ERROR("AssetRegistry: failed to load mesh '{}'", key);
+        return {};
+    }
+
+    MeshHandle handle = s_data->meshes.insert(std::move(mesh));
+    s_data->mesh_by_path[key] = handle;
+    s_data->mesh_by_content[content_hash] = handle;
+    s_data->mesh_keys[handle] = { key, content_hash, file.size() };
+
+    return handle;
+}
+
+MeshHandle AssetRegistry::load_mesh_async(const std::filesystem::path& path) {
+    PROFILE_FUNCTION();
+
+    std::string key = normalize_asset_path(path);
+
+    // Also catches a load of the same path that is still in flight.
+    if (MeshHandle existing = find_loaded_mesh(key); existing.is_valid())
+        return existing;
+
+    MeshHandle handle = s_data->meshes.insert(nullptr);
+    s_data->mesh_by_path[key] = handle;
+    s_data->mesh_keys[handle] = { key, 0 };
+
+    auto future = ThreadPool::get().submit([key]() {
+        PROFILE_SCOPE("AssetRegistry::decode_mesh");
+
+        DecodedMesh decoded;
+        bool is_cooked = false;
+        FileData file = read_mesh_asset(key, is_cooked);
+        if (!file || file.size() == 0)
+            return decoded;
+
+        decoded.content_hash = hash_bytes(file.data(), file.size());
+        decoded.ok = decode_mesh_asset(file, is_cooked, key, decoded.data);
+        decoded.file = std::move(file);
+        return decoded;
+    });
+
+    s_data->pending_loads.push_back({ handle, std::move(future) });
+    return handle;
+}
+
+void AssetRegistry::finish_pending_loads() {
+    PROFILE_FUNCTION();
+
+    auto& loads = s_data->pending_loads;
+
+    auto it = std::remove_if(loads.begin(), loads.end(), [](PendingLoad& load) {
+        if (load.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+
+        DecodedMesh decoded = load.result.get();
+
+        // Released and unloaded before the worker finished.
+        if (!s_data->meshes.is_alive(load.handle))
+            return true;
+
+        MeshKeys& keys = s_data->mesh_keys[load.handle];
+
+        // Drop the slot and its path mapping so a later load of the path
+        // retries instead of getting a handle that never resolves.
+        if (!decoded.ok) {
+            TR_CORE_ERROR("AssetRegistry: failed to load mesh '{}'", keys.path);
+            unload_mesh(load.handle);
+            return true;
+        }
+
+        if (MeshHandle same = find_mesh_by_content(decoded.content_hash, decoded.file); same.is_valid()) {
+            TR_CORE_TRACE("AssetRegistry: '{}' has the same contents as '{}', sharing it",
+                keys.path, s_data->mesh_keys[same].path);
+            s_data->meshes.set(load.handle, s_data->meshes.get_ref(same));
+            return true;
+        }
+
+        // GPU buffers are created here, on the main thread.
+        s_data->meshes.set(load.handle, Mesh::from_data(decoded.data, keys.path));
+        keys.content_hash = decoded.content_hash;
+        keys.content_size = decoded.file.size();
+        s_data->mesh_by_content[decoded.content_hash] = load.handle;
+        return true;
+    });
+    loads.erase(it, loads.end());
+}
+
+bool AssetRegistry::load_mesh_data(const std::filesystem::path& path, MeshData& out) {
+    PROFILE_FUNCTION();
+
+    const std::string key = normalize_asset_path(path);
+
+    bool is_cooked = false;
+    FileData file = read_mesh_asset(key, is_cooked);
+    return file && decode_mesh_asset(file, is_cooked, key, out);
+}
+
+MeshHandle AssetRegistry::add_mesh(ref<Mesh> mesh, std::string_view name) {
+    TR_CORE_ASSERT(mesh, "Cannot register a null mesh");
+
+    MeshHandle handle = s_data->meshes.insert(std::move(mesh));
+    if (!name.empty()) {
+        std::string key(name);
+        s_data->mesh_by_path[key] = handle;
+        s_data->mesh_keys[handle] = { key, 0 };
+    }
+    return handle;
+}
+
+MaterialHandle AssetRegistry::add_material(ref<MaterialInstance> material) {
+    TR_CORE_ASSERT(material, "Cannot register a null material instance");
+    return s_data->materials.insert(std::move(material));
+}
+
+void AssetRegistry::acquire(MeshHandle handle) {
+    s_data->meshes.acquire(handle);
+}
+
+void AssetRegistry::acquire(MaterialHandle handle) {
+    s_data->materials.acquire(handle);
+}
+
+void AssetRegistry::release(MeshHandle handle) {
+    if (!s_data->meshes.is_alive(handle)) return;
+    if (s_data->meshes.release(handle) == 0)
+        schedule_unload(AssetKind::Mesh, handle.value);
+}
+
+void AssetRegistry::release(MaterialHandle handle) {
+    if (!s_data->materials.is_alive(handle)) return;
+    if (s_data->materials.release(handle) == 0)
+        schedule_unload(AssetKind::Material, handle.value);
+}
+
+void AssetRegistry::schedule_unload(AssetKind kind, u32 handle) {
+    // Released again within the grace period: restart it rather than queueing
+    // a second entry that would fire early.
+    for (PendingUnload& pending : s_data->pending_unloads) {
+        if (pending.kind == kind && pending.handle == handle) {
+            pending.release_frame = s_data->frame_index;
+            return;
+        }
+    }
+    s_data->pending_unloads.push_back({ kind, handle, s_data->frame_index });
+}
+
+void AssetRegistry::unload_mesh(MeshHandle handle) {
+    if (auto it = s_data->mesh_keys.find(handle); it != s_data->mesh_keys.end()) {
+        TR_CORE_TRACE("AssetRegistry: unloading mesh '{}'", it->second.path);
+
+        // Only drop lookup entries that still point at this slot.
+        std::erase_if(s_data->mesh_by_path, [handle](const auto& entry) { return entry.second == handle; });
+        if (auto c = s_data->mesh_by_content.find(it->second.content_hash);
+            c != s_data->mesh_by_content.end() && c->second == handle) {
+            s_data->mesh_by_content.erase(c);
+        }
+        s_data->mesh_keys.erase(it);
+    }
+
+    s_data->meshes.destroy(handle);
+}
+
+} // namespace terra
@@ -0,0 +1,209 @@
+#include "terra/resources/lz4.h"
+
+#include <cstring>
+
+namespace terra::lz4 {
+
+static constexpr size_t MIN_MATCH     = 4;
+static constexpr size_t LAST_LITERALS = 5;  // the block must end with >= 5 literals
+static constexpr size_t MF_LIMIT      = 12; // no match may start in the last 12 bytes
+static constexpr size_t MAX_OFFSET    = 65535;
+static constexpr u32    HASH_LOG      = 16;
+static constexpr u32    NO_POSITION   = 0xFFFFFFFFu;
+
+static inline u32 read_u32(const u8* p) {
+    u32 v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline u32 hash_sequence(u32 sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+// Writes the 255-run continuation bytes of a length that did not fit its nibble.
+static inline bool write_length(u8*& op, const u8* op_end, size_t length) {
+    while (length >= 255) {
+        if (op >= op_end) return false;
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= op_end) return false;
+    *op++ = (u8) length;
+    return true;
+}
+
+static bool write_sequence(
+    u8*& op, const u8* op_end,
+    const u8* literals, size_t literal_length,
+    size_t offset, size_t match_length
+) {
+    if (op >= op_end) return false;
+    u8* token = op++;
+
+    *token = (u8) ((literal_length >= 15 ? 15 : literal_length) << 4);
+    if (literal_length >= 15 && !write_length(op, op_end, literal_length - 15))
+        return false;
+
+    if ((size_t) (op_end - op) < literal_length) return false;
+    std::memcpy(op, literals, literal_length);
+    op += literal_length;
+
+    // The final sequence carries literals only.
+    if (match_length == 0)
+        return true;
+
+    if (op_end - op < 2) return false;
+    *op++ = (u8) (offset & 0xFF);
+    *op++ = (u8) (offset >> 8);
+
+    size_t ml = match_length - MIN_MATCH;
+    *token |= (u8) (ml >= 15 ? 15 : ml);
+    if (ml >= 15 && !write_length(op, op_end, ml - 15))
+        return false;
+
+    return true;
+}
+
+size_t compress(const u8* src, size_t src_size, u8* dst, size_t dst_capacity) {
+    u8* op = dst;
+    const u8* op_end = dst + dst_capacity;
+
+    size_t anchor = 0;
+
+    if (src_size > MF_LIMIT) {
+        std::vector<u32> table(1u << HASH_LOG, NO_POSITION);
+
+        const size_t match_limit = src_size - MF_LIMIT;
+        const size_t extend_limit = src_size - LAST_LITERALS;
+        size_t ip = 0;
+
+        while (ip < match_limit) {
+            u32 sequence = read_u32(src + ip);
+            u32 h = hash_sequence(sequence);
+            u32 candidate = table[h];
+            table[h] = (u32) ip;
+
+            if (candidate == NO_POSITION || ip - candidate > MAX_OFFSET || read_u32(src + candidate) != sequence) {
+                ++ip;
+                continue;
+            }
+
+            size_t match = candidate;
+            size_t length = MIN_MATCH;
+            while (ip + length < extend_limit && src[match + length] == src[ip + length])
+                ++length;
+
+            // Grow the match backwards into pending literals.
+            while (ip > anchor && match > 0 && src[ip - 1] == src[match - 1]) {
+                --ip;
+                --match;
+                ++length;
+            }
+
+            if (!write_sequence(op, op_end, src + anchor, ip - anchor, ip - match, length))
+                return 0;
+
+            ip += length;
+            anchor = ip;
+
+            // Seed the table with the tail of the match so runs chain well.
+            if (ip < match_limit && ip >= 2) {
+                table[hash_sequence(read_u32(src + ip - 2))] = (u32) (ip - 2);
+            }
+        }
+    }
+
+    if (!write_sequence(op, op_end, src + anchor, src_size - anchor, 0, 0))
+        return 0;
+
+    return (size_t) (op - dst);
+}
+
+static inline void copy8(u8* dst, const u8* src) { std::memcpy(dst, src, 8); }
+static inline void copy16(u8* dst, const u8* src) { std::memcpy(dst, src, 16); }
+
+static inline bool read_length(const u8*& ip, const u8* ip_end, size_t& length) {
+    u8 b;
+    do {
+        if (ip >= ip_end) return false;
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+bool decompress(const u8* src, size_t src_size, u8* dst, size_t dst_size) {
+    const u8* ip = src;
+    const u8* ip_end = src + src_size;
+    u8* op = dst;
+    u8* op_end = dst + dst_size;
+
+    // Copies may overshoot by up to this much while at least this much room
+    // is left, which turns most sequences into a couple of fixed-size moves.
+    constexpr size_t WILD = 16;
+
+    while (ip < ip_end) {
+        u8 token = *ip++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(ip, ip_end, literal_length))
+            return false;
+
+        if ((size_t) (ip_end - ip) < literal_length || (size_t) (op_end - op) < literal_length)
+            return false;
+
+        if (literal_length <= WILD && (size_t) (ip_end - ip) >= WILD && (size_t) (op_end - op) >= WILD) {
+            copy16(op, ip);
+        } else {
+            std::memcpy(op, ip, literal_length);
+        }
+        ip += literal_length;
+        op += literal_length;
+
+        if (ip == ip_end)
+            break; // last sequence
+
+        if (ip_end - ip < 2) return false;
+        size_t offset = (size_t) ip[0] | ((size_t) ip[1] << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > (size_t) (op - dst))
+            return false;
+
+        size_t match_length = token & 0x0F;
+        if (match_length == 15 && !read_length(ip, ip_end, match_length))
+            return false;
+        match_length += MIN_MATCH;
+
+        if ((size_t) (op_end - op) < match_length)
+            return false;
+
+        const u8* match = op - offset;
+        u8* copy_end = op + match_length;
+
+        if (offset >= 8 && (size_t) (op_end - copy_end) >= 8) {
+            // Chunks never read bytes this copy has yet to write.
+            do {
+                copy8(op, match);
+                op += 8;
+                match += 8;
+            } while (op < copy_end);
+            op = copy_end;
+        } else if (offset == 1) {
+            std::memset(op, *match, match_length);
+            op = copy_end;
+        } else {
+            // Short period: keep doubling the already-expanded pattern.
+            while (op < copy_end) {
+                size_t n = std::min((size_t) (op - match), (size_t) (copy_end - op));
+                std::memcpy(op, match, n);
+                op += n;
+            }
+        }
+    }
+
+    return op == op_end;
+}
+
+} // namespace terra::lz4
@@ -0,0 +1,272 @@
+#include "terra/resources/mesh_codec.h"
+#include "terra/resources/lz4.h"
+
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #define TR_MESH_CODEC_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+    #define TR_MESH_CODEC_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace terra::mesh_codec {
+
+// -----------------------------------------------------------------------------
+// Filters (encode side, scalar: runs in the cooker)
+// -----------------------------------------------------------------------------
+
+static void split_planes(const u32* words, size_t count, u8* planes) {
+    for (size_t i = 0; i < count; ++i) {
+        u32 w = words[i];
+        planes[i]             = (u8) (w);
+        planes[count + i]     = (u8) (w >> 8);
+        planes[2 * count + i] = (u8) (w >> 16);
+        planes[3 * count + i] = (u8) (w >> 24);
+    }
+}
+
+// Vertex words are delta coded against the word `distance` positions back:
+// the smallest whole number of rows that is also a multiple of four words
+// (stride 6 -> 12). Decoding then works on aligned 4-word vectors whose
+// inputs were stored whole, instead of stalling on partially overlapping
+// store-to-load forwarding.
+static size_t get_delta_distance(size_t stride) {
+    size_t rows = 4 / std::gcd(stride, (size_t) 4);
+    return stride * rows;
+}
+
+static inline u32 zigzag(i32 v) { return ((u32) v << 1) ^ (u32) (v >> 31); }
+
+// Streams are cut into chunks of CHUNK_WORDS words, each its own LZ4 block of
+// byte planes prefixed by its compressed size. A chunk's planes (32 KiB) stay
+// in L1/L2 while being decompressed, interleaved and summed.
+static constexpr size_t CHUNK_WORDS = 8192;
+
+static u32 write_stream(const std::vector<u32>& words, std::vector<u8>& out) {
+    const size_t start = out.size();
+
+    std::vector<u8> planes(CHUNK_WORDS * 4);
+    std::vector<u8> packed(lz4::compress_bound(planes.size()));
+
+    for (size_t first = 0; first < words.size(); first += CHUNK_WORDS) {
+        const size_t count = std::min(CHUNK_WORDS, words.size() - first);
+        split_planes(words.data() + first, count, planes.data());
+
+        u32 packed_size = (u32) lz4::compress(planes.data(), count * 4, packed.data(), packed.size());
+
+        const size_t at = out.size();
+        out.resize(at + sizeof(u32) + packed_size);
+        std::memcpy(out.data() + at, &packed_size, sizeof(u32));
+        std::memcpy(out.data() + at + sizeof(u32), packed.data(), packed_size);
+    }
+
+    return (u32) (out.size() - start);
+}
+
+EncodedSizes encode(const MeshData& mesh, std::vector<u8>& out) {
+    EncodedSizes sizes;
+
+    // Vertices: row delta, then byte planes.
+    {
+        const size_t count = mesh.vertices.size();
+        const size_t distance = get_delta_distance(mesh.vertex_stride);
+
+        std::vector<u32> words(count);
+        std::memcpy(words.data(), mesh.vertices.data(), count * sizeof(u32));
+        for (size_t i = count; i-- > distance;)
+            words[i] -= words[i - distance];
+
+        sizes.vertex_stream = write_stream(words, out);
+    }
+
+    // Indices: zigzag delta, then byte planes.
+    {
+        const size_t count = mesh.indices.size();
+
+        std::vector<u32> words(count);
+        u32 previous = 0;
+        for (size_t i = 0; i < count; ++i) {
+            words[i] = zigzag((i32) (mesh.indices[i] - previous));
+            previous = mesh.indices[i];
+        }
+
+        sizes.index_stream = write_stream(words, out);
+    }
+
+    return sizes;
+}
+
+// -----------------------------------------------------------------------------
+// Decode kernels
+// -----------------------------------------------------------------------------
+
+static void merge_planes(const u8* planes, size_t count, u32* words) {
+    const u8* p0 = planes;
+    const u8* p1 = planes + count;
+    const u8* p2 = planes + 2 * count;
+    const u8* p3 = planes + 3 * count;
+
+    size_t i = 0;
+
+#if defined(TR_MESH_CODEC_SSE2)
+    for (; i + 16 <= count; i += 16) {
+        __m128i b0 = _mm_loadu_si128((const __m128i*) (p0 + i));
+        __m128i b1 = _mm_loadu_si128((const __m128i*) (p1 + i));
+        __m128i b2 = _mm_loadu_si128((const __m128i*) (p2 + i));
+        __m128i b3 = _mm_loadu_si128((const __m128i*) (p3 + i));
+
+        __m128i lo01 = _mm_unpacklo_epi8(b0, b1);
+        __m128i hi01 = _mm_unpackhi_epi8(b0, b1);
+        __m128i lo23 = _mm_unpacklo_epi8(b2, b3);
+        __m128i hi23 = _mm_unpackhi_epi8(b2, b3);
+
+        _mm_storeu_si128((__m128i*) (words + i),      _mm_unpacklo_epi16(lo01, lo23));
+        _mm_storeu_si128((__m128i*) (words + i + 4),  _mm_unpackhi_epi16(lo01, lo23));
+        _mm_storeu_si128((__m128i*) (words + i + 8),  _mm_unpacklo_epi16(hi01, hi23));
+        _mm_storeu_si128((__m128i*) (words + i + 12), _mm_unpackhi_epi16(hi01, hi23));
+    }
+#elif defined(TR_MESH_CODEC_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x2_t z01 = vzipq_u8(vld1q_u8(p0 + i), vld1q_u8(p1 + i));
+        uint8x16x2_t z23 = vzipq_u8(vld1q_u8(p2 + i), vld1q_u8(p3 + i));
+
+        uint16x8x2_t lo = vzipq_u16(vreinterpretq_u16_u8(z01.val[0]), vreinterpretq_u16_u8(z23.val[0]));
+        uint16x8x2_t hi = vzipq_u16(vreinterpretq_u16_u8(z01.val[1]), vreinterpretq_u16_u8(z23.val[1]));
+
+        vst1q_u32(words + i,      vreinterpretq_u32_u16(lo.val[0]));
+        vst1q_u32(words + i + 4,  vreinterpretq_u32_u16(lo.val[1]));
+        vst1q_u32(words + i + 8,  vreinterpretq_u32_u16(hi.val[0]));
+        vst1q_u32(words + i + 12, vreinterpretq_u32_u16(hi.val[1]));
+    }
+#endif
+
+    for (; i < count; ++i)
+        words[i] = (u32) p0[i] | ((u32) p1[i] << 8) | ((u32) p2[i] << 16) | ((u32) p3[i] << 24);
+}
+
+// words[i] += words[i - distance], with distance a multiple of four.
+static void undo_row_delta(u32* words, size_t begin, size_t end, size_t distance) {
+    size_t i = begin;
+
+#if defined(TR_MESH_CODEC_SSE2)
+    for (; i + 4 <= end; i += 4) {
+        __m128i cur = _mm_loadu_si128((const __m128i*) (words + i));
+        __m128i prev = _mm_loadu_si128((const __m128i*) (words + i - distance));
+        _mm_storeu_si128((__m128i*) (words + i), _mm_add_epi32(cur, prev));
+    }
+#elif defined(TR_MESH_CODEC_NEON)
+    for (; i + 4 <= end; i += 4)
+        vst1q_u32(words + i, vaddq_u32(vld1q_u32(words + i), vld1q_u32(words + i - distance)));
+#endif
+
+    for (; i < end; ++i)
+        words[i] += words[i - distance];
+}
+
+// Undoes zigzag and runs the inclusive prefix sum that restores the indices.
+static void undo_index_delta(u32* words, size_t count, u32 previous) {
+    size_t i = 0;
+
+#if defined(TR_MESH_CODEC_SSE2)
+    __m128i carry = _mm_set1_epi32((int) previous);
+    const __m128i one = _mm_set1_epi32(1);
+    for (; i + 4 <= count; i += 4) {
+        __m128i z = _mm_loadu_si128((const __m128i*) (words + i));
+        __m128i d = _mm_xor_si128(_mm_srli_epi32(z, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(z, one)));
+
+        d = _mm_add_epi32(d, _mm_slli_si128(d, 4));
+        d = _mm_add_epi32(d, _mm_slli_si128(d, 8));
+        d = _mm_add_epi32(d, carry);
+
+        _mm_storeu_si128((__m128i*) (words + i), d);
+        carry = _mm_shuffle_epi32(d, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    if (i > 0) previous = words[i - 1];
+#elif defined(TR_MESH_CODEC_NEON)
+    uint32x4_t carry = vdupq_n_u32(previous);
+    const uint32x4_t zero = vdupq_n_u32(0);
+    const uint32x4_t one = vdupq_n_u32(1);
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t z = vld1q_u32(words + i);
+        uint32x4_t d = veorq_u32(vshrq_n_u32(z, 1), vsubq_u32(zero, vandq_u32(z, one)));
+
+        d = vaddq_u32(d, vextq_u32(zero, d, 3));
+        d = vaddq_u32(d, vextq_u32(zero, d, 2));
+        d = vaddq_u32(d, carry);
+
+        vst1q_u32(words + i, d);
+        carry = vdupq_n_u32(vgetq_lane_u32(d, 3));
+    }
+    if (i > 0) previous = words[i - 1];
+#endif
+
+    for (; i < count; ++i) {
+        u32 z = words[i];
+        previous += (z >> 1) ^ (0u - (z & 1));
+        words[i] = previous;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+// Walks the chunks of a stream, handing each decoded word range to `finish`.
+template<typename Finish>
+static bool read_stream(const u8* stream, size_t stream_size, u32* words, size_t word_count, Finish&& finish) {
+    alignas(16) thread_local u8 planes[CHUNK_WORDS * 4];
+
+    const u8* ip = stream;
+    const u8* ip_end = stream + stream_size;
+
+    for (size_t first = 0; first < word_count; first += CHUNK_WORDS) {
+        const size_t count = std::min(CHUNK_WORDS, word_count - first);
+
+        u32 packed_size;
+        if (ip_end - ip < (ptrdiff_t) sizeof(u32)) return false;
+        std::memcpy(&packed_size, ip, sizeof(u32));
+        ip += sizeof(u32);
+
+        if ((size_t) (ip_end - ip) < packed_size) return false;
+        if (!lz4::decompress(ip, packed_size, planes, count * 4)) return false;
+        ip += packed_size;
+
+        merge_planes(planes, count, words + first);
+        finish(first, count);
+    }
+
+    return ip == ip_end;
+}
+
+bool decode_vertices(const u8* stream, size_t stream_size, u32 vertex_stride, f32* vertices, size_t vertex_float_count) {
+    if (vertex_stride == 0)
+        return false;
+
+    const size_t distance = get_delta_distance(vertex_stride);
+
+    u32* words = reinterpret_cast<u32*>(vertices);
+    return read_stream(stream, stream_size, words, vertex_float_count, [&](size_t first, size_t count) {
+        // Words before this chunk are final, so the delta can be undone in place.
+        size_t begin = std::max(first, distance);
+        if (first + count > begin)
+            undo_row_delta(words, begin, first + count, distance);
+    });
+}
+
+bool decode_indices(const u8* stream, size_t stream_size, u32* indices, size_t index_count) {
+    return read_stream(stream, stream_size, indices, index_count, [&](size_t first, size_t count) {
+        undo_index_delta(indices + first, count, first > 0 ? indices[first - 1] : 0);
+    });
+}
+
+std::string_view get_simd_path() {
+#if defined(TR_MESH_CODEC_SSE2)
+    return "sse2";
+#elif defined(TR_MESH_CODEC_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace terra::mesh_codec
@@ -0,0 +1,166 @@
+#include "terra/resources/mesh_format.h"
+#include "terra/resources/mesh_codec.h"
+
+namespace terra {
+
+std::vector<u8> write_mesh_file(const MeshData& mesh, bool compress) {
+    MeshFileHeader header;
+    header.vertex_count = mesh.get_vertex_count();
+    header.index_count = mesh.get_index_count();
+    header.vertex_stride = mesh.vertex_stride;
+
+    const size_t vertex_bytes = (size_t) header.vertex_count * header.vertex_stride * sizeof(f32);
+    const size_t index_bytes = (size_t) header.index_count * sizeof(u32);
+
+    // Everything between the header and the geometry.
+    const u32 lod_count = (u32) mesh.lods.size();
+    const size_t lod_bytes = lod_count ? sizeof(u32) + lod_count * sizeof(MeshLod) : 0;
+    const u32 meshlet_count = (u32) mesh.meshlets.size();
+    const size_t meshlet_bytes = meshlet_count ? sizeof(u32) + meshlet_count * sizeof(Meshlet) : 0;
+    const u32 prefix_flags = (lod_count ? MeshFileFlags_Lods : MeshFileFlags_None)
+                       | (meshlet_count ? MeshFileFlags_Meshlets : MeshFileFlags_None);
+
+    auto write_prefix = [&](std::vector<u8>& out) {
+        std::memcpy(out.data(), &header, sizeof(header));
+        size_t at = sizeof(header);
+        if (lod_count) {
+            std::memcpy(out.data() + at, &lod_count, sizeof(u32));
+            std::memcpy(out.data() + at + sizeof(u32), mesh.lods.data(), lod_count * sizeof(MeshLod));
+            at += lod_bytes;
+        }
+        if (meshlet_count) {
+            std::memcpy(out.data() + at, &meshlet_count, sizeof(u32));
+            std::memcpy(out.data() + at + sizeof(u32), mesh.meshlets.data(), meshlet_count * sizeof(Meshlet));
+        }
+    };
+
+    const size_t prefix = sizeof(header) + lod_bytes + meshlet_bytes;
+
+    if (compress) {
+        header.flags = MeshFileFlags_Compressed | prefix_flags;
+
+        std::vector<u8> out(prefix + 2 * sizeof(u32));
+        mesh_codec::EncodedSizes sizes = mesh_codec::encode(mesh, out);
+
+        if (out.size() < prefix + vertex_bytes + index_bytes) {
+            write_prefix(out);
+            std::memcpy(out.data() + prefix, &sizes.vertex_stream, sizeof(u32));
+            std::memcpy(out.data() + prefix + sizeof(u32), &sizes.index_stream, sizeof(u32));
+            return out;
+        }
+    }
+
+    header.flags = prefix_flags;
+
+    std::vector<u8> out(prefix + vertex_bytes + index_bytes);
+    write_prefix(out);
+    std::memcpy(out.data() + prefix, mesh.vertices.data(), vertex_bytes);
+    std::memcpy(out.data() + prefix + vertex_bytes, mesh.indices.data(), index_bytes);
+    return out;
+}
+
+// Everything that walks the geometry on the CPU (simplifier, static batching,
+// software occlusion) indexes the vertex array without checking.
+static bool indices_in_range(const std::vector<u32>& indices, u32 vertex_count) {
+    return std::all_of(indices.begin(), indices.end(), [vertex_count](u32 index) { return index < vertex_count; });
+}
+
+bool read_mesh_file(const u8* data, size_t size, MeshData& out) {
+    if (size < sizeof(MeshFileHeader))
+        return false;
+
+    MeshFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    // Version 1 files are the uncompressed layout without flags.
+    if (header.magic != MESH_FILE_MAGIC || header.version == 0 || header.version > MESH_FILE_VERSION || header.vertex_stride == 0)
+        return false;
+
+    const size_t vertex_floats = (size_t) header.vertex_count * header.vertex_stride;
+    const size_t vertex_bytes = vertex_floats * sizeof(f32);
+    const size_t index_bytes = (size_t) header.index_count * sizeof(u32);
+
+    size_t offset = sizeof(header);
+    out.lods.clear();
+
+    if (header.flags & MeshFileFlags_Lods) {
+        u32 lod_count = 0;
+        if (size < offset + sizeof(u32))
+            return false;
+        std::memcpy(&lod_count, data + offset, sizeof(u32));
+        offset += sizeof(u32);
+
+        if (lod_count == 0 || lod_count > MAX_MESH_LODS || size < offset + lod_count * sizeof(MeshLod))
+            return false;
+
+        out.lods.resize(lod_count);
+        std::memcpy(out.lods.data(), data + offset, lod_count * sizeof(MeshLod));
+        offset += lod_count * sizeof(MeshLod);
+
+        for (const MeshLod& lod : out.lods) {
+            if ((u64) lod.index_offset + lod.index_count > header.index_count)
+                return false;
+        }
+    }
+
+    out.meshlets.clear();
+
+    if (header.flags & MeshFileFlags_Meshlets) {
+        u32 meshlet_count = 0;
+        if (size < offset + sizeof(u32))
+            return false;
+        std::memcpy(&meshlet_count, data + offset, sizeof(u32));
+        offset += sizeof(u32);
+
+        if (size < offset + (u64) meshlet_count * sizeof(Meshlet))
+            return false;
+
+        out.meshlets.resize(meshlet_count);
+        std::memcpy(out.meshlets.data(), data + offset, meshlet_count * sizeof(Meshlet));
+        offset += meshlet_count * sizeof(Meshlet);
+
+        for (const Meshlet& meshlet : out.meshlets) {
+            if (meshlet.triangle_count > MESHLET_MAX_TRIANGLES || (u64) meshlet.index_offset + 3ull * meshlet.triangle_count > header.index_count)
+                return false;
+        }
+    }
+
+    if (header.flags & MeshFileFlags_Compressed) {
+        if (size < offset + 2 * sizeof(u32))
+            return false;
+
+        u32 vertex_stream = 0, index_stream = 0;
+        std::memcpy(&vertex_stream, data + offset, sizeof(u32));
+        std::memcpy(&index_stream, data + offset + sizeof(u32), sizeof(u32));
+
+        const u8* streams = data + offset + 2 * sizeof(u32);
+        if ((size_t) (streams - data) + vertex_stream + index_stream > size)
+            return false;
+
+        out.vertex_stride = header.vertex_stride;
+        out.vertices.resize(vertex_floats);
+        out.indices.resize(header.index_count);
+
+        return mesh_codec::decode_vertices(streams, vertex_stream, header.vertex_stride, out.vertices.data(), vertex_floats)
+            && mesh_codec::decode_indices(streams + vertex_stream, index_stream, out.indices.data(), out.indices.size())
+            && indices_in_range(out.indices, header.vertex_count);
+    }
+
+    if (offset + vertex_bytes + index_bytes > size)
+        return false;
+
+    out.vertex_stride = header.vertex_stride;
+    out.vertices.resize(vertex_floats);
+    out.indices.resize(header.index_count);
+    std::memcpy(out.vertices.data(), data + offset, vertex_bytes);
+    std::memcpy(out.indices.data(), data + offset + vertex_bytes, index_bytes);
+    return indices_in_range(out.indices, header.vertex_count);
+}
+
+std::string get_cooked_mesh_path(std::string_view source_path) {
+    std::filesystem::path path(source_path);
+    path.replace_extension(MESH_FILE_EXTENSION);
+    return path.generic_string();
+}
+
+} // namespace terra
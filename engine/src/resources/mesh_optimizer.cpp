@@ -0,0 +1,321 @@
+#include "terra/resources/mesh_optimizer.h"
+#include "terra/debug/profiler.h"
+
+#include <glm/glm.hpp>
+
+namespace terra::mesh_optimizer {
+
+// FIFO cache model shared by the analysis and the optimizers: a vertex is
+// resident while fewer than `cache_size` other vertices were inserted after
+// it. Bumping the timestamp by cache_size + 1 empties the cache.
+struct FifoCache {
+    std::vector<u32> insert_time;
+    u32 timestamp;
+    u32 size;
+
+    FifoCache(size_t vertex_count, u32 cache_size)
+        : insert_time(vertex_count, 0), timestamp(cache_size + 1), size(cache_size) {}
+
+    bool contains(u32 v) const { return timestamp - insert_time[v] <= size; }
+
+    // Returns true on a miss.
+    bool access(u32 v) {
+        if (contains(v))
+            return false;
+        insert_time[v] = timestamp++;
+        return true;
+    }
+
+    void flush() { timestamp += size + 1; }
+};
+
+CacheStats analyze_vertex_cache(std::span<const u32> indices, size_t vertex_count, u32 cache_size) {
+    CacheStats stats;
+    if (indices.empty() || vertex_count == 0)
+        return stats;
+
+    FifoCache cache(vertex_count, cache_size);
+    std::vector<u8> referenced(vertex_count, 0);
+    u32 unique = 0;
+
+    for (u32 v : indices) {
+        if (v >= vertex_count) continue;
+
+        stats.transformed += cache.access(v) ? 1 : 0;
+        if (!referenced[v]) {
+            referenced[v] = 1;
+            ++unique;
+        }
+    }
+
+    stats.acmr = (f32) stats.transformed / (f32) (indices.size() / 3);
+    stats.atvr = unique ? (f32) stats.transformed / (f32) unique : 0.0f;
+    return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Tipsify
+// -----------------------------------------------------------------------------
+
+void optimize_vertex_cache(std::span<u32> dst, std::span<const u32> indices, size_t vertex_count,
+    u32 cache_size, std::vector<u32>* clusters)
+{
+    PROFILE_FUNCTION();
+
+    TR_CORE_ASSERT(dst.size() == indices.size(), "optimize_vertex_cache: size mismatch");
+    TR_CORE_ASSERT(dst.data() != indices.data(), "optimize_vertex_cache: cannot work in place");
+
+    const size_t face_count = indices.size() / 3;
+
+    // Vertex -> triangle adjacency in CSR form; `live` counts triangles not yet emitted.
+    std::vector<u32> live(vertex_count, 0);
+    for (u32 v : indices)
+        ++live[v];
+
+    std::vector<u32> offsets(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; ++v)
+        offsets[v + 1] = offsets[v] + live[v];
+
+    std::vector<u32> adjacency(indices.size());
+    {
+        std::vector<u32> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            adjacency[cursor[indices[i]]++] = (u32) (i / 3);
+    }
+
+    FifoCache cache(vertex_count, cache_size);
+    std::vector<u8> emitted(face_count, 0);
+    std::vector<u32> dead_end;
+    std::vector<u32> candidates;
+    dead_end.reserve(indices.size());
+
+    size_t input_cursor = 0;
+    size_t out = 0;
+
+    // Recently used vertices first, then the next live vertex in input order.
+    auto skip_dead_end = [&]() -> i64 {
+        while (!dead_end.empty()) {
+            u32 v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v] > 0)
+                return v;
+        }
+        while (input_cursor < vertex_count) {
+            if (live[input_cursor] > 0)
+                return (i64) input_cursor;
+            ++input_cursor;
+        }
+        return -1;
+    };
+
+    i64 current = skip_dead_end();
+    bool new_cluster = true;
+
+    while (current >= 0) {
+        if (new_cluster && clusters)
+            clusters->push_back((u32) (out / 3));
+
+        candidates.clear();
+
+        for (u32 k = offsets[current]; k < offsets[current + 1]; ++k) {
+            const u32 t = adjacency[k];
+            if (emitted[t]) continue;
+
+            for (u32 j = 0; j < 3; ++j) {
+                const u32 v = indices[3 * t + j];
+                dst[out++] = v;
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                cache.access(v);
+            }
+            emitted[t] = 1;
+        }
+
+        // Prefer the candidate that has been in the cache longest but will
+        // still be resident after its remaining triangles are emitted.
+        i64 best = -1;
+        i64 best_priority = -1;
+        for (u32 v : candidates) {
+            if (live[v] == 0) continue;
+
+            i64 priority = 0;
+            const i64 age = (i64) cache.timestamp - cache.insert_time[v];
+            if (age + 2 * (i64) live[v] <= (i64) cache_size)
+                priority = age;
+
+            if (priority > best_priority) {
+                best = v;
+                best_priority = priority;
+            }
+        }
+
+        new_cluster = best < 0;
+        current = best >= 0 ? best : skip_dead_end();
+    }
+
+    TR_CORE_ASSERT(out == indices.size(), "Tipsify did not emit every triangle");
+}
+
+// -----------------------------------------------------------------------------
+// Overdraw
+// -----------------------------------------------------------------------------
+
+u32 optimize_overdraw(std::span<u32> indices, const f32* vertices, size_t vertex_count, u32 vertex_stride,
+    const std::vector<u32>& hard_clusters, f32 threshold, u32 cache_size)
+{
+    PROFILE_FUNCTION();
+
+    const u32 face_count = (u32) (indices.size() / 3);
+    if (face_count == 0)
+        return 0;
+
+    auto position = [&](u32 v) {
+        const f32* p = vertices + (size_t) v * vertex_stride;
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    // Cut each hard cluster wherever the running ACMR has come down to the
+    // hard cluster's own ACMR (times the threshold).
+    std::vector<u32> clusters;
+    {
+        FifoCache cache(vertex_count, cache_size);
+
+        std::vector<u32> hard = hard_clusters.empty() ? std::vector<u32>{ 0 } : hard_clusters;
+        hard.push_back(face_count);
+
+        for (size_t c = 0; c + 1 < hard.size(); ++c) {
+            const u32 start = hard[c], end = hard[c + 1];
+            if (start >= end) continue;
+
+            const f32 target = analyze_vertex_cache(indices.subspan(start * 3, (end - start) * 3), vertex_count, cache_size).acmr * threshold;
+
+            cache.flush();
+            clusters.push_back(start);
+
+            u32 misses = 0, triangles = 0;
+            for (u32 t = start; t < end; ++t) {
+                for (u32 j = 0; j < 3; ++j)
+                    misses += cache.access(indices[3 * t + j]) ? 1 : 0;
+                ++triangles;
+
+                if (t + 1 < end && (f32) misses <= target * (f32) triangles) {
+                    clusters.push_back(t + 1);
+                    cache.flush();
+                    misses = triangles = 0;
+                }
+            }
+        }
+    }
+
+    const u32 cluster_count = (u32) clusters.size();
+    clusters.push_back(face_count);
+
+    // Area-weighted centroid and normal for every cluster and the whole mesh.
+    std::vector<glm::vec3> centroids(cluster_count), normals(cluster_count);
+    glm::vec3 mesh_centroid(0.0f);
+    f32 mesh_area = 0.0f;
+
+    for (u32 c = 0; c < cluster_count; ++c) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        f32 area = 0.0f;
+
+        for (u32 t = clusters[c]; t < clusters[c + 1]; ++t) {
+            glm::vec3 a = position(indices[3 * t]), b = position(indices[3 * t + 1]), p = position(indices[3 * t + 2]);
+            glm::vec3 n = glm::cross(b - a, p - a);
+            f32 tri_area = glm::length(n);
+
+            centroid += (a + b + p) * (tri_area / 3.0f);
+            normal += n;
+            area += tri_area;
+        }
+
+        mesh_centroid += centroid;
+        mesh_area += area;
+
+        centroids[c] = area > 0.0f ? centroid / area : centroid;
+        f32 len = glm::length(normal);
+        normals[c] = len > 0.0f ? normal / len : glm::vec3(0.0f);
+    }
+    if (mesh_area > 0.0f)
+        mesh_centroid /= mesh_area;
+
+    std::vector<f32> keys(cluster_count);
+    for (u32 c = 0; c < cluster_count; ++c)
+        keys[c] = glm::dot(centroids[c] - mesh_centroid, normals[c]);
+
+    std::vector<u32> order(cluster_count);
+    for (u32 c = 0; c < cluster_count; ++c)
+        order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) { return keys[a] > keys[b]; });
+
+    std::vector<u32> sorted;
+    sorted.reserve(indices.size());
+    for (u32 c : order)
+        sorted.insert(sorted.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+
+    std::copy(sorted.begin(), sorted.end(), indices.begin());
+    return cluster_count;
+}
+
+// -----------------------------------------------------------------------------
+// Vertex fetch
+// -----------------------------------------------------------------------------
+
+u32 optimize_vertex_fetch(MeshData& mesh) {
+    PROFILE_FUNCTION();
+
+    const u32 vertex_count = mesh.get_vertex_count();
+    const u32 stride = mesh.vertex_stride;
+    constexpr u32 UNUSED = ~0u;
+
+    std::vector<u32> remap(vertex_count, UNUSED);
+    u32 next = 0;
+    for (u32& index : mesh.indices) {
+        if (remap[index] == UNUSED)
+            remap[index] = next++;
+        index = remap[index];
+    }
+
+    std::vector<f32> vertices((size_t) next * stride);
+    for (u32 v = 0; v < vertex_count; ++v) {
+        if (remap[v] != UNUSED)
+            std::memcpy(&vertices[(size_t) remap[v] * stride], &mesh.vertices[(size_t) v * stride], stride * sizeof(f32));
+    }
+
+    mesh.vertices = std::move(vertices);
+    return next;
+}
+
+// -----------------------------------------------------------------------------
+
+OptimizeReport optimize(MeshData& mesh, u32 cache_size) {
+    PROFILE_FUNCTION();
+
+    OptimizeReport report;
+
+    const u32 vertex_count = mesh.get_vertex_count();
+    report.before = analyze_vertex_cache(mesh.indices, vertex_count, cache_size);
+    report.after = report.before;
+
+    const bool valid = mesh.indices.size() % 3 == 0
+        && std::all_of(mesh.indices.begin(), mesh.indices.end(), [vertex_count](u32 i) { return i < vertex_count; });
+
+    if (!valid || mesh.indices.empty()) {
+        TR_CORE_WARN("mesh_optimizer: skipping mesh with invalid or empty index data");
+        return report;
+    }
+
+    std::vector<u32> reordered(mesh.indices.size());
+    std::vector<u32> hard_clusters;
+    optimize_vertex_cache(reordered, mesh.indices, vertex_count, cache_size, &hard_clusters);
+
+    report.cluster_count = optimize_overdraw(reordered, mesh.vertices.data(), vertex_count, mesh.vertex_stride, hard_clusters, 1.05f, cache_size);
+    mesh.indices = std::move(reordered);
+
+    report.removed_vertices = vertex_count - optimize_vertex_fetch(mesh);
+    report.after = analyze_vertex_cache(mesh.indices, mesh.get_vertex_count(), cache_size);
+    return report;
+}
+
+} // namespace terra::mesh_optimizer
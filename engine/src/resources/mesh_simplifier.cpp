@@ -0,0 +1,438 @@
+#include "terra/resources/mesh_simplifier.h"
+#include "terra/resources/mesh_optimizer.h"
+#include "terra/helpers/hash.h"
+#include "terra/debug/profiler.h"
+
+#include <glm/glm.hpp>
+
+#include <cfloat>
+#include <unordered_set>
+
+namespace terra::mesh_simplifier {
+
+namespace {
+
+// Sum of squared distances to a set of planes, stored as the symmetric
+// 4x4 matrix it expands to. Planes are area weighted; evaluate() divides by
+// the total weight so the error reads as a mean squared distance.
+struct Quadric {
+    f32 a00 = 0.0f, a11 = 0.0f, a22 = 0.0f;
+    f32 a10 = 0.0f, a20 = 0.0f, a21 = 0.0f;
+    f32 b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+    f32 c = 0.0f;
+    f32 weight = 0.0f;
+
+    void add_plane(const glm::vec3& n, f32 d, f32 w) {
+        a00 += w * n.x * n.x;
+        a11 += w * n.y * n.y;
+        a22 += w * n.z * n.z;
+        a10 += w * n.y * n.x;
+        a20 += w * n.z * n.x;
+        a21 += w * n.z * n.y;
+        b0 += w * n.x * d;
+        b1 += w * n.y * d;
+        b2 += w * n.z * d;
+        c += w * d * d;
+        weight += w;
+    }
+
+    void add(const Quadric& q) {
+        a00 += q.a00; a11 += q.a11; a22 += q.a22;
+        a10 += q.a10; a20 += q.a20; a21 += q.a21;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+        weight += q.weight;
+    }
+
+    f32 evaluate(const glm::vec3& p) const {
+        const f32 rx = a00 * p.x + a10 * p.y + a20 * p.z;
+        const f32 ry = a10 * p.x + a11 * p.y + a21 * p.z;
+        const f32 rz = a20 * p.x + a21 * p.y + a22 * p.z;
+        const f32 e = rx * p.x + ry * p.y + rz * p.z + 2.0f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+        return weight > 0.0f ? std::abs(e) / weight : 0.0f;
+    }
+};
+
+// Combined error of collapsing `a` onto `b`, without building the sum.
+f32 collapse_error(const Quadric& a, const Quadric& b, const glm::vec3& p) {
+    Quadric q = a;
+    q.add(b);
+    return q.evaluate(p);
+}
+
+enum class VertexKind : u8 {
+    Manifold, // interior vertex, free to move
+    Border,   // on an open edge, may only slide along it
+    Locked,   // attribute seam or non-manifold, never moves
+};
+
+// Weighted so that open borders resist eroding inwards.
+constexpr f32 BORDER_WEIGHT = 10.0f;
+
+inline u64 edge_key(u32 a, u32 b) { return ((u64) a << 32) | b; }
+
+// Maps every vertex to the first one whose leading `compare` floats are
+// bitwise identical (open addressing, linear probing).
+std::vector<u32> build_remap(const f32* vertices, size_t vertex_count, u32 stride, u32 compare) {
+    constexpr u32 EMPTY = ~0u;
+    const size_t bytes = compare * sizeof(f32);
+
+    size_t capacity = 16;
+    while (capacity < vertex_count * 2)
+        capacity <<= 1;
+
+    std::vector<u32> table(capacity, EMPTY);
+    std::vector<u32> remap(vertex_count);
+
+    for (u32 v = 0; v < vertex_count; ++v) {
+        const f32* key = vertices + (size_t) v * stride;
+        size_t slot = hash_bytes(key, bytes) & (capacity - 1);
+
+        while (table[slot] != EMPTY && std::memcmp(vertices + (size_t) table[slot] * stride, key, bytes) != 0)
+            slot = (slot + 1) & (capacity - 1);
+
+        if (table[slot] == EMPTY)
+            table[slot] = v;
+        remap[v] = table[slot];
+    }
+
+    return remap;
+}
+
+} // namespace
+
+size_t simplify(std::span<u32> dst, std::span<const u32> indices, const f32* vertices, size_t vertex_count,
+    u32 vertex_stride, size_t target_index_count, f32 target_error, f32* result_error)
+{
+    PROFILE_FUNCTION();
+
+    TR_CORE_ASSERT(dst.size() == indices.size(), "simplify: size mismatch");
+    TR_CORE_ASSERT(indices.size() % 3 == 0, "simplify: index count must be a multiple of 3");
+
+    if (result_error)
+        *result_error = 0.0f;
+
+    // Identical vertices (as OBJ import produces per face corner) become one.
+    const std::vector<u32> wedge = build_remap(vertices, vertex_count, vertex_stride, vertex_stride);
+    const std::vector<u32> position = build_remap(vertices, vertex_count, vertex_stride, 3);
+
+    std::vector<u32> result(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+        result[i] = wedge[indices[i]];
+
+    size_t index_count = result.size();
+    if (index_count <= target_index_count) {
+        std::copy(result.begin(), result.end(), dst.begin());
+        return index_count;
+    }
+
+    // Positions rescaled into the unit cube so errors are relative to the extent.
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (u32 v : result) {
+        glm::vec3 p(vertices[(size_t) v * vertex_stride], vertices[(size_t) v * vertex_stride + 1], vertices[(size_t) v * vertex_stride + 2]);
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    const f32 extent = std::max({ hi.x - lo.x, hi.y - lo.y, hi.z - lo.z });
+    const f32 inv_extent = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+    std::vector<glm::vec3> positions(vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        const f32* src = vertices + v * vertex_stride;
+        positions[v] = (glm::vec3(src[0], src[1], src[2]) - lo) * inv_extent;
+    }
+
+    // Topology is classified once, on positions rather than vertices, so a
+    // colour seam does not look like a hole.
+    std::unordered_map<u64, u32> directed_edges;
+    directed_edges.reserve(index_count);
+    for (size_t i = 0; i < index_count; i += 3) {
+        for (u32 e = 0; e < 3; ++e) {
+            u32 a = position[result[i + e]], b = position[result[i + (e + 1) % 3]];
+            if (a != b)
+                ++directed_edges[edge_key(a, b)];
+        }
+    }
+
+    std::vector<u8> border_edges(vertex_count, 0);
+    std::vector<u8> non_manifold(vertex_count, 0);
+    for (const auto& [key, count] : directed_edges) {
+        u32 a = (u32) (key >> 32), b = (u32) key;
+        if (count > 1)
+            non_manifold[a] = non_manifold[b] = 1;
+        if (!directed_edges.contains(edge_key(b, a))) {
+            border_edges[a] = (u8) std::min(border_edges[a] + 1, 255);
+            border_edges[b] = (u8) std::min(border_edges[b] + 1, 255);
+        }
+    }
+
+    std::vector<u32> wedges_per_position(vertex_count, 0);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        if (wedge[v] == v)
+            ++wedges_per_position[position[v]];
+    }
+
+    std::vector<VertexKind> kind(vertex_count, VertexKind::Locked);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        const u32 p = position[v];
+        if (wedge[v] != v || wedges_per_position[p] > 1 || non_manifold[p])
+            continue;
+        if (border_edges[p] == 0)
+            kind[v] = VertexKind::Manifold;
+        else if (border_edges[p] == 2)
+            kind[v] = VertexKind::Border;
+    }
+
+    // Face planes for every corner, plus planes standing on open edges.
+    std::vector<Quadric> quadrics(vertex_count);
+    for (size_t i = 0; i < index_count; i += 3) {
+        const u32 v[3] = { result[i], result[i + 1], result[i + 2] };
+        const glm::vec3 normal = glm::cross(positions[v[1]] - positions[v[0]], positions[v[2]] - positions[v[0]]);
+        const f32 area = glm::length(normal);
+        if (area <= 0.0f)
+            continue;
+
+        const glm::vec3 n = normal / area;
+        for (u32 k = 0; k < 3; ++k)
+            quadrics[v[k]].add_plane(n, -glm::dot(n, positions[v[k]]), area);
+
+        for (u32 e = 0; e < 3; ++e) {
+            const u32 a = v[e], b = v[(e + 1) % 3];
+            if (directed_edges.contains(edge_key(position[b], position[a])))
+                continue;
+
+            const glm::vec3 edge = positions[b] - positions[a];
+            const glm::vec3 side = glm::cross(edge, n);
+            const f32 length = glm::length(side);
+            if (length <= 0.0f)
+                continue;
+
+            const glm::vec3 sn = side / length;
+            const f32 w = glm::dot(edge, edge) * BORDER_WEIGHT;
+            quadrics[a].add_plane(sn, -glm::dot(sn, positions[a]), w);
+            quadrics[b].add_plane(sn, -glm::dot(sn, positions[b]), w);
+        }
+    }
+
+    struct Collapse {
+        u32 from;
+        u32 to;
+        f32 error;
+    };
+
+    std::vector<Collapse> candidates;
+    std::vector<u32> collapse_to(vertex_count);
+    std::vector<u8> touched(vertex_count);
+    std::vector<u32> offsets(vertex_count + 1);
+    std::vector<u32> adjacency;
+    std::unordered_set<u64> edges;
+
+    const f32 error_limit = target_error * target_error;
+    f32 error_reached = 0.0f;
+
+    // Each pass collapses the cheapest independent edges, then compacts.
+    while (index_count > target_index_count) {
+        edges.clear();
+        for (size_t i = 0; i < index_count; i += 3) {
+            for (u32 e = 0; e < 3; ++e)
+                edges.insert(edge_key(position[result[i + e]], position[result[i + (e + 1) % 3]]));
+        }
+
+        auto can_collapse = [&](u32 from, u32 to) {
+            switch (kind[from]) {
+            case VertexKind::Manifold: return true;
+            case VertexKind::Border: {
+                // Only along an edge that is still open, so the outline is kept.
+                const u32 a = position[from], b = position[to];
+                return edges.contains(edge_key(a, b)) != edges.contains(edge_key(b, a));
+            }
+            default: return false;
+            }
+        };
+
+        candidates.clear();
+        for (size_t i = 0; i < index_count; i += 3) {
+            for (u32 e = 0; e < 3; ++e) {
+                const u32 a = result[i + e], b = result[i + (e + 1) % 3];
+                if (a == b)
+                    continue;
+
+                const bool ab = can_collapse(a, b), ba = can_collapse(b, a);
+                if (!ab && !ba)
+                    continue;
+
+                const f32 error_ab = ab ? collapse_error(quadrics[a], quadrics[b], positions[b]) : FLT_MAX;
+                const f32 error_ba = ba ? collapse_error(quadrics[b], quadrics[a], positions[a]) : FLT_MAX;
+                if (error_ab <= error_ba)
+                    candidates.push_back({ a, b, error_ab });
+                else
+                    candidates.push_back({ b, a, error_ba });
+            }
+        }
+
+        if (candidates.empty())
+            break;
+
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        // Vertex -> triangle adjacency in CSR form.
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (size_t i = 0; i < index_count; ++i)
+            ++offsets[result[i] + 1];
+        for (size_t v = 0; v < vertex_count; ++v)
+            offsets[v + 1] += offsets[v];
+        adjacency.resize(index_count);
+        {
+            std::vector<u32> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < index_count; ++i)
+                adjacency[cursor[result[i]]++] = (u32) (i / 3);
+        }
+
+        // Rejects collapses that would turn a remaining triangle over.
+        auto flips = [&](u32 from, u32 to) {
+            for (u32 k = offsets[from]; k < offsets[from + 1]; ++k) {
+                const u32* t = &result[(size_t) adjacency[k] * 3];
+                if (t[0] == to || t[1] == to || t[2] == to)
+                    continue; // becomes degenerate and is dropped
+
+                const glm::vec3 p0 = positions[t[0]], p1 = positions[t[1]], p2 = positions[t[2]];
+                const glm::vec3 before = glm::cross(p1 - p0, p2 - p0);
+
+                const glm::vec3 q0 = t[0] == from ? positions[to] : p0;
+                const glm::vec3 q1 = t[1] == from ? positions[to] : p1;
+                const glm::vec3 q2 = t[2] == from ? positions[to] : p2;
+                const glm::vec3 after = glm::cross(q1 - q0, q2 - q0);
+
+                if (glm::dot(before, after) <= 1e-2f * glm::length(before) * glm::length(after))
+                    return true;
+            }
+            return false;
+        };
+
+        for (size_t v = 0; v < vertex_count; ++v)
+            collapse_to[v] = (u32) v;
+        std::fill(touched.begin(), touched.end(), 0);
+
+        const size_t triangles_needed = (index_count - target_index_count + 2) / 3;
+        size_t triangles_removed = 0;
+        u32 applied = 0;
+
+        for (const Collapse& c : candidates) {
+            if (c.error > error_limit || triangles_removed >= triangles_needed)
+                break;
+            if (touched[c.from] || touched[c.to] || flips(c.from, c.to))
+                continue;
+
+            quadrics[c.to].add(quadrics[c.from]);
+            collapse_to[c.from] = c.to;
+
+            // The whole one-ring is frozen so later checks in this pass see final positions.
+            for (u32 k = offsets[c.from]; k < offsets[c.from + 1]; ++k) {
+                const u32* t = &result[(size_t) adjacency[k] * 3];
+                touched[t[0]] = touched[t[1]] = touched[t[2]] = 1;
+            }
+            touched[c.to] = 1;
+
+            triangles_removed += kind[c.from] == VertexKind::Border ? 1 : 2;
+            error_reached = std::max(error_reached, c.error);
+            ++applied;
+        }
+
+        if (applied == 0)
+            break;
+
+        size_t write = 0;
+        for (size_t i = 0; i < index_count; i += 3) {
+            const u32 a = collapse_to[result[i]], b = collapse_to[result[i + 1]], c = collapse_to[result[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        index_count = write;
+    }
+
+    std::copy(result.begin(), result.begin() + index_count, dst.begin());
+
+    if (result_error)
+        *result_error = std::sqrt(error_reached);
+
+    return index_count;
+}
+
+u32 generate_lods(MeshData& mesh, const LodSettings& settings) {
+    PROFILE_FUNCTION();
+
+    mesh.lods.clear();
+
+    const u32 vertex_count = mesh.get_vertex_count();
+    const u32 base_count = mesh.get_index_count();
+    if (base_count == 0 || base_count % 3 != 0 || settings.max_lods < 2)
+        return 1;
+    if (!std::all_of(mesh.indices.begin(), mesh.indices.end(), [vertex_count](u32 i) { return i < vertex_count; }))
+        return 1;
+
+    auto count_unique = [vertex_count](std::span<const u32> range) {
+        std::vector<u8> seen(vertex_count, 0);
+        u32 unique = 0;
+        for (u32 v : range) {
+            unique += seen[v] ? 0 : 1;
+            seen[v] = 1;
+        }
+        return unique;
+    };
+
+    // Object-space size, to turn the simplifier's relative error into units.
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (u32 v = 0; v < vertex_count; ++v) {
+        const f32* p = &mesh.vertices[(size_t) v * mesh.vertex_stride];
+        lo = glm::min(lo, glm::vec3(p[0], p[1], p[2]));
+        hi = glm::max(hi, glm::vec3(p[0], p[1], p[2]));
+    }
+    const f32 extent = std::max({ hi.x - lo.x, hi.y - lo.y, hi.z - lo.z, 0.0f });
+
+    mesh.lods.push_back({ 0, base_count, count_unique({ mesh.indices.data(), base_count }), 0.0f });
+
+    std::vector<u32> source(mesh.indices.begin(), mesh.indices.end());
+    const u32 max_lods = std::min(settings.max_lods, MAX_MESH_LODS);
+
+    while (mesh.lods.size() < max_lods) {
+        const size_t target = (size_t) ((f32) (source.size() / 3) * settings.reduction) * 3;
+        if (target < 3)
+            break;
+
+        std::vector<u32> simplified(source.size());
+        f32 error = 0.0f;
+        const size_t count = simplify(simplified, source, mesh.vertices.data(), vertex_count, mesh.vertex_stride,
+            target, settings.max_error, &error);
+
+        if (count == 0 || (f32) count > (f32) source.size() * settings.min_reduction)
+            break;
+
+        simplified.resize(count);
+
+        std::vector<u32> ordered(count);
+        mesh_optimizer::optimize_vertex_cache(ordered, simplified, vertex_count);
+
+        MeshLod lod;
+        lod.index_offset = (u32) mesh.indices.size();
+        lod.index_count = (u32) count;
+        lod.vertex_count = count_unique(ordered);
+        // Each level is simplified from the last, so the errors add up.
+        lod.error = mesh.lods.back().error + error * extent;
+
+        mesh.indices.insert(mesh.indices.end(), ordered.begin(), ordered.end());
+        mesh.lods.push_back(lod);
+
+        source = std::move(simplified);
+    }
+
+    const u32 level_count = (u32) mesh.lods.size();
+    if (level_count == 1)
+        mesh.lods.clear();
+
+    return level_count;
+}
+
+} // namespace terra::mesh_simplifier
@@ -0,0 +1,219 @@
+#include "terra/resources/meshlet_builder.h"
+#include "terra/debug/profiler.h"
+
+#include <glm/glm.hpp>
+
+#include <cfloat>
+
+namespace terra::meshlet_builder {
+
+namespace {
+
+glm::vec3 load_position(const f32* vertices, u32 stride, u32 v) {
+    const f32* p = &vertices[(size_t) v * stride];
+    return { p[0], p[1], p[2] };
+}
+
+// Unit normal of a counter-clockwise triangle; zero when degenerate.
+glm::vec3 triangle_normal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    const glm::vec3 n = glm::cross(b - a, c - a);
+    const f32 length = glm::length(n);
+    return length > 0.0f ? n / length : glm::vec3(0.0f);
+}
+
+} // namespace
+
+Meshlet compute_meshlet_bounds(std::span<const u32> indices, const f32* vertices, u32 vertex_stride) {
+    Meshlet meshlet;
+    meshlet.triangle_count = (u32) (indices.size() / 3);
+    if (indices.empty())
+        return meshlet;
+
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (u32 v : indices) {
+        const glm::vec3 p = load_position(vertices, vertex_stride, v);
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+
+    const glm::vec3 center = (lo + hi) * 0.5f;
+    f32 radius = 0.0f;
+    for (u32 v : indices)
+        radius = std::max(radius, glm::distance(center, load_position(vertices, vertex_stride, v)));
+
+    // Cone around the average normal that contains every triangle normal.
+    glm::vec3 axis(0.0f);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        axis += triangle_normal(
+            load_position(vertices, vertex_stride, indices[i]),
+            load_position(vertices, vertex_stride, indices[i + 1]),
+            load_position(vertices, vertex_stride, indices[i + 2]));
+    }
+
+    f32 min_dot = -1.0f;
+    if (glm::length(axis) > 0.0f) {
+        axis = glm::normalize(axis);
+        min_dot = 1.0f;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const glm::vec3 n = triangle_normal(
+                load_position(vertices, vertex_stride, indices[i]),
+                load_position(vertices, vertex_stride, indices[i + 1]),
+                load_position(vertices, vertex_stride, indices[i + 2]));
+            if (n != glm::vec3(0.0f))
+                min_dot = std::min(min_dot, glm::dot(n, axis));
+        }
+    }
+
+    meshlet.center[0] = center.x;
+    meshlet.center[1] = center.y;
+    meshlet.center[2] = center.z;
+    meshlet.radius = radius;
+    meshlet.cone_axis[0] = axis.x;
+    meshlet.cone_axis[1] = axis.y;
+    meshlet.cone_axis[2] = axis.z;
+
+    // A cone wider than ~84 degrees either side culls almost nothing; keep
+    // the cutoff at 1 so the test never passes. Otherwise the back-facing
+    // region is the normal cone widened by 90 degrees and flipped, whose
+    // cosine is sin(acos(min_dot)).
+    meshlet.cone_cutoff = min_dot <= 0.1f ? 1.0f : std::sqrt(1.0f - min_dot * min_dot);
+    return meshlet;
+}
+
+u32 build_meshlets(MeshData& mesh, const MeshletSettings& settings) {
+    PROFILE_FUNCTION();
+
+    mesh.meshlets.clear();
+
+    const u32 vertex_count = mesh.get_vertex_count();
+    const u32 base_offset = mesh.lods.empty() ? 0 : mesh.lods[0].index_offset;
+    const u32 base_count = mesh.lods.empty() ? mesh.get_index_count() : mesh.lods[0].index_count;
+    const u32 triangle_count = base_count / 3;
+
+    if (base_count % 3 != 0 || triangle_count < std::max(settings.min_triangles, 1u))
+        return 0;
+
+    u32* indices = mesh.indices.data() + base_offset;
+    if (!std::all_of(indices, indices + base_count, [vertex_count](u32 i) { return i < vertex_count; }))
+        return 0;
+
+    const u32 max_vertices = std::clamp(settings.max_vertices, 3u, MESHLET_MAX_VERTICES);
+    const u32 max_triangles = std::clamp(settings.max_triangles, 1u, MESHLET_MAX_TRIANGLES);
+    const f32* vertices = mesh.vertices.data();
+    const u32 stride = mesh.vertex_stride;
+
+    std::vector<glm::vec3> centroids(triangle_count);
+    std::vector<glm::vec3> normals(triangle_count);
+    for (u32 t = 0; t < triangle_count; ++t) {
+        const glm::vec3 a = load_position(vertices, stride, indices[t * 3 + 0]);
+        const glm::vec3 b = load_position(vertices, stride, indices[t * 3 + 1]);
+        const glm::vec3 c = load_position(vertices, stride, indices[t * 3 + 2]);
+        centroids[t] = (a + b + c) / 3.0f;
+        normals[t] = triangle_normal(a, b, c);
+    }
+
+    // Vertex -> triangle adjacency, compressed rows.
+    std::vector<u32> first_adjacent(vertex_count + 1, 0);
+    for (u32 i = 0; i < base_count; ++i)
+        first_adjacent[indices[i] + 1]++;
+    for (u32 v = 0; v < vertex_count; ++v)
+        first_adjacent[v + 1] += first_adjacent[v];
+
+    std::vector<u32> adjacency(base_count);
+    {
+        std::vector<u32> cursor(first_adjacent.begin(), first_adjacent.end() - 1);
+        for (u32 i = 0; i < base_count; ++i)
+            adjacency[cursor[indices[i]]++] = i / 3;
+    }
+
+    constexpr u32 NONE = ~0u;
+
+    std::vector<u8> emitted(triangle_count, 0);
+    std::vector<u32> vertex_owner(vertex_count, NONE);      // meshlet that already holds the vertex
+    std::vector<u32> candidate_owner(triangle_count, NONE); // meshlet whose candidate list holds the triangle
+    std::vector<u32> candidates;
+    std::vector<u32> ordered;
+    ordered.reserve(base_count);
+
+    u32 seed = 0;
+    for (u32 meshlet_index = 0;; ++meshlet_index) {
+        // The next unused triangle in cache order starts a new cluster.
+        while (seed < triangle_count && emitted[seed])
+            ++seed;
+        if (seed == triangle_count)
+            break;
+
+        const u32 start = (u32) ordered.size();
+        u32 cluster_vertices = 0;
+        u32 cluster_triangles = 0;
+        glm::vec3 centroid_sum(0.0f);
+        glm::vec3 normal_sum(0.0f);
+        candidates.clear();
+
+        for (u32 next = seed; next != NONE;) {
+            emitted[next] = 1;
+            for (u32 k = 0; k < 3; ++k) {
+                const u32 v = indices[next * 3 + k];
+                ordered.push_back(v);
+
+                if (vertex_owner[v] == meshlet_index)
+                    continue;
+                vertex_owner[v] = meshlet_index;
+                cluster_vertices++;
+
+                for (u32 a = first_adjacent[v]; a < first_adjacent[v + 1]; ++a) {
+                    const u32 t = adjacency[a];
+                    if (!emitted[t] && candidate_owner[t] != meshlet_index) {
+                        candidate_owner[t] = meshlet_index;
+                        candidates.push_back(t);
+                    }
+                }
+            }
+
+            cluster_triangles++;
+            centroid_sum += centroids[next];
+            normal_sum += normals[next];
+            if (cluster_triangles == max_triangles)
+                break;
+
+            const glm::vec3 center = centroid_sum / (f32) cluster_triangles;
+            const f32 normal_length = glm::length(normal_sum);
+            const glm::vec3 axis = normal_length > 0.0f ? normal_sum / normal_length : glm::vec3(0.0f);
+
+            next = NONE;
+            u32 best_new = 4;
+            f32 best_score = FLT_MAX;
+            size_t write = 0;
+
+            for (u32 t : candidates) {
+                if (emitted[t])
+                    continue;
+                candidates[write++] = t;
+
+                u32 new_vertices = 0;
+                for (u32 k = 0; k < 3; ++k)
+                    new_vertices += vertex_owner[indices[t * 3 + k]] != meshlet_index ? 1 : 0;
+                if (cluster_vertices + new_vertices > max_vertices)
+                    continue;
+
+                const glm::vec3 d = centroids[t] - center;
+                const f32 score = glm::dot(d, d) * (1.0f + settings.cone_weight * (1.0f - glm::dot(normals[t], axis)));
+                if (new_vertices < best_new || (new_vertices == best_new && score < best_score)) {
+                    best_new = new_vertices;
+                    best_score = score;
+                    next = t;
+                }
+            }
+            candidates.resize(write);
+        }
+
+        Meshlet meshlet = compute_meshlet_bounds({ ordered.data() + start, ordered.size() - start }, vertices, stride);
+        meshlet.index_offset = base_offset + start;
+        mesh.meshlets.push_back(meshlet);
+    }
+
+    std::copy(ordered.begin(), ordered.end(), indices);
+    return (u32) mesh.meshlets.size();
+}
+
+} // namespace terra::meshlet_builder
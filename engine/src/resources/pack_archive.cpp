@@ -0,0 +1,274 @@
+#include "terra/resources/pack_archive.h"
+#include "terra/resources/lz4.h"
+#include "terra/helpers/hash.h"
+#include "terra/debug/profiler.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace terra {
+
+// -----------------------------------------------------------------------------
+// MappedFile
+// -----------------------------------------------------------------------------
+
+MappedFile::~MappedFile() {
+    if (m_data && m_size > 0)
+        munmap(const_cast<u8*>(m_data), m_size);
+}
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* ptr = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+
+    if (ptr == MAP_FAILED)
+        return nullptr;
+
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    file->m_data = static_cast<const u8*>(ptr);
+    file->m_size = (size_t) st.st_size;
+    return file;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+    if (offset >= m_size)
+        return;
+
+    size = std::min(size, m_size - offset);
+
+    // madvise wants a page-aligned start.
+    const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t aligned = offset & ~(page - 1);
+    madvise(const_cast<u8*>(m_data) + aligned, size + (offset - aligned), MADV_WILLNEED);
+}
+
+// -----------------------------------------------------------------------------
+// PackArchive
+// -----------------------------------------------------------------------------
+
+// Whether [offset, offset + size) lies inside a file of file_size bytes,
+// without the sum wrapping on hostile offsets.
+static bool range_fits(u64 offset, u64 size, u64 file_size) {
+    return offset <= file_size && size <= file_size - offset;
+}
+
+ref<PackArchive> PackArchive::open(const std::filesystem::path& path) {
+    PROFILE_FUNCTION();
+
+    auto file = MappedFile::open(path);
+    if (!file) {
+        TR_CORE_ERROR("PackArchive: could not map '{}'", path.string());
+        return nullptr;
+    }
+
+    if (file->size() < sizeof(PackHeader)) {
+        TR_CORE_ERROR("PackArchive: '{}' is too small to be an archive", path.string());
+        return nullptr;
+    }
+
+    PackHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (header.magic != PACK_MAGIC || header.version != PACK_VERSION) {
+        TR_CORE_ERROR("PackArchive: '{}' has a bad header (magic {:#x}, version {})",
+            path.string(), header.magic, header.version);
+        return nullptr;
+    }
+
+    const u64 toc_size = (u64) header.entry_count * sizeof(PackEntry);
+    if (!range_fits(header.toc_offset, toc_size, file->size()) ||
+        !range_fits(header.names_offset, header.names_size, file->size())) {
+        TR_CORE_ERROR("PackArchive: '{}' is truncated", path.string());
+        return nullptr;
+    }
+
+    ref<PackArchive> archive(new PackArchive());
+    archive->m_name = path.filename().string();
+    archive->m_entries.resize(header.entry_count);
+    std::memcpy(archive->m_entries.data(), file->data() + header.toc_offset, toc_size);
+    archive->m_names = std::string_view(reinterpret_cast<const char*>(file->data() + header.names_offset), header.names_size);
+
+    for (const PackEntry& entry : archive->m_entries) {
+        if (!range_fits(entry.offset, entry.stored_size, file->size()) ||
+            (u64) entry.name_offset + entry.name_length > header.names_size) {
+            TR_CORE_ERROR("PackArchive: '{}' has an entry outside the file", path.string());
+            return nullptr;
+        }
+        // Uncompressed entries are served straight from the mapping.
+        if (!(entry.flags & PackEntryFlags_LZ4) && entry.size != entry.stored_size) {
+            TR_CORE_ERROR("PackArchive: '{}' has an uncompressed entry with mismatched sizes", path.string());
+            return nullptr;
+        }
+    }
+
+    archive->m_file = std::move(file);
+
+    TR_CORE_INFO("Mounted pack '{}' ({} entries)", archive->m_name, archive->m_entries.size());
+    return archive;
+}
+
+const PackEntry* PackArchive::find(std::string_view path) const {
+    const u64 hash = hash_string(path);
+
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), hash,
+        [](const PackEntry& e, u64 h) { return e.path_hash < h; });
+
+    // Walk the (rare) run of equal hashes and confirm by name.
+    for (; it != m_entries.end() && it->path_hash == hash; ++it) {
+        if (get_entry_name(*it) == path)
+            return &*it;
+    }
+    return nullptr;
+}
+
+std::string_view PackArchive::get_entry_name(const PackEntry& entry) const {
+    return m_names.substr(entry.name_offset, entry.name_length);
+}
+
+bool PackArchive::exists(std::string_view path) const {
+    return find(path) != nullptr;
+}
+
+FileData PackArchive::read(std::string_view path) const {
+    const PackEntry* entry = find(path);
+    if (!entry)
+        return {};
+
+    const u8* stored = m_file->data() + entry->offset;
+
+    if (!(entry->flags & PackEntryFlags_LZ4))
+        return FileData::from_view(stored, (size_t) entry->size, m_file);
+
+    PROFILE_SCOPE("PackArchive::decompress");
+
+    std::vector<u8> buffer((size_t) entry->size);
+    if (!lz4::decompress(stored, (size_t) entry->stored_size, buffer.data(), buffer.size())) {
+        TR_CORE_ERROR("PackArchive: corrupt LZ4 block for '{}' in '{}'", path, m_name);
+        return {};
+    }
+    return FileData::from_buffer(std::move(buffer));
+}
+
+void PackArchive::prefetch() const {
+    m_file->prefetch(0, m_file->size());
+}
+
+// -----------------------------------------------------------------------------
+// PackWriter
+// -----------------------------------------------------------------------------
+
+void PackWriter::add_file(std::string_view virtual_path, std::span<const u8> data, bool compress, f32 min_savings) {
+    PendingFile file;
+    file.path = std::string(virtual_path);
+    file.size = data.size();
+
+    if (compress && !data.empty()) {
+        std::vector<u8> packed(lz4::compress_bound(data.size()));
+        size_t packed_size = lz4::compress(data.data(), data.size(), packed.data(), packed.size());
+
+        if (packed_size > 0 && (f32) packed_size <= (f32) data.size() * (1.0f - min_savings)) {
+            packed.resize(packed_size);
+            file.stored = std::move(packed);
+            file.flags = PackEntryFlags_LZ4;
+        }
+    }
+
+    if (file.flags == PackEntryFlags_None)
+        file.stored.assign(data.begin(), data.end());
+
+    // Later additions of the same path replace earlier ones.
+    std::erase_if(m_files, [&](const PendingFile& f) { return f.path == file.path; });
+    m_files.push_back(std::move(file));
+}
+
+bool PackWriter::write(const std::filesystem::path& output_path) const {
+    PROFILE_FUNCTION();
+
+    std::vector<const PendingFile*> order;
+    order.reserve(m_files.size());
+    for (const auto& f : m_files)
+        order.push_back(&f);
+
+    std::sort(order.begin(), order.end(), [](const PendingFile* a, const PendingFile* b) {
+        u64 ha = hash_string(a->path), hb = hash_string(b->path);
+        return ha != hb ? ha < hb : a->path < b->path;
+    });
+
+    auto align_up = [this](u64 v) { return (v + m_alignment - 1) / m_alignment * m_alignment; };
+
+    PackHeader header;
+    header.entry_count = (u32) order.size();
+    header.alignment = m_alignment;
+    header.toc_offset = sizeof(PackHeader);
+    header.names_offset = header.toc_offset + order.size() * sizeof(PackEntry);
+
+    std::string names;
+    std::vector<PackEntry> entries(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        entries[i].path_hash = hash_string(order[i]->path);
+        entries[i].name_offset = (u32) names.size();
+        entries[i].name_length = (u32) order[i]->path.size();
+        entries[i].size = order[i]->size;
+        entries[i].stored_size = order[i]->stored.size();
+        entries[i].flags = order[i]->flags;
+        names += order[i]->path;
+        names += '\0';
+    }
+    header.names_size = names.size();
+
+    u64 cursor = align_up(header.names_offset + header.names_size);
+    for (auto& entry : entries) {
+        entry.offset = cursor;
+        cursor = align_up(cursor + entry.stored_size);
+    }
+
+    std::filesystem::create_directories(output_path.parent_path());
+    std::ofstream out(output_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        TR_CORE_ERROR("PackWriter: could not open '{}' for writing", output_path.string());
+        return false;
+    }
+
+    auto pad_to = [&out](u64 offset) {
+        static const char zeros[256] = {};
+        u64 pos = (u64) out.tellp();
+        while (pos < offset) {
+            u64 n = std::min<u64>(offset - pos, sizeof(zeros));
+            out.write(zeros, (std::streamsize) n);
+            pos += n;
+        }
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), (std::streamsize) (entries.size() * sizeof(PackEntry)));
+    out.write(names.data(), (std::streamsize) names.size());
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        pad_to(entries[i].offset);
+        out.write(reinterpret_cast<const char*>(order[i]->stored.data()), (std::streamsize) order[i]->stored.size());
+    }
+
+    out.flush();
+    if (!out.good()) {
+        TR_CORE_ERROR("PackWriter: write to '{}' failed", output_path.string());
+        return false;
+    }
+
+    TR_CORE_INFO("Wrote pack '{}' ({} entries, {} bytes)", output_path.string(), entries.size(), (u64) out.tellp());
+    return true;
+}
+
+} // namespace terra
@@ -1,4 +1,8 @@
 #include "terra/resources/resource_manager.h"
+#include "terra/resources/virtual_file_system.h"
+#include "terra/resources/mesh_optimizer.h"
+#include "terra/resources/mesh_simplifier.h"
+#include "terra/resources/meshlet_builder.h"
 
 namespace terra {
 
@@ -8,12 +12,33 @@ bool ResourceManager::load_geometry(
     std::vector<u32>& index_data,
     bool is_3d
 ) {
-    std::ifstream file(get_asset_path(path));
-    if (!file.is_open()) {
+    FileData file = read_file(path.generic_string());
+    if (!file) {
         TR_CORE_ERROR("Failed to open geometry file: {}", path.string());
         return false;
     }
 
+    return parse_geometry(file.as_string(), path, vertex_data, index_data, is_3d);
+}
+
+bool ResourceManager::parse_geometry(
+    std::string_view source,
+    const std::filesystem::path& path,
+    std::vector<f32>& vertex_data,
+    std::vector<u32>& index_data,
+    bool is_3d
+) {
+    std::istringstream stream{std::string(source)};
+    return parse_geometry(stream, path, vertex_data, index_data, is_3d);
+}
+
+bool ResourceManager::parse_geometry(
+    std::istream& file,
+    const std::filesystem::path& path,
+    std::vector<f32>& vertex_data,
+    std::vector<u32>& index_data,
+    bool is_3d
+) {
     vertex_data.clear();
     index_data.clear();
 
@@ -89,18 +114,34 @@ bool ResourceManager::load_geometry(
 }
 
 
-std::string ResourceManager::read_file_as_string(const std::string& relative_path) {
-    std::filesystem::path full_path = get_asset_path(relative_path);
-    std::ifstream file(full_path);
-    
-    if (!file.is_open()) {
-        TR_CORE_ERROR("Failed to open file: {}", full_path.string());
-        return {};
-    }
+bool ResourceManager::import_geometry(std::string_view source, const std::filesystem::path& path, MeshData& mesh) {
+    mesh.vertex_stride = 6;
+    if (!parse_geometry(source, path, mesh.vertices, mesh.indices, true))
+        return false;
+
+    auto report = mesh_optimizer::optimize(mesh);
+    TR_CORE_TRACE("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f} ({} clusters)",
+        path.string(), report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr, report.cluster_count);
+
+    u32 lod_count = mesh_simplifier::generate_lods(mesh);
+    for (u32 i = 1; i < lod_count; ++i)
+        TR_CORE_TRACE("  LOD {}: {} triangles, error {:.4f}", i, mesh.lods[i].index_count / 3, mesh.lods[i].error);
+
+    if (u32 meshlet_count = meshlet_builder::build_meshlets(mesh))
+        TR_CORE_TRACE("  {} meshlets", meshlet_count);
+    return true;
+}
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+FileData ResourceManager::read_file(std::string_view relative_path) {
+    FileData file = VirtualFileSystem::read(relative_path);
+    if (!file)
+        TR_CORE_ERROR("Failed to open file: {}", relative_path);
+    return file;
+}
+
+std::string ResourceManager::read_file_as_string(const std::string& relative_path) {
+    FileData file = read_file(relative_path);
+    return file ? std::string(file.as_string()) : std::string{};
 }
 
 } // namespace terra
@@ -0,0 +1,111 @@
+#include "terra/resources/static_batch_builder.h"
+#include "terra/debug/profiler.h"
+
+#include <cfloat>
+
+namespace terra {
+
+StaticBatchBuilder::StaticBatchBuilder(const StaticBatchSettings& settings) : m_settings(settings) {}
+
+void StaticBatchBuilder::add(const MeshData& mesh, const glm::mat4& transform, MaterialHandle material, const glm::vec4& color) {
+    if (mesh.get_vertex_count() == 0 || mesh.vertex_stride < 6)
+        return;
+
+    // Bucket by the world-space centre of the object's bounding box.
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (u32 v = 0; v < mesh.get_vertex_count(); ++v) {
+        const f32* p = &mesh.vertices[(size_t) v * mesh.vertex_stride];
+        lo = glm::min(lo, glm::vec3(p[0], p[1], p[2]));
+        hi = glm::max(hi, glm::vec3(p[0], p[1], p[2]));
+    }
+    const glm::vec3 center = glm::vec3(transform * glm::vec4((lo + hi) * 0.5f, 1.0f));
+
+    Object object;
+    object.mesh = &mesh;
+    object.transform = transform;
+    object.color = color;
+    object.material = material;
+    object.cell = glm::ivec3(glm::floor(center / m_settings.chunk_size));
+    m_objects.push_back(object);
+}
+
+std::vector<StaticChunk> StaticBatchBuilder::build() const {
+    PROFILE_FUNCTION();
+
+    // Deterministic chunk order: by material, then cell. Vertex stride is part
+    // of the bucket since a merged mesh has one layout.
+    std::vector<u32> order(m_objects.size());
+    for (u32 i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    auto key = [this](u32 i) {
+        const Object& o = m_objects[i];
+        return std::make_tuple(o.material.value, o.cell.x, o.cell.y, o.cell.z, o.mesh->vertex_stride);
+    };
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) { return key(a) < key(b); });
+
+    std::vector<StaticChunk> chunks;
+    StaticChunk* chunk = nullptr;
+
+    for (size_t k = 0; k < order.size(); ++k) {
+        const Object& object = m_objects[order[k]];
+        const MeshData& source = *object.mesh;
+        const u32 vertex_count = source.get_vertex_count();
+
+        const MeshLod lod0 = source.lods.empty() ? MeshLod{ 0, source.get_index_count(), vertex_count, 0.0f } : source.lods[0];
+
+        const bool same_bucket = chunk && k > 0 && key(order[k - 1]) == key(order[k]);
+        if (!same_bucket || chunk->mesh.get_vertex_count() + vertex_count > m_settings.max_chunk_vertices) {
+            chunk = &chunks.emplace_back();
+            chunk->material = object.material;
+            chunk->mesh.vertex_stride = source.vertex_stride;
+            chunk->bounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+        }
+
+        MeshData& merged = chunk->mesh;
+        const u32 stride = source.vertex_stride;
+        const u32 base = merged.get_vertex_count();
+        const glm::mat3 normal_matrix = glm::transpose(glm::inverse(glm::mat3(object.transform)));
+        const bool has_normals = stride >= 9;
+
+        merged.vertices.resize(merged.vertices.size() + (size_t) vertex_count * stride);
+        for (u32 v = 0; v < vertex_count; ++v) {
+            const f32* src = &source.vertices[(size_t) v * stride];
+            f32* dst = &merged.vertices[(size_t) (base + v) * stride];
+            std::memcpy(dst, src, stride * sizeof(f32));
+
+            const glm::vec3 position = glm::vec3(object.transform * glm::vec4(src[0], src[1], src[2], 1.0f));
+            dst[0] = position.x;
+            dst[1] = position.y;
+            dst[2] = position.z;
+            chunk->bounds.min = glm::min(chunk->bounds.min, position);
+            chunk->bounds.max = glm::max(chunk->bounds.max, position);
+
+            dst[3] *= object.color.r;
+            dst[4] *= object.color.g;
+            dst[5] *= object.color.b;
+
+            if (has_normals) {
+                const glm::vec3 normal = glm::normalize(normal_matrix * glm::vec3(src[6], src[7], src[8]));
+                dst[6] = normal.x;
+                dst[7] = normal.y;
+                dst[8] = normal.z;
+            }
+        }
+
+        // A mirroring transform flips the winding; swap back to keep faces front-facing.
+        const bool mirrored = glm::determinant(glm::mat3(object.transform)) < 0.0f;
+        for (u32 i = 0; i + 2 < lod0.index_count; i += 3) {
+            const u32* t = &source.indices[lod0.index_offset + i];
+            merged.indices.push_back(base + t[0]);
+            merged.indices.push_back(base + (mirrored ? t[2] : t[1]));
+            merged.indices.push_back(base + (mirrored ? t[1] : t[2]));
+        }
+
+        chunk->object_count++;
+    }
+
+    return chunks;
+}
+
+} // namespace terra
@@ -0,0 +1,124 @@
+#include "terra/resources/vertex_quantization.h"
+#include "terra/debug/profiler.h"
+
+#include <glm/gtc/packing.hpp>
+
+namespace terra::vertex_quantization {
+
+namespace {
+
+glm::vec2 sign_not_zero(glm::vec2 v) {
+    return { v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f };
+}
+
+u16 to_snorm16(f32 v) {
+    return (u16) (i16) std::round(glm::clamp(v, -1.0f, 1.0f) * 32767.0f);
+}
+
+f32 from_snorm16(u16 v) {
+    return std::max((f32) (i16) v / 32767.0f, -1.0f);
+}
+
+} // namespace
+
+u32 get_vertex_size(VertexQuantization mode, bool normals) {
+    switch (mode) {
+    case VertexQuantization::None:
+        return (normals ? NORMAL_VERTEX_STRIDE : 6) * sizeof(f32);
+    case VertexQuantization::Unorm16:
+    case VertexQuantization::Float16:
+        return 8 + 4 + (normals ? 4 : 0);
+    }
+    return 0;
+}
+
+u32 encode_octahedral(const glm::vec3& normal) {
+    const f32 l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    glm::vec2 e = l1 > 0.0f ? glm::vec2(normal) / l1 : glm::vec2(0.0f);
+
+    // Fold the lower hemisphere over the diagonals.
+    if (normal.z < 0.0f)
+        e = (1.0f - glm::abs(glm::vec2(e.y, e.x))) * sign_not_zero(e);
+
+    return (u32) to_snorm16(e.x) | ((u32) to_snorm16(e.y) << 16);
+}
+
+glm::vec3 decode_octahedral(u32 packed) {
+    const glm::vec2 e(from_snorm16((u16) packed), from_snorm16((u16) (packed >> 16)));
+
+    glm::vec3 n(e, 1.0f - std::abs(e.x) - std::abs(e.y));
+    const f32 t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+QuantizedVertices quantize(const MeshData& mesh, VertexQuantization mode) {
+    PROFILE_FUNCTION();
+
+    const u32 vertex_count = mesh.get_vertex_count();
+    const bool normals = mesh.vertex_stride >= NORMAL_VERTEX_STRIDE;
+
+    QuantizedVertices out;
+    out.stride = get_vertex_size(mode, normals);
+
+    if (mode == VertexQuantization::None) {
+        // Drop anything past the attributes the layout knows about.
+        const u32 floats = out.stride / sizeof(f32);
+        out.data.resize((size_t) vertex_count * out.stride);
+        for (u32 v = 0; v < vertex_count; ++v)
+            std::memcpy(&out.data[(size_t) v * out.stride], &mesh.vertices[(size_t) v * mesh.vertex_stride], floats * sizeof(f32));
+        return out;
+    }
+
+    auto position = [&](u32 v) {
+        const f32* p = &mesh.vertices[(size_t) v * mesh.vertex_stride];
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    glm::vec3 lo(0.0f), extent(0.0f);
+    if (mode == VertexQuantization::Unorm16 && vertex_count > 0) {
+        glm::vec3 hi = lo = position(0);
+        for (u32 v = 1; v < vertex_count; ++v) {
+            lo = glm::min(lo, position(v));
+            hi = glm::max(hi, position(v));
+        }
+        extent = hi - lo;
+
+        out.decode.position_offset = glm::vec4(lo, 0.0f);
+        out.decode.position_scale = glm::vec4(extent, 1.0f);
+    }
+
+    out.data.resize((size_t) vertex_count * out.stride);
+
+    for (u32 v = 0; v < vertex_count; ++v) {
+        const f32* src = &mesh.vertices[(size_t) v * mesh.vertex_stride];
+        u8* dst = &out.data[(size_t) v * out.stride];
+
+        u16 packed_position[4];
+        if (mode == VertexQuantization::Unorm16) {
+            for (u32 c = 0; c < 3; ++c) {
+                const f32 t = extent[c] > 0.0f ? (src[c] - lo[c]) / extent[c] : 0.0f;
+                packed_position[c] = (u16) std::round(glm::clamp(t, 0.0f, 1.0f) * 65535.0f);
+            }
+            packed_position[3] = 65535;
+        } else {
+            for (u32 c = 0; c < 3; ++c)
+                packed_position[c] = glm::packHalf1x16(src[c]);
+            packed_position[3] = glm::packHalf1x16(1.0f);
+        }
+        std::memcpy(dst, packed_position, sizeof(packed_position));
+
+        const u32 color = glm::packUnorm4x8(glm::vec4(src[3], src[4], src[5], 1.0f));
+        std::memcpy(dst + 8, &color, sizeof(u32));
+
+        if (normals) {
+            const u32 normal = encode_octahedral(glm::vec3(src[6], src[7], src[8]));
+            std::memcpy(dst + 12, &normal, sizeof(u32));
+        }
+    }
+
+    return out;
+}
+
+} // namespace terra::vertex_quantization
@@ -0,0 +1,205 @@
+#include "terra/resources/virtual_file_system.h"
+#include "terra/resources/pack_archive.h"
+#include "terra/debug/profiler.h"
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+
+namespace terra {
+
+// -----------------------------------------------------------------------------
+// LooseFileSource
+// -----------------------------------------------------------------------------
+
+bool LooseFileSource::exists(std::string_view path) const {
+    std::error_code ec;
+    return std::filesystem::is_regular_file(m_root / path, ec);
+}
+
+FileData LooseFileSource::read(std::string_view path) const {
+    std::ifstream file(m_root / path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return {};
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    std::vector<u8> buffer((size_t) std::max<std::streamsize>(size, 0));
+    if (size > 0 && !file.read(reinterpret_cast<char*>(buffer.data()), size))
+        return {};
+
+    return FileData::from_buffer(std::move(buffer));
+}
+
+// -----------------------------------------------------------------------------
+// VirtualFileSystem
+// -----------------------------------------------------------------------------
+
+struct Mount {
+    std::string point;  // normalized, no trailing slash, "" for root
+    ref<FileSource> source;
+};
+
+struct VfsData {
+    std::shared_mutex mutex;
+    std::vector<Mount> mounts;
+
+    std::mutex init_mutex;
+    std::atomic<bool> initialized = false;
+};
+
+static VfsData s_vfs;
+
+// Returns the path relative to `point`, or nullopt if it is not underneath it.
+static std::optional<std::string_view> strip_mount_point(std::string_view path, std::string_view point) {
+    if (point.empty())
+        return path;
+    if (path.size() <= point.size() || !path.starts_with(point) || path[point.size()] != '/')
+        return std::nullopt;
+    return path.substr(point.size() + 1);
+}
+
+std::string VirtualFileSystem::normalize_path(std::string_view path) {
+    std::string out = std::filesystem::path(path).lexically_normal().generic_string();
+    while (out.starts_with("./"))
+        out.erase(0, 2);
+    while (!out.empty() && out.back() == '/')
+        out.pop_back();
+    return out;
+}
+
+void VirtualFileSystem::init() {
+    PROFILE_FUNCTION();
+
+    if (s_vfs.initialized.load(std::memory_order_acquire))
+        return;
+
+    std::lock_guard init_lock(s_vfs.init_mutex);
+    if (s_vfs.initialized.load(std::memory_order_relaxed))
+        return;
+
+    // Packs are produced by the cooker; loose directories always work.
+    const std::filesystem::path packs_dir = PACKS_DIR;
+
+#if defined(TR_RELEASE)
+    constexpr bool loose_overlay = false;
+#else
+    constexpr bool loose_overlay = true;
+#endif
+
+    if (std::filesystem::exists(packs_dir / "engine.tpak"))
+        mount_archive("", packs_dir / "engine.tpak");
+    if (std::filesystem::exists(packs_dir / "game.tpak"))
+        mount_archive("game", packs_dir / "game.tpak");
+
+    mount("", create_ref<LooseFileSource>(ENGINE_ASSETS_DIR), loose_overlay);
+    mount("game", create_ref<LooseFileSource>(GAME_ASSETS_DIR), loose_overlay);
+
+    s_vfs.initialized.store(true, std::memory_order_release);
+}
+
+void VirtualFileSystem::shutdown() {
+    std::lock_guard init_lock(s_vfs.init_mutex);
+    std::unique_lock lock(s_vfs.mutex);
+    s_vfs.mounts.clear();
+    s_vfs.initialized.store(false, std::memory_order_release);
+}
+
+void VirtualFileSystem::mount(std::string_view mount_point, ref<FileSource> source, bool overlay) {
+    TR_CORE_ASSERT(source, "VirtualFileSystem: null source");
+
+    Mount m{ normalize_path(mount_point), std::move(source) };
+    if (m.point == ".")
+        m.point.clear();
+
+    TR_CORE_TRACE("VFS: mounting '{}' at '/{}'{}", m.source->get_name(), m.point, overlay ? " (overlay)" : "");
+
+    std::unique_lock lock(s_vfs.mutex);
+    if (overlay)
+        s_vfs.mounts.insert(s_vfs.mounts.begin(), std::move(m));
+    else
+        s_vfs.mounts.push_back(std::move(m));
+}
+
+bool VirtualFileSystem::mount_archive(std::string_view mount_point, const std::filesystem::path& archive_path) {
+    ref<PackArchive> archive = PackArchive::open(archive_path);
+    if (!archive)
+        return false;
+
+    mount(mount_point, std::move(archive));
+    return true;
+}
+
+void VirtualFileSystem::unmount(std::string_view mount_point) {
+    std::string point = normalize_path(mount_point);
+    if (point == ".")
+        point.clear();
+
+    std::unique_lock lock(s_vfs.mutex);
+    std::erase_if(s_vfs.mounts, [&](const Mount& m) { return m.point == point; });
+}
+
+FileData VirtualFileSystem::read(std::string_view path) {
+    PROFILE_FUNCTION();
+
+    init();
+
+    const std::string normalized = normalize_path(path);
+
+    std::shared_lock lock(s_vfs.mutex);
+    for (const Mount& m : s_vfs.mounts) {
+        auto relative = strip_mount_point(normalized, m.point);
+        if (!relative)
+            continue;
+
+        if (FileData data = m.source->read(*relative))
+            return data;
+    }
+
+    return {};
+}
+
+bool VirtualFileSystem::exists(std::string_view path) {
+    init();
+
+    const std::string normalized = normalize_path(path);
+
+    std::shared_lock lock(s_vfs.mutex);
+    for (const Mount& m : s_vfs.mounts) {
+        auto relative = strip_mount_point(normalized, m.point);
+        if (relative && m.source->exists(*relative))
+            return true;
+    }
+    return false;
+}
+
+i32 VirtualFileSystem::find_mount(std::string_view path) {
+    init();
+
+    const std::string normalized = normalize_path(path);
+
+    std::shared_lock lock(s_vfs.mutex);
+    for (size_t i = 0; i < s_vfs.mounts.size(); ++i) {
+        const Mount& m = s_vfs.mounts[i];
+        auto relative = strip_mount_point(normalized, m.point);
+        if (relative && m.source->exists(*relative))
+            return (i32) i;
+    }
+    return -1;
+}
+
+void VirtualFileSystem::prefetch_archives() {
+    PROFILE_FUNCTION();
+
+    init();
+
+    std::shared_lock lock(s_vfs.mutex);
+    for (const Mount& m : s_vfs.mounts) {
+        if (auto* archive = dynamic_cast<PackArchive*>(m.source.get()))
+            archive->prefetch();
+    }
+}
+
+} // namespace terra
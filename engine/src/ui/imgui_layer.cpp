@@ -3,6 +3,7 @@
 #include "terra/core/application.h"
 #include "terra/core/base.h"
 #include "terra/renderer/renderer_api.h"
+#include "terra/debug/profiler.h"
 
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
@@ -14,21 +15,39 @@
 
 namespace terra {
 
-UILayer::UILayer() : Layer("UILayer") {}
+static constexpr const char* FONT_BOLD    = "game/assets/fonts/opensans/OpenSans-Bold.ttf";
+static constexpr const char* FONT_REGULAR = "game/assets/fonts/opensans/OpenSans-Regular.ttf";
+static constexpr f32 FONT_SIZE = 18.0f;
+
+UILayer::UILayer(ImFontAtlas* font_atlas) : Layer("UILayer"), m_font_atlas(font_atlas) {}
 
 UILayer::~UILayer() {}
 
+ImFontAtlas* UILayer::build_font_atlas() {
+    PROFILE_FUNCTION();
+
+    ImFontAtlas* atlas = IM_NEW(ImFontAtlas)();
+    atlas->AddFontFromFileTTF(FONT_BOLD, FONT_SIZE);
+    atlas->AddFontFromFileTTF(FONT_REGULAR, FONT_SIZE);
+    atlas->Build();
+    return atlas;
+}
+
 void UILayer::on_attach() {
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
+    ImGui::CreateContext(m_font_atlas);
     ImGuiIO& io = ImGui::GetIO(); (void)io;
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;       // Enable Keyboard Controls
     // io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;           // Enable Docking
     io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;         // Enable Multi-Viewport / Platform Windows
-    io.Fonts->AddFontFromFileTTF("game/assets/fonts/opensans/OpenSans-Bold.ttf", 18.0f);
-    io.FontDefault = io.Fonts->AddFontFromFileTTF("game/assets/fonts/opensans/OpenSans-Regular.ttf", 18.0f);
+    if (!m_font_atlas) {
+        io.Fonts->AddFontFromFileTTF(FONT_BOLD, FONT_SIZE);
+        io.FontDefault = io.Fonts->AddFontFromFileTTF(FONT_REGULAR, FONT_SIZE);
+    } else if (m_font_atlas->Fonts.Size > 1) {
+        io.FontDefault = m_font_atlas->Fonts[1]; // regular, as added by build_font_atlas()
+    }
     //io.ConfigFlags |= ImGuiConfigFlags_ViewportsNoTaskBarIcons;
     //io.ConfigFlags |= ImGuiConfigFlags_ViewportsNoMerge;
 
@@ -62,6 +81,10 @@ void UILayer::on_detach() {
     ImGui_ImplWGPU_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
+
+    // A context never frees an atlas it was given.
+    IM_DELETE(m_font_atlas);
+    m_font_atlas = nullptr;
 }
 
 void UILayer::on_event(Event& e) {
@@ -11,6 +11,21 @@
 
 #include <imgui.h> // if you're using ImGui (optional)
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <cfloat>
+#include <numeric>
+#include <random>
+
+static const char* present_mode_name(wgpu::PresentMode mode) {
+    switch (mode) {
+        case wgpu::PresentMode::Fifo:        return "Fifo (vsync)";
+        case wgpu::PresentMode::FifoRelaxed: return "Fifo Relaxed";
+        case wgpu::PresentMode::Immediate:   return "Immediate";
+        case wgpu::PresentMode::Mailbox:     return "Mailbox";
+        default:                             return "Unknown";
+    }
+}
 
 
 ExampleLayer::ExampleLayer()
@@ -32,8 +47,10 @@ void ExampleLayer::on_attach() {
         100.0f                   // Far plane
     );
     
-    m_mesh = terra::Mesh::from_file("objects/pyramid.txt");
-    m_mesh_2 = terra::Mesh::from_file("objects/webgpu.txt");
+    // Decoded on worker threads while the shader and pipeline are set up;
+    // they start drawing once the registry has uploaded them.
+    m_mesh = terra::AssetRegistry::load_mesh_async("objects/pyramid.txt");
+    m_mesh_2 = terra::AssetRegistry::load_mesh_async("objects/webgpu.txt");
 
 
     m_shader = terra::RendererAPI::create_shader("shaders/shader.wgsl", "Triangle Shader Module");
@@ -64,18 +81,105 @@ void ExampleLayer::on_attach() {
 
     spec.storages = { sb_spec };
 
+    // Meshes upload quantized (see Mesh::set_vertex_quantization); the
+    // shader applies each mesh's decode parameters from group 2.
+    spec.mesh_decode = true;
+
+    // Depth first with the position-only vs_depth, then shade each pixel once.
+    spec.depth_prepass = true;
+    spec.depth_vertex_entry = "vs_depth";
+
     terra::u64 pipeline_id = terra::RendererAPI::create_pipeline(spec);
 
     auto pipeline = terra::RendererAPI::get_pipeline(pipeline_id);
 
     m_material_instance = m_material->create_instance(pipeline.get());
+    m_material_handle = terra::AssetRegistry::add_material(m_material_instance);
 
     generate_pyramid_grid(100, 100, 1.5f); // 10,000 pyramids
+    build_static_props(4000);
+
+    if (terra::AssetRegistry::load_mesh_data("objects/pyramid.txt", m_occluder_mesh)) {
+        m_occluder_bounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+        for (size_t v = 0; v + 2 < m_occluder_mesh.vertices.size(); v += m_occluder_mesh.vertex_stride) {
+            const glm::vec3 p(m_occluder_mesh.vertices[v], m_occluder_mesh.vertices[v + 1], m_occluder_mesh.vertices[v + 2]);
+            m_occluder_bounds.min = glm::min(m_occluder_bounds.min, p);
+            m_occluder_bounds.max = glm::max(m_occluder_bounds.max, p);
+        }
+        m_software_occlusion = terra::create_scope<terra::SoftwareOcclusion>();
+    }
 
 }
 
+void ExampleLayer::build_static_props(int count) {
+    PROFILE_FUNCTION();
+
+    terra::MeshData pyramid;
+    if (!terra::AssetRegistry::load_mesh_data("objects/pyramid.txt", pyramid))
+        return;
+
+    std::mt19937 rng(1337);
+    std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+    std::uniform_real_distribution<float> radius(85.0f, 140.0f);
+    std::uniform_real_distribution<float> size(0.2f, 0.6f);
+    std::uniform_real_distribution<float> tint(0.4f, 1.0f);
+
+    terra::StaticBatchBuilder builder;
+    for (int i = 0; i < count; ++i) {
+        const float a = angle(rng), r = radius(rng);
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(std::cos(a) * r, -1.0f, std::sin(a) * r));
+        model = glm::rotate(model, angle(rng), glm::vec3(0.0f, 1.0f, 0.0f));
+        model = glm::scale(model, glm::vec3(size(rng)));
+
+        builder.add(pyramid, model, m_material_handle, glm::vec4(tint(rng), tint(rng), tint(rng), 1.0f));
+    }
+
+    // Vertices are already in world space, so every chunk shares one identity instance.
+    InstanceBlock identity;
+    identity.model = glm::mat4(1.0f);
+    identity.color = glm::vec4(1.0f);
+    m_static_props = terra::StaticBatch::create(builder.build(), identity, 0, 1);
+}
+
+void ExampleLayer::submit_with_software_occlusion() {
+    PROFILE_FUNCTION();
+
+    constexpr size_t OCCLUDER_COUNT = 64;
+
+    const glm::vec3 eye = m_camera->get_position();
+    auto distance = [&](terra::u32 i) { return glm::distance(glm::vec3(m_instances[i].model[3]), eye); };
+
+    m_occluder_order.resize(m_instances.size());
+    std::iota(m_occluder_order.begin(), m_occluder_order.end(), 0u);
+    const size_t occluders = std::min(OCCLUDER_COUNT, m_occluder_order.size());
+    std::partial_sort(m_occluder_order.begin(), m_occluder_order.begin() + occluders, m_occluder_order.end(),
+        [&](terra::u32 a, terra::u32 b) { return distance(a) < distance(b); });
+
+    m_software_occlusion->begin(m_camera->get_projection_matrix() * m_camera->get_view_matrix());
+    for (size_t i = 0; i < occluders; ++i)
+        m_software_occlusion->add_occluder(m_occluder_mesh, m_instances[m_occluder_order[i]].model);
+    m_software_occlusion->rasterize();
+
+    // Occluders are drawn as they are; everything else only if not hidden by them.
+    m_cpu_occlusion_culled = 0;
+    for (size_t i = 0; i < m_occluder_order.size(); ++i) {
+        const InstanceBlock& instance = m_instances[m_occluder_order[i]];
+        if (i >= occluders && !m_software_occlusion->is_visible(m_occluder_bounds, instance.model)) {
+            m_cpu_occlusion_culled++;
+            continue;
+        }
+        terra::RendererAPI::submit(m_mesh, m_material_handle, instance.model, instance, 0, 1);
+    }
+}
+
 void ExampleLayer::on_detach() {
     TR_INFO("ExampleLayer detached");
+
+    m_static_props.reset();
+
+    terra::AssetRegistry::release(m_mesh);
+    terra::AssetRegistry::release(m_mesh_2);
+    terra::AssetRegistry::release(m_material_handle);
 }
 
 void ExampleLayer::on_update(terra::Timestep ts) {
@@ -132,11 +236,18 @@ void ExampleLayer::on_update(terra::Timestep ts) {
     {
         PROFILE_SCOPE("Instances Submit");
 
-        for (const auto& instance : m_instances) {
-            terra::RendererAPI::submit(m_mesh, m_material_instance, instance, 0, 1);
+        if (m_cpu_occlusion && m_software_occlusion) {
+            submit_with_software_occlusion();
+        } else {
+            for (const auto& instance : m_instances) {
+                terra::RendererAPI::submit(m_mesh, m_material_handle, instance.model, instance, 0, 1);
+            }
         }
     }
 
+    if (m_static_props)
+        terra::RendererAPI::submit(*m_static_props);
+
 
     // // ─── submit instance #1 ───
     // {
@@ -145,7 +256,7 @@ void ExampleLayer::on_update(terra::Timestep ts) {
     //     InstanceBlock I1;
     //     I1.model = glm::translate(glm::mat4(1.0f), I1_pos);
     //     I1.color = I1_color;
-    //     terra::RendererAPI::submit(m_mesh, m_material_instance, I1, /*binding=*/0, /*group=*/1);
+    //     terra::RendererAPI::submit(m_mesh, m_material_handle, I1, /*binding=*/0, /*group=*/1);
     // }
 
     // // ─── submit instance #2 ───
@@ -155,7 +266,7 @@ void ExampleLayer::on_update(terra::Timestep ts) {
     //     InstanceBlock I2;
     //     I2.model = glm::translate(glm::mat4(1.0f), I2_pos);
     //     I2.color = I2_color;
-    //     terra::RendererAPI::submit(m_mesh, m_material_instance, I2, 0, 1);
+    //     terra::RendererAPI::submit(m_mesh, m_material_handle, I2, 0, 1);
     // }
 
     // {
@@ -164,7 +275,7 @@ void ExampleLayer::on_update(terra::Timestep ts) {
     //     InstanceBlock I2;
     //     I2.model = glm::translate(glm::mat4(1.0f), I2_pos);
     //     I2.color = I2_color;
-    //     terra::RendererAPI::submit(m_mesh_2, m_material_instance, I2, 0, 1);
+    //     terra::RendererAPI::submit(m_mesh_2, m_material_handle, I2, 0, 1);
     // }
     
     terra::RendererAPI::end_scene();
@@ -210,11 +321,56 @@ void ExampleLayer::on_ui_render() {
         ImGui::Begin("Renderer Stats");
         ImGui::Text("FPS: %.1f", m_displayed_fps);
         ImGui::Text("Frame Time: %.2f ms", m_displayed_frame_time);
+        ImGui::Text("GPU Time: %.2f ms", stats.gpu_time_ms);
+
+        terra::WebGPUContext& context = *terra::Application::get().get_context();
+        const auto& modes = context.get_supported_present_modes();
+        std::vector<const char*> mode_names;
+        int current_mode = 0;
+        for (size_t i = 0; i < modes.size(); ++i) {
+            mode_names.push_back(present_mode_name(modes[i]));
+            if (modes[i] == context.get_present_mode())
+                current_mode = (int) i;
+        }
+        if (ImGui::Combo("Present Mode", &current_mode, mode_names.data(), (int) mode_names.size()))
+            context.set_present_mode(modes[current_mode]);
+        if (ImGui::SliderFloat("FPS Cap (0 = off)", &m_target_fps, 0.0f, 240.0f, "%.0f"))
+            terra::Application::get().set_target_fps(m_target_fps);
+        if (ImGui::SliderInt("Max Frame Latency", &m_max_frame_latency, 1, 3))
+            context.set_max_frame_latency((terra::u32) m_max_frame_latency);
         ImGui::Separator();
         ImGui::Text("Draw Calls: %u", stats.draw_calls);
         ImGui::Text("Mesh Count: %u", stats.mesh_count);
         ImGui::Text("Vertex Count: %u", stats.vertex_count);
         ImGui::Text("Index Count: %u", stats.index_count);
+        ImGui::Text("Buffer Binds: %u", stats.buffer_binds);
+        ImGui::Text("Batches: %u, %u instances", stats.batches, stats.instances);
+        ImGui::Text("Pipelines Bound: %u", stats.pipelines_bound);
+        ImGui::Text("Created: %u buffers, %u bind groups", stats.buffers_created, stats.bind_groups_created);
+        ImGui::Text("Uploaded: %.1f KB", stats.bytes_uploaded / 1024.0);
+        ImGui::Text("Depth Prepass Draws: %u", stats.depth_prepass_draws);
+        ImGui::Text("Render Graph: %u passes, %u culled, %u transient targets", stats.render_graph_passes, stats.render_graph_culled, stats.render_graph_textures);
+        ImGui::Text("Render Targets: %u pooled, %u created", stats.render_targets, stats.render_targets_created);
+        ImGui::Text("Static Chunks: %u drawn, %u culled", stats.static_chunks_drawn, stats.static_chunks_culled);
+        ImGui::Text("Render Bundles: %u executed, %u recorded", stats.bundles_executed, stats.bundles_recorded);
+        if (ImGui::Checkbox("Render Bundles", &m_render_bundles))
+            terra::RendererAPI::set_render_bundles_enabled(m_render_bundles);
+        ImGui::Text("Cluster Draws: %u (%u meshlets tested)", stats.cluster_draws, stats.meshlets_tested);
+        if (ImGui::Checkbox("Meshlet Culling", &m_cluster_culling))
+            terra::RendererAPI::set_cluster_culling_enabled(m_cluster_culling);
+        ImGui::Text("Occlusion Culled Draws: %u", stats.occlusion_draws);
+        if (ImGui::Checkbox("Occlusion Culling", &m_occlusion_culling))
+            terra::RendererAPI::set_occlusion_culling_enabled(m_occlusion_culling);
+        ImGui::Checkbox("CPU Occlusion", &m_cpu_occlusion);
+        if (m_cpu_occlusion && m_software_occlusion) {
+            const auto& occlusion = m_software_occlusion->get_stats();
+            ImGui::Text("CPU Occlusion: %u culled, %u occluder triangles", m_cpu_occlusion_culled, occlusion.occluder_triangles);
+        }
+        ImGui::Text("Instances per LOD:");
+        for (terra::u32 lod = 0; lod < terra::MAX_MESH_LODS; ++lod) {
+            ImGui::SameLine();
+            ImGui::Text("%s%u", lod == 0 ? "" : "/ ", stats.lod_instances[lod]);
+        }
         ImGui::End();
     }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <terra/terra.h>
+#include <terra/renderer/software_occlusion.h>
 
 struct alignas(16) UniformBlock {
     glm::mat4 u_view;
@@ -49,12 +50,34 @@ public:
 		}
 	}
 
+	// Scatters `count` small pyramids around the grid and bakes them into a
+	// static batch: they never move, so they cost a few chunk draws.
+	void build_static_props(int count);
+
+	// Rasterizes the pyramids nearest the camera as occluders on the CPU
+	// and submits only the grid instances they do not hide.
+	void submit_with_software_occlusion();
+
 private:
 	terra::ref<terra::Shader> m_shader;
 	terra::ref<terra::Material> m_material;
 	terra::ref<terra::MaterialInstance> m_material_instance;
-	terra::ref<terra::Mesh> m_mesh;
-	terra::ref<terra::Mesh> m_mesh_2;
+	terra::MaterialHandle m_material_handle;
+	terra::MeshHandle m_mesh;
+	terra::MeshHandle m_mesh_2;
+	terra::scope<terra::StaticBatch> m_static_props;
+	bool m_render_bundles = true;
+	bool m_cluster_culling = true;
+	bool m_occlusion_culling = true;
+	float m_target_fps = 0.0f;
+	int m_max_frame_latency = 2;
+
+	terra::scope<terra::SoftwareOcclusion> m_software_occlusion;
+	terra::MeshData m_occluder_mesh;
+	terra::BoundingBox m_occluder_bounds;
+	std::vector<terra::u32> m_occluder_order;
+	bool m_cpu_occlusion = false;
+	terra::u32 m_cpu_occlusion_culled = 0;
 
 	terra::scope<terra::PerspectiveCamera> m_camera;
 	terra::scope<terra::Pipeline> m_pipeline;
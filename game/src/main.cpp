@@ -5,13 +5,22 @@
 class ExampleGame : public terra::Application {
 public:
     ExampleGame(terra::CommandLineArgs args)
-        : terra::Application("My Example Game", args) 
+        : terra::Application("My Example Game", args, context_props())
     {
         push_layer(new ExampleLayer());
     }
 
     ~ExampleGame() {}
 
+private:
+    // Low latency where the surface allows it, vsync otherwise.
+    static terra::ContextProps context_props() {
+        terra::ContextProps props;
+        props.present_modes = { wgpu::PresentMode::Mailbox, wgpu::PresentMode::Fifo };
+        props.max_frame_latency = 2;
+        return props;
+    }
+
 };
 
 terra::Application* terra::create_application(terra::CommandLineArgs args) {
@@ -46,7 +46,7 @@ def print_frame_stats(scope_df):
 
 
 def main():
-    file_path = "terra_runtime.json"
+    file_path = "terra_capture.json"  # from tools/ttrace_to_json.py
     function_name = "Getting Current Texture"
 
     df = load_profiler_json(file_path)
@@ -5,6 +5,7 @@ import platform
 ENGINE_NAME = "terra"
 GAME_NAME = "example"
 EDITOR_NAME = "lithos"
+COOK_NAME = "terra-cook"
 
 # Build
 BUILD_DIR = ".build"
@@ -13,6 +14,7 @@ CXX_STANDARD = 23
 # Feature flags
 ENABLE_ASSERTS = True
 ENABLE_DEBUG_LOGGING = True
+ENABLE_PROFILING = True  # compiled in; records only when asked to
 
 # Platform flags
 PLATFORM = platform.system()
@@ -0,0 +1,150 @@
+"""Converts a binary .ttrace written by the engine profiler to Chrome's
+trace event JSON, for chrome://tracing, Perfetto or measure.py.
+
+    python3 tools/ttrace_to_json.py terra_capture.ttrace [-o out.json]
+
+The format is described next to the writer in engine/src/debug/profiler.cpp.
+Timestamps are rebased to the session start.
+"""
+
+import argparse
+import json
+import struct
+import sys
+from pathlib import Path
+
+MAGIC = b"TTRC"
+VERSIONS = (1, 2, 3)  # 2 added counter events, 3 hardware counters
+
+TAG_NAME = 1
+TAG_THREAD = 2
+TAG_EVENTS = 3
+TAG_DROPPED = 4
+
+KIND_SPAN = 0
+KIND_COUNTER = 1
+KIND_HARDWARE = 2
+
+# In the order of Profiler::HARDWARE_COUNTER_NAMES, two per event.
+HARDWARE_COUNTERS = ("cycles", "instructions", "l1d_read_misses", "llc_misses", "branch_misses")
+
+EVENT = struct.Struct("<QQII")
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def at_end(self):
+        return self.offset >= len(self.data)
+
+    def read(self, fmt):
+        values = struct.unpack_from(fmt, self.data, self.offset)
+        self.offset += struct.calcsize(fmt)
+        return values if len(values) > 1 else values[0]
+
+    def read_string(self):
+        length = self.read("<H")
+        text = self.data[self.offset:self.offset + length].decode("utf-8", errors="replace")
+        self.offset += length
+        return text
+
+
+def add_hardware_counters(span, pair, first, second):
+    # A flight recorder dump can begin with the counters of a span it cut off.
+    if span is None:
+        return
+    args = span.setdefault("args", {})
+    for index, value in ((pair * 2, first), (pair * 2 + 1, second)):
+        if index < len(HARDWARE_COUNTERS):
+            args[HARDWARE_COUNTERS[index]] = value
+    if args.get("cycles") and "instructions" in args:
+        args["ipc"] = round(args["instructions"] / args["cycles"], 3)
+
+
+def convert(data):
+    reader = Reader(data)
+
+    if data[:4] != MAGIC:
+        raise ValueError("not a .ttrace file")
+    reader.offset = 4
+    version = reader.read("<I")
+    if version not in VERSIONS:
+        raise ValueError(f"unsupported .ttrace version {version}")
+    ticks_per_second, session_start = reader.read("<QQ")
+    session_name = reader.read_string()
+    ticks_per_us = ticks_per_second / 1e6
+
+    names = {}
+    threads = {}
+    events = []
+    dropped = 0
+    last_span = {}  # by thread, for the hardware counters that follow it
+
+    while not reader.at_end():
+        tag = reader.read("<B")
+        if tag == TAG_NAME:
+            name_id = reader.read("<I")
+            names[name_id] = reader.read_string()
+        elif tag == TAG_THREAD:
+            thread_id = reader.read("<I")
+            threads[thread_id] = reader.read_string()
+        elif tag == TAG_EVENTS:
+            thread_id, count = reader.read("<II")
+            for start, end, name_id, kind in EVENT.iter_unpack(data[reader.offset:reader.offset + count * EVENT.size]):
+                if kind == KIND_HARDWARE:
+                    add_hardware_counters(last_span.get(thread_id), name_id, start, end)
+                    continue
+                name = names.get(name_id, f"<name {name_id}>")
+                if kind == KIND_COUNTER:
+                    value = struct.unpack("<d", struct.pack("<Q", end))[0]
+                    events.append({
+                        "args": {name: value},
+                        "name": name,
+                        "ph": "C",
+                        "pid": 0,
+                        "ts": round((start - session_start) / ticks_per_us, 3),
+                    })
+                    continue
+                last_span[thread_id] = {
+                    "cat": "gpu" if threads.get(thread_id) == "GPU" else "function",
+                    "dur": round((end - start) / ticks_per_us, 3),
+                    "name": name,
+                    "ph": "X",
+                    "pid": 0,
+                    "tid": thread_id,
+                    "ts": round((start - session_start) / ticks_per_us, 3),
+                }
+                events.append(last_span[thread_id])
+            reader.offset += count * EVENT.size
+        elif tag == TAG_DROPPED:
+            thread_id, count = reader.read("<IQ")
+            dropped += count
+            print(f"warning: {threads.get(thread_id, thread_id)} dropped {count} events", file=sys.stderr)
+        else:
+            raise ValueError(f"unknown record tag {tag} at offset {reader.offset - 1}")
+
+    metadata = [{"name": "process_name", "ph": "M", "pid": 0, "args": {"name": session_name}}]
+    for thread_id, thread_name in threads.items():
+        metadata.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": thread_id, "args": {"name": thread_name}})
+
+    return {"otherData": {"session": session_name, "dropped_events": dropped}, "traceEvents": metadata + events}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a .ttrace profile to Chrome trace JSON.")
+    parser.add_argument("input", type=Path)
+    parser.add_argument("-o", "--output", type=Path, help="defaults to the input with a .json extension")
+    args = parser.parse_args()
+
+    output = args.output or args.input.with_suffix(".json")
+    trace = convert(args.input.read_bytes())
+    with open(output, "w") as f:
+        json.dump(trace, f, separators=(",", ":"))
+
+    print(f"{len(trace['traceEvents'])} events -> {output}")
+
+
+if __name__ == "__main__":
+    main()